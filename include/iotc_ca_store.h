@@ -0,0 +1,45 @@
+/* SPDX-License-Identifier: MIT
+ * Copyright (C) 2025 Avnet
+ * Authors: Nikola Markovic <nikola.markovic@avnet.com> et al.
+ */
+
+#ifndef IOTC_CA_STORE_H
+#define IOTC_CA_STORE_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "cy_result.h"
+#include "iotconnect.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    size_t cert_size;           // Size of the certificate data (PEM text or DER) that each connection would otherwise parse
+    size_t heap_size;           // Heap held by the parsed roots. Each connection would otherwise allocate this much.
+    cy_time_t parse_time_ms;    // Time it took to parse the roots. Each connection would otherwise spend this much.
+    unsigned int connections;   // Number of TLS connections that used the store
+} IotcCaStoreStats;
+
+// Parses the root CA certificates once into the global trusted root store of the TLS layer.
+// The store holds only the default MQTT and OTA root for the connection type, so that these connections
+// do not also trust the root of the HTTP discovery and identity services.
+// A server_ca_cert in IotConnectX509Config is still passed to the MQTT client per connection.
+// This is called by iotconnect_sdk_init(), so the application does not need to call it.
+cy_rslt_t iotc_ca_store_init(IotConnectConnectionType connection_type);
+
+// Returns true if the store holds the roots for the given connection type.
+// If so, the caller should leave root_ca NULL in its credentials so that the TLS layer
+// verifies the server against the pre-parsed roots. Each successful call counts as one connection served.
+bool iotc_ca_store_lend(IotConnectConnectionType connection_type);
+
+void iotc_ca_store_get_stats(IotcCaStoreStats *stats);
+
+void iotc_ca_store_deinit(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IOTC_CA_STORE_H
@@ -0,0 +1,118 @@
+/* SPDX-License-Identifier: MIT
+ * Copyright (C) 2025 Avnet
+ * Authors: Nikola Markovic <nikola.markovic@avnet.com> et al.
+ */
+
+#ifndef IOTC_COMMAND_H
+#define IOTC_COMMAND_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "cyabs_rtos.h"
+#include "iotcl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Registry that maps command names to handlers, as an alternative to comparing the command string
+// in IoTConnectCallbacks.cmd_cb. The command is split into arguments before the handler is called,
+// and the command is acknowledged with the handler's result.
+// Commands that are not registered are passed to IoTConnectCallbacks.cmd_cb, if set,
+// or are otherwise acknowledged as failed.
+//
+// Example:
+//     static int on_led(int argc, char **argv, char *ack_msg, size_t ack_msg_size) {
+//         if (argc != 2) {
+//             snprintf(ack_msg, ack_msg_size, "Usage: led on|off");
+//             return IOTCL_ERR_BAD_VALUE;
+//         }
+//         set_led(0 == strcmp(argv[1], "on"));
+//         return IOTCL_SUCCESS;
+//     }
+//     ...
+//     iotc_command_register("led", on_led);
+
+// Capacity of the hash table. Must be a power of two. Keep it at least twice the number of registered commands.
+#ifndef IOTC_COMMAND_TABLE_SIZE
+#define IOTC_COMMAND_TABLE_SIZE 16
+#endif
+
+// Maximum number of arguments passed to a handler, including the command name in argv[0]
+#ifndef IOTC_COMMAND_MAX_ARGS
+#define IOTC_COMMAND_MAX_ARGS 8
+#endif
+
+// Size of the acknowledgement message buffer passed to handlers
+#ifndef IOTC_COMMAND_ACK_MSG_SIZE
+#define IOTC_COMMAND_ACK_MSG_SIZE 64
+#endif
+
+// argv[0] is the command name and the rest are the space separated arguments (argc is at most IOTC_COMMAND_MAX_ARGS).
+// The handler may modify the argument strings, which are valid only for the duration of the call.
+// ack_msg is an empty string that the handler can fill with an optional acknowledgement message.
+// Return IOTCL_SUCCESS to acknowledge the command as successful, or any other value to acknowledge it as failed.
+typedef int (*IotcCommandHandler)(int argc, char **argv, char *ack_msg, size_t ack_msg_size);
+
+// Number of worker tasks that run handlers registered with iotc_command_register_async(), which is
+// the number of such handlers that can run at the same time. The workers are started with the first async registration.
+#ifndef IOTC_COMMAND_WORKER_COUNT
+#define IOTC_COMMAND_WORKER_COUNT 1
+#endif
+
+#ifndef IOTC_COMMAND_WORKER_STACK_SIZE
+#define IOTC_COMMAND_WORKER_STACK_SIZE 4096
+#endif
+
+#ifndef IOTC_COMMAND_WORKER_PRIORITY
+#define IOTC_COMMAND_WORKER_PRIORITY CY_RTOS_PRIORITY_BELOWNORMAL
+#endif
+
+// Maximum number of async commands that are queued, running, or waiting for their acknowledgement to be sent.
+// Further async commands are acknowledged as failed until one completes.
+#ifndef IOTC_COMMAND_MAX_PENDING
+#define IOTC_COMMAND_MAX_PENDING 4
+#endif
+
+// How long iotc_command_deinit() waits for the async handlers that are running to return
+#ifndef IOTC_COMMAND_DEINIT_TIMEOUT_MS
+#define IOTC_COMMAND_DEINIT_TIMEOUT_MS 5000
+#endif
+
+// Registers or replaces the handler for a command. The name is not copied, so it must remain valid (usually a string literal).
+// Returns IOTCL_ERR_OUT_OF_MEMORY if the table is full.
+int iotc_command_register(const char *name, IotcCommandHandler handler);
+
+// Same as iotc_command_register(), but the handler will run in a worker task, so that a handler that takes
+// a long time does not hold up iotconnect_sdk_poll_inbound_mq() and the messages that are queued behind the command.
+// The acknowledgements are sent by iotconnect_sdk_poll_inbound_mq() in the order in which the commands were received.
+int iotc_command_register_async(const char *name, IotcCommandHandler handler);
+
+void iotc_command_unregister(const char *name);
+
+// Removes all handlers
+void iotc_command_clear(void);
+
+// Called by the SDK for each received command. Runs the handler for the command, or if there is none,
+// calls the fallback (if not NULL) or acknowledges the command as failed.
+void iotc_command_dispatch(IotclC2dEventData data, IotclCommandCallback fallback);
+
+// Called by the SDK from iotconnect_sdk_poll_inbound_mq(). Sends the acknowledgements of the async commands
+// that completed, up to the first one that is still running.
+void iotc_command_send_completed_acks(void);
+
+// Returns true once iotc_command_deinit() was called. Async handlers that take a long time should check it
+// and return early.
+bool iotc_command_is_stopping(void);
+
+// Stops the workers. The handlers that are running are given IOTC_COMMAND_DEINIT_TIMEOUT_MS to return,
+// and the commands that did not start yet are dropped, along with the unsent acknowledgements.
+// Returns IOTCL_ERR_FAILED if a handler is still running after the timeout. The workers are then left
+// to exit when their handlers return, and iotc_command_deinit() can be called again to complete the cleanup.
+int iotc_command_deinit(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IOTC_COMMAND_H
@@ -0,0 +1,50 @@
+/* SPDX-License-Identifier: MIT
+ * Copyright (C) 2025 Avnet
+ * Authors: Nikola Markovic <nikola.markovic@avnet.com> et al.
+ */
+
+#ifndef IOTC_DNS_CACHE_H
+#define IOTC_DNS_CACHE_H
+
+#include <stdbool.h>
+#include "cy_result.h"
+#include "lwip/ip_addr.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    IOTC_DNS_CACHE_MISS = 0,    // No entry, or the entry has expired
+    IOTC_DNS_CACHE_HIT,         // Fresh entry with a resolved address
+    IOTC_DNS_CACHE_NEGATIVE     // Fresh entry recording a recent resolution failure
+} IotcDnsCacheResult;
+
+// Resolve the host name to an IP address. Answers are served from the cache while they are fresh.
+// Failed resolutions are cached as well, for a shorter time, so that the caller can fail fast.
+// This call may block while the DNS query is in progress and must not be called from the lwIP tcpip thread.
+cy_rslt_t iotc_dns_resolve(const char *host, ip_addr_t *addr);
+
+// Same as iotc_dns_resolve, but also writes the address as a null terminated string into ip_str.
+// ip_str_size should be at least IPADDR_STRLEN_MAX bytes.
+cy_rslt_t iotc_dns_resolve_to_string(const char *host, char *ip_str, size_t ip_str_size);
+
+// Resolve the host name ahead of time (if not already cached) so that a subsequent connection does not wait on DNS.
+// Typically called once the network comes back up after a Wi-Fi drop.
+cy_rslt_t iotc_dns_preresolve(const char *host);
+
+// Non-blocking cache lookup. Safe to call from the lwIP tcpip thread. addr may be NULL.
+IotcDnsCacheResult iotc_dns_cache_lookup(const char *host, ip_addr_t *addr);
+
+// Record a resolution result obtained elsewhere. Pass NULL addr to record a failure.
+void iotc_dns_cache_store(const char *host, const ip_addr_t *addr);
+
+// Drop the cached entry for the host, for example after a connection to the cached address failed.
+// Pass NULL to drop all entries.
+void iotc_dns_cache_invalidate(const char *host);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IOTC_DNS_CACHE_H
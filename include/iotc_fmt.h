@@ -0,0 +1,52 @@
+/* SPDX-License-Identifier: MIT
+ * Copyright (C) 2025 Avnet
+ * Authors: Nikola Markovic <nikola.markovic@avnet.com> et al.
+ */
+
+#ifndef IOTC_FMT_H
+#define IOTC_FMT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Formatting of telemetry values, without sprintf.
+// All functions write a null terminated string into buf and return its length (excluding the terminator).
+// For numbers, buf needs to be at least IOTC_FMT_BUFFER_SIZE bytes.
+#define IOTC_FMT_BUFFER_SIZE 26
+
+// Size of the buffer for iotc_fmt_iso_time(), including the null terminator
+#define IOTC_FMT_ISO_TIME_SIZE 25
+
+// Formats a 64-bit integer
+size_t iotc_fmt_int(char *buf, int64_t value);
+
+// Formats a double with the fewest digits that will parse back to exactly the same double.
+// The layout follows printf "%g" as used by cJSON: integer-valued numbers have no decimal point,
+// and the exponent form is used for numbers below 1e-4 or at or above 1e15 (1e17 for numbers that need
+// more than 15 digits, like cJSON's "%1.17g"), so the result is never longer than cJSON's.
+// NaN and infinity are written as null.
+size_t iotc_fmt_double(char *buf, double value);
+
+// Formats a double rounded to the given number of decimals (0-9), with trailing zeros removed.
+// For example, 23.456 with 2 decimals is written as 23.46, and 23.001 as 23.
+// Values too large to be rounded precisely are formatted with iotc_fmt_double().
+size_t iotc_fmt_fixed(char *buf, double value, int decimals);
+
+// Writes the string in double quotes with JSON escaping into a buffer of buf_size bytes.
+// Returns the length, or 0 if the result and its null terminator did not fit.
+size_t iotc_fmt_json_string(char *buf, size_t buf_size, const char *str);
+
+// Writes the time in the ISO 8601 format of the iotc-c-lib telemetry timestamps, like 2025-01-31T12:00:00.000Z.
+// buf needs to be at least IOTC_FMT_ISO_TIME_SIZE bytes. Returns the length, or 0 if the time could not be converted.
+size_t iotc_fmt_iso_time(char *buf, time_t t);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IOTC_FMT_H
@@ -0,0 +1,85 @@
+/* SPDX-License-Identifier: MIT
+ * Copyright (C) 2025 Avnet
+ * Authors: Nikola Markovic <nikola.markovic@avnet.com> et al.
+ */
+
+#ifndef IOTC_JSON_MEM_H
+#define IOTC_JSON_MEM_H
+
+#include <stddef.h>
+#include <cJSON.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// cJSON memory hooks that serve the parse tree of each inbound message from a bump allocator (arena),
+// and a pool of print buffers for the JSON that the SDK prints itself, instead of heap allocations that fragment the heap.
+// The arena is used only by the task that processes the message, between iotc_json_mem_begin() and iotc_json_mem_end().
+// The SDK ends that scope before it calls the application's command and OTA callbacks, so the arena holds only
+// the parse tree built by iotc-c-lib. The hooks are global to cJSON, but all other cJSON allocations,
+// including the application's own, go to the heap as before.
+// The arena is reset when everything that was allocated from it is freed, so a cJSON object that outlives the message
+// is safe, but keeps the arena from being reused until it is deleted. If the arena is full, allocations fall back to the heap.
+
+// Size of the arena. A C2D message of N bytes typically needs about 2*N to 3*N bytes.
+// Set to 0 to disable the arena.
+#ifndef IOTC_JSON_ARENA_SIZE
+#define IOTC_JSON_ARENA_SIZE 4096
+#endif
+
+// The SDK prints its outbound JSON into a pool of IOTC_JSON_PRINT_BUFFER_COUNT fixed buffers: telemetry from
+// iotc_telemetry_writer.h and the modules built on it, command acknowledgements (iotconnect_sdk_send_cmd_ack())
+// and the state saved by the property cache. This avoids a new heap string for every message, and for JSON printed
+// from a cJSON tree, the heap buffer that cJSON grows 256, 512, 1024... bytes and then copies into an exact size string.
+// The pool is not used through the cJSON hooks, so telemetry created with iotcl_telemetry_create() and sent with
+// iotcl_mqtt_send_telemetry() is still printed to the heap by iotc-c-lib. Use the telemetry writer instead to avoid that.
+// JSON that does not fit into IOTC_JSON_PRINT_BUFFER_SIZE bytes, or printed while all buffers are in use,
+// goes to the heap, which is counted in IotcJsonMemStats. Set IOTC_JSON_PRINT_BUFFER_COUNT to 0 to disable the pool.
+#ifndef IOTC_JSON_PRINT_BUFFER_SIZE
+#define IOTC_JSON_PRINT_BUFFER_SIZE 1024
+#endif
+
+#ifndef IOTC_JSON_PRINT_BUFFER_COUNT
+#define IOTC_JSON_PRINT_BUFFER_COUNT 2
+#endif
+
+typedef struct {
+    unsigned int arena_allocations; // Allocations served from the arena
+    unsigned int heap_fallbacks;    // Allocations in an arena scope that did not fit and went to the heap
+    size_t peak_usage;              // Largest number of arena bytes in use at once
+    unsigned int print_buffer_allocations;  // Messages that were printed into the pool
+    unsigned int print_buffer_too_large;    // Messages that did not fit into IOTC_JSON_PRINT_BUFFER_SIZE and went to the heap
+    unsigned int print_buffer_exhausted;    // Messages that went to the heap because all print buffers were in use
+} IotcJsonMemStats;
+
+// Installs the cJSON hooks. Called by iotconnect_sdk_init().
+void iotc_json_mem_init(void);
+
+// Allocations made by the calling task are served from the arena until iotc_json_mem_end() is called.
+void iotc_json_mem_begin(void);
+void iotc_json_mem_end(void);
+
+// Same as cJSON_PrintUnformatted(), but uses a buffer from the pool if possible.
+// Returns NULL if out of memory. The result must be freed with iotc_json_mem_free_print().
+char *iotc_json_mem_print(cJSON *item);
+
+// Returns a buffer of IOTC_JSON_PRINT_BUFFER_SIZE bytes for JSON that the SDK writes directly, like the telemetry writer.
+// The buffer comes from the pool, or from the heap if all buffers are in use. Returns NULL if out of memory.
+// The buffer must be freed with iotc_json_mem_free_print().
+char *iotc_json_mem_get_buffer(void);
+
+// Moves the first length bytes of JSON that outgrew its buffer into a heap buffer of new_size bytes and frees the old buffer.
+// Returns the new buffer, or NULL if out of memory, in which case the old buffer is left as it is.
+char *iotc_json_mem_grow(char *json, size_t length, size_t new_size);
+
+// Frees the result of iotc_json_mem_print(), iotc_json_mem_get_buffer() or iotc_json_mem_grow().
+void iotc_json_mem_free_print(char *json);
+
+void iotc_json_mem_get_stats(IotcJsonMemStats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IOTC_JSON_MEM_H
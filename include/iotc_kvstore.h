@@ -0,0 +1,58 @@
+/* SPDX-License-Identifier: MIT
+ * Copyright (C) 2025 Avnet
+ * Authors: Nikola Markovic <nikola.markovic@avnet.com> et al.
+ */
+
+#ifndef IOTC_KVSTORE_H
+#define IOTC_KVSTORE_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Persistent storage used by the SDK to keep state across reboots.
+// The SDK does not access flash directly. Instead, the application provides the storage callbacks,
+// for example by wrapping the ModusToolbox mtb-kvstore library:
+//
+//     static int kv_read(const char *key, void *data, size_t size) {
+//         uint32_t len = size;
+//         cy_rslt_t result = mtb_kvstore_read(&kvstore, key, data, &len);
+//         if (MTB_KVSTORE_ITEM_NOT_FOUND_ERROR == result) {
+//             return -1;
+//         }
+//         return CY_RSLT_SUCCESS == result ? (int) len : -2;
+//     }
+//     ...
+//     static const IotcKvStore kv = {kv_read, kv_write, kv_remove};
+//     iotc_kvstore_set(&kv);
+//
+// If no store is set, the SDK features that use it will work, but will not retain their state across reboots.
+
+typedef struct {
+    // Reads up to size bytes of the value into data. Returns the number of bytes read, -1 if the key does not exist,
+    // or another negative value if the value exists but could not be read.
+    int (*read)(const char *key, void *data, size_t size);
+    // Writes the value, replacing the existing value, if any. Returns 0 on success.
+    int (*write)(const char *key, const void *data, size_t size);
+    // Removes the key. Returns 0 on success, or if the key does not exist.
+    int (*remove)(const char *key);
+} IotcKvStore;
+
+// The store is not copied, so it must remain valid. Pass NULL to stop using the store.
+void iotc_kvstore_set(const IotcKvStore *store);
+
+bool iotc_kvstore_is_available(void);
+
+// These return -1 if no store is set. Otherwise, they return what the store callbacks return.
+int iotc_kvstore_read(const char *key, void *data, size_t size);
+int iotc_kvstore_write(const char *key, const void *data, size_t size);
+int iotc_kvstore_remove(const char *key);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IOTC_KVSTORE_H
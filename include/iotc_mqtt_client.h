@@ -8,6 +8,7 @@
 
 #include <stddef.h>
 #include "cy_result.h"
+#include "cyabs_rtos.h" // for cy_time_t
 #include "iotconnect.h"
 
 
@@ -33,6 +34,10 @@ bool iotc_mqtt_client_is_connected();
 // send a null terminated string
 cy_rslt_t iotc_mqtt_client_publish(const char * topic, const char *payload, int qos);
 
+// Returns true while a publish (including the wait for its acknowledgement) is in progress in any task,
+// or if the last one completed less than quiet_ms ago. Used to keep OTA downloads out of the way of publishes.
+bool iotc_mqtt_client_is_publish_recent(cy_time_t quiet_ms);
+
 #ifdef __cplusplus
 }
 #endif
@@ -15,6 +15,37 @@
 extern "C" {
 #endif
 
+// Number of ack IDs of recently queued messages remembered to drop duplicates (QoS 1 redeliveries).
+// Messages without an ack ID are never dropped as duplicates. 0 disables the check.
+#ifndef IOTC_MQ_DEDUP_SIZE
+#define IOTC_MQ_DEDUP_SIZE 8
+#endif
+
+// Largest ack ID that is remembered, including the null terminator. Messages with longer ack IDs are not checked.
+#ifndef IOTC_MQ_DEDUP_ACK_ID_SIZE
+#define IOTC_MQ_DEDUP_ACK_ID_SIZE 48
+#endif
+
+// A message with the same ack ID as one queued longer than this ago is not considered a duplicate
+#ifndef IOTC_MQ_DEDUP_TTL_MS
+#define IOTC_MQ_DEDUP_TTL_MS (10 * 60 * 1000)
+#endif
+
+// Message types ("ct" field) of the C2D messages
+#define IOTC_MQ_CT_UNKNOWN	(-1)
+#define IOTC_MQ_CT_COMMAND	0
+#define IOTC_MQ_CT_OTA		1
+
+typedef struct {
+	int ct;					// Message type, or IOTC_MQ_CT_UNKNOWN if the message does not have one
+	const char *ack_id;		// Points into the raw message. Not null terminated. NULL if the message has no ack ID.
+	size_t ack_id_len;
+} IotcMqC2dInfo;
+
+// Return false to drop the message before it is queued and parsed.
+// Called from the MQTT client's task, so it should return quickly.
+typedef bool (*IotcMqFilterCallback)(const IotcMqC2dInfo *info);
+
 cy_rslt_t iotc_mq_init(size_t queue_size);
 
 void iotc_mq_register(IotConnectMqttInboundMessageCallback mqtt_inbound_msg_cb);
@@ -25,6 +56,20 @@ void iotc_mq_on_mqtt_inbound_message(const char* topic, const char *message, siz
 // If timeout_ms is zero, the call will block forever until a message arrives
 void iotc_mq_process(cy_time_t timeout_ms);
 
+// Reads the top level "ct" and "ack" fields of a C2D message directly from the raw bytes.
+// Returns false if the message is not a complete JSON object. info is filled in either way.
+bool iotc_mq_scan_c2d(const char *message, size_t message_len, IotcMqC2dInfo *info);
+
+void iotc_mq_set_filter(IotcMqFilterCallback cb);
+
+// Number of inbound messages that were dropped as duplicates
+unsigned int iotc_mq_get_duplicate_count(void);
+
+// Makes a waiting iotc_mq_process() return early, without a message. Can be called from any task.
+// Wake-ups are coalesced: until iotc_mq_process() returns for one, further calls do nothing,
+// so at most one queue slot is taken away from the inbound messages.
+void iotc_mq_wake(void);
+
 void iotc_mq_deregister(void);
 
 void iotc_mq_flush(void);
@@ -12,6 +12,7 @@
 #ifdef IOTC_OTA_SUPPORT
 
 #include "iotconnect.h"
+#include "cyabs_rtos.h"
 #include "cy_ota_api.h"
 
 // Call this only once from the application.
@@ -35,6 +36,11 @@ cy_rslt_t iotc_ota_run(IotConnectConnectionType connection_type, const char* hos
 // The callback is optional. If not provided, this module will handle OTA for the user by printing status messages
 // See the callback implementation in iotc_ota.c on how to get OTA result and stop it from infinitely trying.
 // Ensure to call iotc_ota_cleanup() to clean up allocated URL strings once the OTA agent task completes.
+// Before the agent starts, the size and the MCUboot header of the image are requested and checked against
+// the capacity of the secondary slot, so that an image that cannot be used fails right away with
+// CY_RSLT_OTA_ERROR_WRITE_STORAGE (too large) or CY_RSLT_OTA_ERROR_VERIFY (not an image, or truncated).
+// Artifacts that cannot be checked, such as TAR bundles, or when the request fails or the server ignores the range,
+// are downloaded as usual. Define IOTC_OTA_PREFLIGHT=0 to skip the check.
 cy_rslt_t iotc_ota_start(IotConnectConnectionType connection_type, const char* host, const char* path, cy_ota_callback_t usr_ota_cb);
 
 // Call this if you ran the asynchronous iotc_ota_start when OTA agent task completes.
@@ -46,9 +52,63 @@ cy_rslt_t iotc_ota_get_download_status(void);
 // Returns last error as string of the OTA download. NULL if it was successful.
 const char* iotc_ota_get_download_error_string(void);
 
+typedef struct {
+    cy_time_t connect_ms;       // connecting to the server
+    cy_time_t download_ms;      // waiting for data from the server
+    cy_time_t write_ms;         // decoding and writing the image to flash
+    cy_time_t verify_ms;        // checking the written image
+    cy_time_t throttle_ms;      // waiting for the rate limit and for MQTT publishes (see iotc_ota_set_rate_limit())
+    cy_time_t total_ms;         // of the whole download. With IOTC_OTA_DIRECT_DOWNLOAD, writes overlap downloads.
+    uint32_t bytes;             // received from the server
+    uint32_t bytes_per_second;  // bytes over total_ms
+    unsigned int stalls;        // waits for data that took longer than IOTC_OTA_STALL_MS
+    unsigned int retries;       // failed requests that were repeated. Only counted with IOTC_OTA_DIRECT_DOWNLOAD.
+} IotcOtaStats;
+
+// Returns the timing of the last OTA download, or of the current one while it runs.
+// The progress of a download is printed at most once every IOTC_OTA_PROGRESS_INTERVAL_MS.
+void iotc_ota_get_download_stats(IotcOtaStats *stats);
+
+// Limits OTA downloads to bytes_per_second, to leave room on the link for MQTT. 0 removes the limit.
+// The default is IOTC_OTA_RATE_LIMIT. Can be called while a download runs.
+// Regardless of the limit, a download pauses (for up to IOTC_OTA_PUBLISH_PAUSE_MAX_MS per block)
+// while a publish waits for its acknowledgement, and for IOTC_OTA_PUBLISH_QUIET_MS after it.
+void iotc_ota_set_rate_limit(uint32_t bytes_per_second);
+
+// Called at the start of each OTA download, so that batched telemetry can be sent before the download
+// takes over the link. If no callback is set, the current iotc_telemetry_aggregator window is sent.
+typedef void (*IotcOtaBurstCallback)(void);
+void iotc_ota_set_burst_callback(IotcOtaBurstCallback cb);
+
 // Once OTA has been successful, issue a system reset
 void iotc_ota_system_reset(void);
 
+#ifdef IOTC_OTA_DIRECT_DOWNLOAD
+// With IOTC_OTA_DIRECT_DOWNLOAD defined, iotc_ota_run() downloads the image with HTTP range requests
+// into the MCUboot secondary slot directly, instead of using the OTA agent. iotc_ota_run() does not use the user callback.
+// The download offset and the image identity are saved with iotc_kvstore (if available), so a download that was
+// interrupted by a network error or a reboot continues from the last verified block the next time that
+// the same image is downloaded, instead of from the beginning.
+// If the artifact is a delta generated with tools/iotc_ota_delta.py, it is detected by its header and
+// the new image is reconstructed from the running image in the primary slot while it is being downloaded.
+// Likewise, an image compressed with tools/iotc_ota_compress.py is decompressed while it is being downloaded.
+// A writer thread programs each chunk while the next one is downloaded (see IOTC_OTA_DOWNLOAD_PIPELINE).
+// The MCUboot header is checked with the first chunk, and the SHA-256 of the written image is compared with
+// the hash in the image before it is marked as pending, so a corrupted download fails instead of failing at boot.
+// iotc_ota_start() runs the same download in a thread of IOTC_OTA_START_STACK_SIZE bytes and returns right away.
+// Its callback is only called once the download ends: with CY_OTA_REASON_SUCCESS or CY_OTA_REASON_FAILURE,
+// and then with the CY_OTA_STATE_OTA_COMPLETE state change, in both cases with ota_agt_state CY_OTA_STATE_OTA_COMPLETE.
+// Get the result with iotc_ota_get_download_status() rather than cy_ota_get_last_error().
+// Like with the agent, the device is reset after a successful download. iotc_ota_cleanup() is not needed.
+
+// Synchronous download. Returns CY_RSLT_SUCCESS once the image is written and marked as pending for the bootloader,
+// or one of the CY_RSLT_OTA_ERROR_* codes. Unlike iotc_ota_run(), this does not reset the device.
+cy_rslt_t iotc_ota_download(IotConnectConnectionType connection_type, const char* host, const char* path);
+
+// Number of bytes that the last download did not need to download again, because it continued an earlier download.
+uint32_t iotc_ota_get_resumed_bytes(void);
+#endif // IOTC_OTA_DIRECT_DOWNLOAD
+
 #endif // IOTC_OTA_SUPPORT
 
 #endif // IOTC_OTA_H
@@ -0,0 +1,101 @@
+/* SPDX-License-Identifier: MIT
+ * Copyright (C) 2025 Avnet
+ * Authors: Nikola Markovic <nikola.markovic@avnet.com> et al.
+ */
+
+#ifndef IOTC_PROPERTY_CACHE_H
+#define IOTC_PROPERTY_CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <cJSON.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// A local copy of the device properties, so that only the properties that changed need to be reported,
+// and so that inbound desired-property updates can be compared against the current values.
+//
+// Properties change either locally (iotc_property_cache_set_*) or with a delta received from the cloud
+// (iotc_property_cache_apply_delta). Either way, a property is marked changed only if its value actually changed,
+// and iotc_property_cache_report() sends only those properties, as a regular telemetry message.
+//
+// The version of the last applied delta, the values, and which of them still need to be reported are saved
+// with iotc_kvstore (see iotc_kvstore.h) whenever they change, so after a reboot, deltas that were already applied
+// are ignored, local changes that were not reported yet are still reported, and unchanged values are not sent again.
+// Every change is a kvstore write, so values that change often are better sent as telemetry.
+
+// Maximum number of properties
+#ifndef IOTC_PROPERTY_CACHE_SIZE
+#define IOTC_PROPERTY_CACHE_SIZE 16
+#endif
+
+// Largest size of the saved state (JSON text) that will be loaded at init
+#ifndef IOTC_PROPERTY_CACHE_PERSIST_MAX
+#define IOTC_PROPERTY_CACHE_PERSIST_MAX 1024
+#endif
+
+#define IOTC_PROPERTY_CACHE_KV_KEY "iotc_props"
+
+typedef enum {
+    IOTC_PT_NULL = 0,
+    IOTC_PT_NUMBER,
+    IOTC_PT_BOOL,
+    IOTC_PT_STRING
+} IotcPropertyType;
+
+typedef struct {
+    IotcPropertyType type;
+    union {
+        double number;
+        bool boolean;
+        const char *string;
+    } u;
+} IotcPropertyValue;
+
+// Called for every property that was changed by iotc_property_cache_apply_delta().
+// The value is only valid for the duration of the callback. The cache is locked during the callback, so other tasks
+// that use the cache will wait for it, but the callback itself can use the cache.
+typedef void (*IotcPropertyChangeCallback)(const char *name, const IotcPropertyValue *value);
+
+// Loads the saved state, if any. change_cb is optional.
+int iotc_property_cache_init(IotcPropertyChangeCallback change_cb);
+
+void iotc_property_cache_deinit(void);
+
+// Set the local value of a property, and save the state if the value changed.
+// Returns IOTCL_ERR_OUT_OF_MEMORY if the cache is full.
+int iotc_property_cache_set_number(const char *name, double value);
+int iotc_property_cache_set_bool(const char *name, bool value);
+int iotc_property_cache_set_string(const char *name, const char *value);
+
+// Gets the current value of a property. A string value is copied into buffer, and value->u.string points to it.
+// buffer can be NULL if the property is known not to be a string.
+// Returns IOTCL_ERR_MISSING_VALUE if the property is not in the cache,
+// or IOTCL_ERR_OUT_OF_MEMORY if the string does not fit into buffer_size bytes.
+int iotc_property_cache_get(const char *name, IotcPropertyValue *value, char *buffer, size_t buffer_size);
+
+// Applies the members of a JSON object, for example {"interval":10,"mode":"eco"}.
+// Only the properties that differ from the cached values are changed, reported to change_cb, and marked for reporting,
+// which lets the cloud know that the device accepted them.
+// version is the version of the delta. A delta whose version is not newer than the last applied one is ignored.
+// Pass 0 if deltas are not versioned.
+int iotc_property_cache_apply_delta(const cJSON *delta, uint32_t version);
+
+uint32_t iotc_property_cache_get_version(void);
+
+// Number of properties that changed since they were last reported
+size_t iotc_property_cache_get_changed_count(void);
+
+// Sends the properties that changed since they were last reported. Nothing is sent if none changed.
+// iso_time is the "dt" timestamp of the telemetry entry. Pass NULL to use the current time, like iotc-c-lib does,
+// or an empty string to leave the timestamp out.
+int iotc_property_cache_report(const char *iso_time);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IOTC_PROPERTY_CACHE_H
@@ -0,0 +1,71 @@
+/* SPDX-License-Identifier: MIT
+ * Copyright (C) 2025 Avnet
+ * Authors: Nikola Markovic <nikola.markovic@avnet.com> et al.
+ */
+
+#ifndef IOTC_TELEMETRY_AGGREGATOR_H
+#define IOTC_TELEMETRY_AGGREGATOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "iotc_telemetry_writer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Reduces high-rate samples to one summary per time window, using a fixed amount of memory per attribute.
+// Each attribute is reported as an IoTConnect OBJECT attribute:
+//     {"temperature":{"min":22.9,"max":23.4,"mean":23.1,"count":3000}}
+// so the attribute needs to be defined in the device template as an OBJECT with min, max, mean and count members.
+//
+// Example:
+//     iotc_telemetry_aggregator_init(60000);
+//     iotc_telemetry_aggregator_add_attribute("temperature");
+//     ...
+//     // in the sampling task, at any rate:
+//     iotc_telemetry_aggregator_sample("temperature", read_temperature());
+//     // in the main loop:
+//     if (iotc_telemetry_aggregator_is_window_elapsed()) {
+//         iotc_telemetry_aggregator_send(NULL);
+//     }
+//
+// Sampling and sending can be done from different tasks.
+
+// Maximum number of aggregated attributes
+#ifndef IOTC_TELEMETRY_AGGREGATOR_SIZE
+#define IOTC_TELEMETRY_AGGREGATOR_SIZE 8
+#endif
+
+// Removes all attributes and sets the window length.
+void iotc_telemetry_aggregator_init(uint32_t window_ms);
+
+// The name is not copied, so it must remain valid (usually a string literal).
+// Returns IOTCL_SUCCESS, or IOTCL_ERR_OUT_OF_MEMORY if IOTC_TELEMETRY_AGGREGATOR_SIZE attributes are already added.
+int iotc_telemetry_aggregator_add_attribute(const char *name);
+
+// Adds a sample to the current window. Returns IOTCL_ERR_BAD_VALUE for an unknown attribute or a NaN value.
+int iotc_telemetry_aggregator_sample(const char *name, double value);
+
+// Returns true once window_ms has passed since the current window started
+bool iotc_telemetry_aggregator_is_window_elapsed(void);
+
+// Adds the summaries of the current window to the writer and starts a new window.
+// Attributes without samples in the window are left out.
+// If the message is not published, or if this function fails, call iotc_telemetry_aggregator_restore().
+int iotc_telemetry_aggregator_write(IotcTelemetryWriter *w);
+
+// Merges the window taken by the last iotc_telemetry_aggregator_write() back into the current window,
+// so that its samples are included in the next message.
+void iotc_telemetry_aggregator_restore(void);
+
+// Same as iotc_telemetry_aggregator_write(), but creates and sends the message with an SDK-owned writer buffer.
+// iso_time is the same as in iotc_telemetry_writer_begin(). Nothing is sent if there were no samples in the window.
+// If the message cannot be sent, the window is restored and an error is returned.
+int iotc_telemetry_aggregator_send(const char *iso_time);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IOTC_TELEMETRY_AGGREGATOR_H
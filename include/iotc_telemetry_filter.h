@@ -0,0 +1,85 @@
+/* SPDX-License-Identifier: MIT
+ * Copyright (C) 2025 Avnet
+ * Authors: Nikola Markovic <nikola.markovic@avnet.com> et al.
+ */
+
+#ifndef IOTC_TELEMETRY_FILTER_H
+#define IOTC_TELEMETRY_FILTER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "iotc_telemetry_writer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Suppresses telemetry attributes that did not change since they were last sent.
+// A number is sent only if it moved by more than its deadband from the last sent value.
+// Strings and booleans are sent only if they changed, regardless of the deadband. Every attribute is sent at least once per max_interval_ms
+// so that the cloud keeps seeing it. Attributes without a rule are always sent.
+//
+// Example:
+//     iotc_telemetry_filter_add_rule("temperature", 0.2, 60000); // at least 0.2 degrees, or once a minute
+//     iotc_telemetry_filter_add_rule("door_open", 0, 300000);
+//     ...
+//     iotc_telemetry_writer_begin(&w, NULL, 0, NULL);
+//     iotc_telemetry_filter_add_number(&w, "temperature", temperature);
+//     iotc_telemetry_filter_add_bool(&w, "door_open", door_open);
+//     if (!iotc_telemetry_writer_has_data(&w)) {
+//         iotc_telemetry_writer_release(&w);
+//     } else if (IOTCL_SUCCESS == iotc_telemetry_writer_send(&w)) {
+//         iotc_telemetry_filter_commit();
+//     } else {
+//         iotc_telemetry_filter_discard();
+//     }
+//
+// The values that pass the filter are recorded as sent only by iotc_telemetry_filter_commit(), so that values
+// from a message that failed to publish are compared against the last published values and sent again.
+// Strings are copied with iotcl_malloc().
+// The filter is meant to be used from a single task (the one that sends telemetry).
+
+// Maximum number of attributes with a rule
+#ifndef IOTC_TELEMETRY_FILTER_SIZE
+#define IOTC_TELEMETRY_FILTER_SIZE 16
+#endif
+
+typedef struct {
+    unsigned int sent;          // Values that passed the filter because they changed, or had no previous value
+    unsigned int refreshed;     // Unchanged values that passed the filter because max_interval_ms expired
+    unsigned int suppressed;    // Values that were filtered out
+} IotcTelemetryFilterStats;
+
+// Adds or updates the rule for an attribute. The name is not copied, so it must remain valid (usually a string literal).
+// deadband is the absolute change that a number needs to exceed to be sent. Use 0 to send on any change.
+// max_interval_ms is the longest time that a value is held back. Use 0 to never force a refresh.
+// Returns IOTCL_SUCCESS, or IOTCL_ERR_OUT_OF_MEMORY if IOTC_TELEMETRY_FILTER_SIZE rules are already added.
+int iotc_telemetry_filter_add_rule(const char *name, double deadband, uint32_t max_interval_ms);
+
+// Return true if the value should be sent. The value is recorded as sent by the next iotc_telemetry_filter_commit().
+bool iotc_telemetry_filter_check_number(const char *name, double value);
+bool iotc_telemetry_filter_check_string(const char *name, const char *value);
+bool iotc_telemetry_filter_check_bool(const char *name, bool value);
+
+// Add the value to the writer if it passes the filter. Return IOTCL_SUCCESS if the value was suppressed.
+int iotc_telemetry_filter_add_number(IotcTelemetryWriter *w, const char *name, double value);
+int iotc_telemetry_filter_add_string(IotcTelemetryWriter *w, const char *name, const char *value);
+int iotc_telemetry_filter_add_bool(IotcTelemetryWriter *w, const char *name, bool value);
+
+// Records the values that passed the filter since the last commit or discard as sent.
+// Call after the message with those values was published.
+void iotc_telemetry_filter_commit(void);
+
+// Drops the values that passed the filter since the last commit, for example if the message failed to publish.
+void iotc_telemetry_filter_discard(void);
+
+// Forgets the last sent values so that every attribute will be sent next time. The rules are kept.
+void iotc_telemetry_filter_reset(void);
+
+void iotc_telemetry_filter_get_stats(IotcTelemetryFilterStats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IOTC_TELEMETRY_FILTER_H
@@ -0,0 +1,88 @@
+/* SPDX-License-Identifier: MIT
+ * Copyright (C) 2025 Avnet
+ * Authors: Nikola Markovic <nikola.markovic@avnet.com> et al.
+ */
+
+#ifndef IOTC_TELEMETRY_TEMPLATE_H
+#define IOTC_TELEMETRY_TEMPLATE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Telemetry for applications that send the same set of attributes in every message.
+// The schema is compiled once into the literal JSON segments (envelope, quoted names, separators),
+// so that each send only copies those and formats the values in between.
+// The output is the same JSON that the telemetry writer (iotc_telemetry_writer.h) would produce.
+//
+// Example:
+//     static const IotcTemplateField fields[] = {
+//         {"temperature", IOTC_TF_NUMBER, 2},
+//         {"pressure", IOTC_TF_NUMBER, IOTC_TF_SHORTEST},
+//         {"counter", IOTC_TF_INT, 0},
+//         {"door_open", IOTC_TF_BOOL, 0},
+//     };
+//     IotcTelemetryTemplate *t = iotc_telemetry_template_create(fields, 4, 0);
+//     ...
+//     IotcTemplateValue values[4];
+//     values[0].number = 23.456;
+//     values[1].number = 1013.25;
+//     values[2].integer = 42;
+//     values[3].boolean = false;
+//     iotc_telemetry_template_send(t, values, NULL);
+//     // {"d":[{"dt":"<now>","d":{"temperature":23.46,"pressure":1013.25,"counter":42,"door_open":false}}]}
+
+typedef enum {
+    IOTC_TF_NUMBER = 0,
+    IOTC_TF_INT,
+    IOTC_TF_BOOL,
+    IOTC_TF_STRING, // a NULL value will be sent as null
+} IotcTemplateFieldType;
+
+// Use as decimals for the shortest round-trip form, like iotc_telemetry_writer_add_number()
+#define IOTC_TF_SHORTEST (-1)
+
+typedef struct {
+    const char *name;
+    IotcTemplateFieldType type;
+    // For IOTC_TF_NUMBER: 0-9 to round to that many decimals, like iotc_telemetry_writer_add_number_precision(),
+    // or IOTC_TF_SHORTEST. Ignored for the other types.
+    int decimals;
+} IotcTemplateField;
+
+typedef union {
+    double number;
+    int64_t integer;
+    bool boolean;
+    const char *string;
+} IotcTemplateValue;
+
+typedef struct IotcTelemetryTemplate IotcTelemetryTemplate;
+
+// Compiles the schema. The field names are copied, so the fields array does not need to be retained.
+// buffer_size is the size of the template's send buffer. Pass 0 to use IOTC_JSON_PRINT_BUFFER_SIZE.
+// Returns NULL if out of memory or if the schema is invalid.
+IotcTelemetryTemplate *iotc_telemetry_template_create(const IotcTemplateField *fields, size_t field_count, size_t buffer_size);
+
+// Formats the message into the caller's buffer. values must have one entry per field, in schema order.
+// iso_time is the "dt" timestamp of the telemetry entry. Pass NULL to use the current time, like iotc-c-lib does,
+// or an empty string to leave the timestamp out.
+// Returns IOTCL_SUCCESS, IOTCL_ERR_OUT_OF_MEMORY if the message did not fit, or IOTCL_ERR_BAD_VALUE.
+int iotc_telemetry_template_format(const IotcTelemetryTemplate *t, const IotcTemplateValue *values, const char *iso_time,
+        char *buffer, size_t buffer_size, size_t *length);
+
+// Formats the message into the template's own buffer and publishes it to the telemetry topic.
+// The template's buffer is not protected, so a template should be sent from one task only.
+int iotc_telemetry_template_send(IotcTelemetryTemplate *t, const IotcTemplateValue *values, const char *iso_time);
+
+void iotc_telemetry_template_destroy(IotcTelemetryTemplate *t);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IOTC_TELEMETRY_TEMPLATE_H
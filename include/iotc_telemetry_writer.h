@@ -0,0 +1,79 @@
+/* SPDX-License-Identifier: MIT
+ * Copyright (C) 2025 Avnet
+ * Authors: Nikola Markovic <nikola.markovic@avnet.com> et al.
+ */
+
+#ifndef IOTC_TELEMETRY_WRITER_H
+#define IOTC_TELEMETRY_WRITER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// A streaming alternative to iotcl_telemetry_create() and iotcl_telemetry_set_*().
+// Attributes are serialized directly into a single buffer as they are added, without building a cJSON tree
+// and without any per-attribute allocation. The output is the same JSON that iotcl_mqtt_send_telemetry() would send,
+// except that numbers are formatted with iotc_fmt_double() instead of cJSON's printf-based formatting.
+//
+// Example:
+//     IotcTelemetryWriter w;
+//     iotc_telemetry_writer_begin(&w, NULL, 0, NULL); // use an SDK buffer
+//     iotc_telemetry_writer_add_number(&w, "temperature", 23.5);
+//     iotc_telemetry_writer_add_string(&w, "version", "1.0");
+//     iotc_telemetry_writer_send(&w);
+
+typedef struct {
+    char *buffer;
+    size_t size;
+    size_t length;
+    uint32_t has_members; // bit N is set when the object at nesting depth N has at least one member
+    int depth;            // depth of objects opened with iotc_telemetry_writer_begin_object()
+    bool is_sdk_buffer;   // the buffer is from iotc_json_mem_get_buffer(), rather than provided by the caller
+    bool is_overflow;
+    bool is_finished;
+} IotcTelemetryWriter;
+
+// Starts a telemetry message. If buffer is NULL, one of the SDK's print buffers will be used (see iotc_json_mem.h).
+// An SDK buffer moves to the heap if the message outgrows it, while a message that outgrows the caller's buffer fails.
+// iso_time is the "dt" timestamp of the telemetry entry. Pass NULL to use the current time, like iotc-c-lib does,
+// or an empty string to leave the timestamp out.
+// Returns IOTCL_SUCCESS or IOTCL_ERR_OUT_OF_MEMORY if the buffer is too small or out of memory.
+int iotc_telemetry_writer_begin(IotcTelemetryWriter *w, char *buffer, size_t buffer_size, const char *iso_time);
+
+// The add functions return IOTCL_ERR_OUT_OF_MEMORY if the message no longer fits into the buffer.
+// Once that happens, the writer will reject further calls, so it is sufficient to check the result
+// of iotc_telemetry_writer_finish() or iotc_telemetry_writer_send().
+int iotc_telemetry_writer_add_number(IotcTelemetryWriter *w, const char *name, double value);
+// Writes the number rounded to the given number of decimals (0-9). For example, 2 for temperatures.
+int iotc_telemetry_writer_add_number_precision(IotcTelemetryWriter *w, const char *name, double value, int decimals);
+int iotc_telemetry_writer_add_int(IotcTelemetryWriter *w, const char *name, int64_t value);
+int iotc_telemetry_writer_add_string(IotcTelemetryWriter *w, const char *name, const char *value);
+int iotc_telemetry_writer_add_bool(IotcTelemetryWriter *w, const char *name, bool value);
+int iotc_telemetry_writer_add_null(IotcTelemetryWriter *w, const char *name);
+
+// Nested objects for IoTConnect "OBJECT" type attributes
+int iotc_telemetry_writer_begin_object(IotcTelemetryWriter *w, const char *name);
+int iotc_telemetry_writer_end_object(IotcTelemetryWriter *w);
+
+// Returns true if at least one attribute was added
+bool iotc_telemetry_writer_has_data(const IotcTelemetryWriter *w);
+
+// Completes the message and returns the null terminated JSON string, or NULL if the message did not fit.
+// The string remains valid until iotc_telemetry_writer_release() is called.
+const char *iotc_telemetry_writer_finish(IotcTelemetryWriter *w, size_t *length);
+
+// Completes the message, publishes it to the telemetry topic and releases the writer.
+int iotc_telemetry_writer_send(IotcTelemetryWriter *w);
+
+// Frees the SDK buffer (if used). Safe to call multiple times.
+void iotc_telemetry_writer_release(IotcTelemetryWriter *w);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IOTC_TELEMETRY_WRITER_H
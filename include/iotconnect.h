@@ -30,9 +30,10 @@ typedef void (*IotConnectStatusCallback)(IotConnectConnectionStatus data);
 
 typedef struct {
 	const char* server_ca_cert; // OPTIONAL server cert that will default to AmazonRootCA1 or Digicert G2 depending on connection type
-	const char* device_cert; // CA cert (or chain) in PEM format
-	const char* device_key; // Device private key either in PEM format or as an  MbedTLS opaque key (see device_key_size).
-	size_t device_key_size; // If using a PEM private key, you should leave this value at zero. If using opaque keys or similar, set this accordingly.
+	const char* device_cert; // CA cert (or chain) in PEM or DER format (see device_cert_size)
+	const char* device_key; // Device private key either in PEM or DER format or as an  MbedTLS opaque key (see device_key_size).
+	size_t device_key_size; // If using a PEM private key, you should leave this value at zero. If using DER, opaque keys or similar, set this accordingly.
+	size_t device_cert_size; // If using a PEM cert, you can leave this value at zero. If using a DER cert, set it to its length.
 } IotConnectX509Config;
 
 
@@ -72,10 +73,19 @@ cy_rslt_t iotconnect_sdk_connect(void);
 // This all will serve all messages in the queue (if any) and call appropriate command/OTA callbacks
 // Wait up to timeout_ms milliseconds, and if messages are available, processes them with itc-c-lib
 // If timeout_ms is zero, the call will block forever until a message arrives
+// The call also returns early when an async command handler completes (see iotc_command.h), and sends its acknowledgement.
 void iotconnect_sdk_poll_inbound_mq(cy_time_t timeout_ms);
 
 bool iotconnect_sdk_is_connected(void);
 
+// Publishes an already serialized telemetry message to the telemetry topic.
+// See iotc_telemetry_writer.h for a way to create telemetry messages without iotcl_telemetry_create().
+cy_rslt_t iotconnect_sdk_send_telemetry_json(const char *json_str);
+
+// Sends the same command acknowledgement as iotcl_mqtt_send_cmd_ack(), but prints it into one of the SDK's
+// print buffers (see iotc_json_mem.h) instead of a new heap string. status is one of the IOTCL_C2D_EVT_CMD_* values.
+cy_rslt_t iotconnect_sdk_send_cmd_ack(const char *ack_id, int status, const char *message);
+
 cy_rslt_t iotconnect_sdk_disconnect(void);
 
 void iotconnect_sdk_deinit(void);
@@ -0,0 +1,83 @@
+/* SPDX-License-Identifier: MIT
+ * Copyright (C) 2025 Avnet
+ * Authors: Nikola Markovic <nikola.markovic@avnet.com> et al.
+ */
+
+#include <string.h>
+#include <stdio.h>
+#include <malloc.h>
+
+#include "cyabs_rtos.h"
+#include "cy_tls.h"
+
+#include "iotcl.h"
+#include "iotc_ca_store.h"
+#include "iotc_certs.h"
+
+static bool is_loaded = false;
+static IotConnectConnectionType loaded_connection_type = IOTC_CT_UNDEFINED;
+static IotcCaStoreStats stats = {0};
+
+static size_t get_heap_used(void) {
+    struct mallinfo mi = mallinfo();
+    return (size_t) mi.uordblks;
+}
+
+cy_rslt_t iotc_ca_store_init(IotConnectConnectionType connection_type) {
+    size_t mqtt_root_size = 0;
+    cy_time_t start_time = 0;
+    cy_time_t end_time = 0;
+
+    iotc_ca_store_deinit();
+
+    const char *mqtt_root = iotc_certs_get_root(connection_type, &mqtt_root_size);
+    if (!mqtt_root) {
+        printf("CA Store: Unknown connection type %d\n", connection_type);
+        return (cy_rslt_t) IOTCL_ERR_BAD_VALUE;
+    }
+
+    // Only the MQTT/OTA root goes into the store, because every connection that leaves root_ca NULL trusts
+    // all of the roots in it. The HTTP discovery and identity calls have a different root, so they pass it
+    // per connection, which happens only a couple of times at init.
+    size_t heap_before = get_heap_used();
+    (void) cy_rtos_get_time(&start_time);
+    cy_rslt_t result = cy_tls_load_global_root_ca_certificates(mqtt_root, (uint32_t) mqtt_root_size);
+    (void) cy_rtos_get_time(&end_time);
+    size_t heap_after = get_heap_used();
+
+    if (CY_RSLT_SUCCESS != result) {
+        printf("CA Store: Failed to load the root certificates. Error was 0x%08lx\n", (unsigned long) result);
+        return result;
+    }
+
+    is_loaded = true;
+    loaded_connection_type = connection_type;
+    stats.cert_size = mqtt_root_size;
+    stats.heap_size = heap_after > heap_before ? heap_after - heap_before : 0;
+    stats.parse_time_ms = end_time - start_time;
+    stats.connections = 0;
+    return CY_RSLT_SUCCESS;
+}
+
+bool iotc_ca_store_lend(IotConnectConnectionType connection_type) {
+    if (!is_loaded) {
+        return false;
+    }
+    if (IOTC_CT_UNDEFINED == connection_type || loaded_connection_type != connection_type) {
+        return false; // see iotc_ca_store_init()
+    }
+    stats.connections++;
+    return true;
+}
+
+void iotc_ca_store_get_stats(IotcCaStoreStats *s) {
+    memcpy(s, &stats, sizeof(IotcCaStoreStats));
+}
+
+void iotc_ca_store_deinit(void) {
+    if (is_loaded) {
+        cy_tls_release_global_root_ca_certificates();
+        is_loaded = false;
+    }
+    loaded_connection_type = IOTC_CT_UNDEFINED;
+}
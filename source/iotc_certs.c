@@ -0,0 +1,50 @@
+/* SPDX-License-Identifier: MIT
+ * Copyright (C) 2025 Avnet
+ * Authors: Nikola Markovic <nikola.markovic@avnet.com> et al.
+ */
+
+#include <stdio.h>
+
+#ifdef IOTC_CERTS_DER
+#include "iotc_certs_der.h"
+#define IOTC_ROOT_AWS       IOTC_DER_AMAZON_ROOT_CA1
+#define IOTC_ROOT_AZURE     IOTC_DER_DIGICERT_GLOBAL_ROOT_G2
+#define IOTC_ROOT_HTTP      IOTC_DER_GODADDY_SECURE_SERVER_CERTIFICATE_G2
+#else
+#include "iotcl_certs.h"
+#define IOTC_ROOT_AWS       IOTCL_AMAZON_ROOT_CA1
+#define IOTC_ROOT_AZURE     IOTCL_CERT_DIGICERT_GLOBAL_ROOT_G2
+#define IOTC_ROOT_HTTP      IOTCL_CERT_GODADDY_SECURE_SERVER_CERTIFICATE_G2
+#endif
+
+#include "iotc_certs.h"
+
+// sizeof() includes the null terminator for PEM strings and is the exact length of DER arrays
+
+const char *iotc_certs_get_root(IotConnectConnectionType connection_type, size_t *size) {
+#ifdef IOTC_FIXED_CONNECTION_TYPE
+    if (connection_type != IOTC_FIXED_CONNECTION_TYPE) {
+        printf("This build supports only connection type %d!\n", IOTC_FIXED_CONNECTION_TYPE);
+        return NULL;
+    }
+#endif
+    switch (connection_type) {
+#ifndef IOTC_CONNECTION_TYPE_AZURE_ONLY
+        case IOTC_CT_AWS:
+            *size = sizeof(IOTC_ROOT_AWS);
+            return (const char *) IOTC_ROOT_AWS;
+#endif
+#ifndef IOTC_CONNECTION_TYPE_AWS_ONLY
+        case IOTC_CT_AZURE:
+            *size = sizeof(IOTC_ROOT_AZURE);
+            return (const char *) IOTC_ROOT_AZURE;
+#endif
+        default:
+            return NULL;
+    }
+}
+
+const char *iotc_certs_get_http_root(size_t *size) {
+    *size = sizeof(IOTC_ROOT_HTTP);
+    return (const char *) IOTC_ROOT_HTTP;
+}
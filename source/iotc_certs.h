@@ -0,0 +1,34 @@
+/* SPDX-License-Identifier: MIT
+ * Copyright (C) 2025 Avnet
+ * Authors: Nikola Markovic <nikola.markovic@avnet.com> et al.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include "iotconnect.h"
+
+// Define one of these to link in only the root certificates for that connection type.
+// iotconnect_sdk_init() will reject the other connection type.
+#if defined(IOTC_CONNECTION_TYPE_AWS_ONLY) && defined(IOTC_CONNECTION_TYPE_AZURE_ONLY)
+#error "Only one of IOTC_CONNECTION_TYPE_AWS_ONLY or IOTC_CONNECTION_TYPE_AZURE_ONLY can be defined"
+#endif
+
+#if defined(IOTC_CONNECTION_TYPE_AWS_ONLY)
+#define IOTC_FIXED_CONNECTION_TYPE IOTC_CT_AWS
+#elif defined(IOTC_CONNECTION_TYPE_AZURE_ONLY)
+#define IOTC_FIXED_CONNECTION_TYPE IOTC_CT_AZURE
+#endif
+
+// Define IOTC_CERTS_DER to link the root certificates as DER byte arrays instead of PEM text.
+// The arrays are generated at build time with tools/iotc_certs_der.py into iotc_certs_der.h,
+// which needs to be in the include path of the application.
+
+// Returns the root certificate for MQTT and OTA connections of the given type,
+// or NULL if the connection type is not supported by this build.
+// The certificate is DER if built with IOTC_CERTS_DER, or a null terminated PEM string otherwise.
+// In both cases size is set to the value that the TLS layer expects in root_ca_size.
+const char *iotc_certs_get_root(IotConnectConnectionType connection_type, size_t *size);
+
+// Returns the root certificate for the HTTP discovery and identity services. See iotc_certs_get_root().
+const char *iotc_certs_get_http_root(size_t *size);
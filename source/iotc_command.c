@@ -0,0 +1,403 @@
+/* SPDX-License-Identifier: MIT
+ * Copyright (C) 2025 Avnet
+ * Authors: Nikola Markovic <nikola.markovic@avnet.com> et al.
+ */
+
+#include <string.h>
+#include <stdio.h>
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "cyabs_rtos.h"
+
+#include "iotcl.h"
+#include "iotconnect.h"
+#include "iotc_mqtt_mq.h"
+#include "iotc_command.h"
+
+#if (IOTC_COMMAND_TABLE_SIZE & (IOTC_COMMAND_TABLE_SIZE - 1)) != 0
+#error "IOTC_COMMAND_TABLE_SIZE must be a power of two"
+#endif
+
+#define TABLE_MASK (IOTC_COMMAND_TABLE_SIZE - 1)
+
+// How often iotc_command_deinit() checks whether the workers exited
+#define DEINIT_POLL_MS 10
+
+typedef struct {
+    const char *name; // NULL if the slot is free
+    uint32_t hash;
+    IotcCommandHandler handler;
+    bool is_async;
+} CommandSlot;
+
+typedef enum {
+    JOB_FREE = 0,
+    JOB_QUEUED,     // queued or running in a worker
+    JOB_DONE        // waiting for the acknowledgement to be sent
+} JobState;
+
+typedef struct {
+    JobState state;
+    uint32_t sequence;
+    IotcCommandHandler handler;
+    char *line; // owns the strings in argv
+    char *ack_id;
+    int argc;
+    char *argv[IOTC_COMMAND_MAX_ARGS + 1];
+    int status;
+    char ack_msg[IOTC_COMMAND_ACK_MSG_SIZE];
+} CommandJob;
+
+// Open addressing with linear probing. The table is kept free of tombstones (see iotc_command_unregister()),
+// so a lookup stops at the first free slot.
+static CommandSlot table[IOTC_COMMAND_TABLE_SIZE];
+static size_t command_count = 0;
+
+// Async commands. The job states and sequence numbers are shared with the workers and guarded by critical sections.
+static CommandJob jobs[IOTC_COMMAND_MAX_PENDING];
+static cy_queue_t job_queue; // of CommandJob pointers. NULL tells a worker to exit.
+static cy_thread_t workers[IOTC_COMMAND_WORKER_COUNT];
+static bool is_workers_started = false;
+static volatile bool is_stopping = false; // set by iotc_command_deinit(). Queued jobs are then dropped.
+static int exited_worker_count = 0;
+static uint32_t next_sequence = 0;     // assigned to the next async command
+static uint32_t next_ack_sequence = 0; // the async command that needs to be acknowledged next
+
+// FNV-1a
+static uint32_t hash_name(const char *name) {
+    uint32_t hash = 2166136261u;
+    for (const unsigned char *p = (const unsigned char *) name; *p; p++) {
+        hash ^= *p;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static CommandSlot *find_slot(const char *name, uint32_t hash) {
+    for (uint32_t i = 0; i < IOTC_COMMAND_TABLE_SIZE; i++) {
+        CommandSlot *slot = &table[(hash + i) & TABLE_MASK];
+        if (!slot->name) {
+            return NULL;
+        }
+        if (slot->hash == hash && 0 == strcmp(slot->name, name)) {
+            return slot;
+        }
+    }
+    return NULL;
+}
+
+static void insert_slot(const CommandSlot *entry) {
+    for (uint32_t i = 0; i < IOTC_COMMAND_TABLE_SIZE; i++) {
+        CommandSlot *slot = &table[(entry->hash + i) & TABLE_MASK];
+        if (!slot->name) {
+            *slot = *entry;
+            return;
+        }
+    }
+}
+
+static void worker_thread(cy_thread_arg_t arg) {
+    CommandJob *job;
+    (void) arg;
+    while (CY_RSLT_SUCCESS == cy_rtos_get_queue(&job_queue, &job, CY_RTOS_NEVER_TIMEOUT, false) && job) {
+        if (is_stopping) {
+            continue; // the job is freed by iotc_command_deinit()
+        }
+        job->ack_msg[0] = 0;
+        job->status = job->handler(job->argc, job->argv, job->ack_msg, sizeof(job->ack_msg));
+        taskENTER_CRITICAL();
+        job->state = JOB_DONE;
+        taskEXIT_CRITICAL();
+        iotc_mq_wake(); // so that the acknowledgement is sent without waiting for the poll timeout
+    }
+    taskENTER_CRITICAL();
+    exited_worker_count++;
+    taskEXIT_CRITICAL();
+    cy_rtos_exit_thread();
+}
+
+static int start_workers(void) {
+    if (is_workers_started) {
+        return IOTCL_SUCCESS;
+    }
+    if (CY_RSLT_SUCCESS != cy_rtos_init_queue(&job_queue, IOTC_COMMAND_MAX_PENDING + IOTC_COMMAND_WORKER_COUNT, sizeof(CommandJob *))) {
+        printf("IOTC: Failed to create the command worker queue!\n");
+        return IOTCL_ERR_FAILED;
+    }
+    for (int i = 0; i < IOTC_COMMAND_WORKER_COUNT; i++) {
+        cy_rslt_t result = cy_rtos_create_thread(&workers[i], worker_thread, "iotc_cmd", NULL,
+                IOTC_COMMAND_WORKER_STACK_SIZE, IOTC_COMMAND_WORKER_PRIORITY, NULL);
+        if (CY_RSLT_SUCCESS != result) {
+            printf("IOTC: Failed to create a command worker. Error was 0x%08lx\n", (unsigned long) result);
+            // stop the workers that were started
+            for (int j = 0; j < i; j++) {
+                CommandJob *stop = NULL;
+                (void) cy_rtos_put_queue(&job_queue, &stop, CY_RTOS_NEVER_TIMEOUT, false);
+            }
+            for (int j = 0; j < i; j++) {
+                (void) cy_rtos_join_thread(&workers[j]);
+            }
+            exited_worker_count = 0;
+            cy_rtos_deinit_queue(&job_queue);
+            return IOTCL_ERR_FAILED;
+        }
+    }
+    is_workers_started = true;
+    return IOTCL_SUCCESS;
+}
+
+static int register_handler(const char *name, IotcCommandHandler handler, bool is_async) {
+    if (!name || !*name || strchr(name, ' ') || !handler) {
+        return IOTCL_ERR_BAD_VALUE;
+    }
+    uint32_t hash = hash_name(name);
+    CommandSlot *slot = find_slot(name, hash);
+    if (slot) {
+        slot->handler = handler;
+        slot->is_async = is_async;
+        return IOTCL_SUCCESS;
+    }
+    // always keep one slot free, so that probing terminates
+    if (command_count >= IOTC_COMMAND_TABLE_SIZE - 1) {
+        printf("IOTC: Command table is full. Increase IOTC_COMMAND_TABLE_SIZE.\n");
+        return IOTCL_ERR_OUT_OF_MEMORY;
+    }
+    CommandSlot entry = {name, hash, handler, is_async};
+    insert_slot(&entry);
+    command_count++;
+    return IOTCL_SUCCESS;
+}
+
+int iotc_command_register(const char *name, IotcCommandHandler handler) {
+    return register_handler(name, handler, false);
+}
+
+int iotc_command_register_async(const char *name, IotcCommandHandler handler) {
+    int status = start_workers();
+    if (status) {
+        return status;
+    }
+    return register_handler(name, handler, true);
+}
+
+void iotc_command_unregister(const char *name) {
+    if (!name) {
+        return;
+    }
+    CommandSlot *slot = find_slot(name, hash_name(name));
+    if (!slot) {
+        return;
+    }
+    slot->name = NULL;
+    command_count--;
+    // re-insert the rest of the probe cluster, so that entries after the removed one remain reachable
+    uint32_t index = (uint32_t) (slot - table);
+    for (uint32_t i = (index + 1) & TABLE_MASK; table[i].name; i = (i + 1) & TABLE_MASK) {
+        CommandSlot moved = table[i];
+        table[i].name = NULL;
+        insert_slot(&moved);
+    }
+}
+
+void iotc_command_clear(void) {
+    memset(table, 0, sizeof(table));
+    command_count = 0;
+}
+
+static void send_ack(const char *ack_id, bool is_success, const char *message) {
+    if (!ack_id) {
+        return; // acknowledgement was not requested
+    }
+    int status = is_success ? IOTCL_C2D_EVT_CMD_SUCCESS_WITH_ACK : IOTCL_C2D_EVT_CMD_FAILED;
+    if (CY_RSLT_SUCCESS != iotconnect_sdk_send_cmd_ack(ack_id, status, message)) {
+        printf("IOTC: Failed to send the command acknowledgement!\n");
+    }
+}
+
+// Splits the line in place on spaces. Returns argc.
+static int split_args(char *line, char **argv) {
+    int argc = 0;
+    char *p = line;
+    while (*p && argc < IOTC_COMMAND_MAX_ARGS) {
+        while (' ' == *p) {
+            p++;
+        }
+        if (!*p) {
+            break;
+        }
+        argv[argc++] = p;
+        while (*p && ' ' != *p) {
+            p++;
+        }
+        if (*p) {
+            *p++ = 0;
+        }
+    }
+    argv[argc] = NULL;
+    return argc;
+}
+
+static void free_job(CommandJob *job) {
+    iotcl_free(job->line);
+    iotcl_free(job->ack_id);
+    memset(job, 0, sizeof(CommandJob));
+}
+
+// Takes ownership of line if successful
+static bool submit_job(IotcCommandHandler handler, char *line, int argc, char **argv, const char *ack_id) {
+    CommandJob *job = NULL;
+    char *ack_id_copy = NULL;
+    if (is_stopping) {
+        return false;
+    }
+    if (ack_id) {
+        ack_id_copy = iotcl_strdup(ack_id);
+        if (!ack_id_copy) {
+            return false;
+        }
+    }
+
+    taskENTER_CRITICAL();
+    for (int i = 0; i < IOTC_COMMAND_MAX_PENDING; i++) {
+        if (JOB_FREE == jobs[i].state) {
+            job = &jobs[i];
+            job->state = JOB_QUEUED;
+            job->sequence = next_sequence++;
+            break;
+        }
+    }
+    taskEXIT_CRITICAL();
+    if (!job) {
+        printf("IOTC: Too many async commands in progress. Increase IOTC_COMMAND_MAX_PENDING.\n");
+        iotcl_free(ack_id_copy);
+        return false;
+    }
+
+    job->handler = handler;
+    job->line = line;
+    job->ack_id = ack_id_copy;
+    job->argc = argc;
+    memcpy(job->argv, argv, sizeof(job->argv));
+    // the queue has room for every job, so this will not block
+    if (CY_RSLT_SUCCESS != cy_rtos_put_queue(&job_queue, &job, 0, false)) {
+        // mark it as done, so that the sequence does not stall. It will be acknowledged as failed.
+        printf("IOTC: Failed to queue an async command!\n");
+        job->status = IOTCL_ERR_FAILED;
+        taskENTER_CRITICAL();
+        job->state = JOB_DONE;
+        taskEXIT_CRITICAL();
+    }
+    return true;
+}
+
+void iotc_command_send_completed_acks(void) {
+    while (is_workers_started) {
+        CommandJob *job = NULL;
+        taskENTER_CRITICAL();
+        for (int i = 0; i < IOTC_COMMAND_MAX_PENDING; i++) {
+            if (JOB_DONE == jobs[i].state && jobs[i].sequence == next_ack_sequence) {
+                job = &jobs[i];
+                break;
+            }
+        }
+        taskEXIT_CRITICAL();
+        if (!job) {
+            return; // nothing pending, or the oldest command is still running
+        }
+        send_ack(job->ack_id, IOTCL_SUCCESS == job->status, job->ack_msg[0] ? job->ack_msg : NULL);
+        taskENTER_CRITICAL();
+        free_job(job);
+        next_ack_sequence++;
+        taskEXIT_CRITICAL();
+    }
+}
+
+bool iotc_command_is_stopping(void) {
+    return is_stopping;
+}
+
+int iotc_command_deinit(void) {
+    if (!is_workers_started) {
+        return IOTCL_SUCCESS;
+    }
+    if (!is_stopping) {
+        is_stopping = true;
+        for (int i = 0; i < IOTC_COMMAND_WORKER_COUNT; i++) {
+            CommandJob *stop = NULL;
+            // the queue has room for a stop request from every worker on top of the jobs
+            (void) cy_rtos_put_queue(&job_queue, &stop, 0, false);
+        }
+    }
+
+    // a handler that is still running may take a while, so wait only for a bounded time
+    cy_time_t start = 0;
+    cy_time_t now = 0;
+    (void) cy_rtos_get_time(&start);
+    while (exited_worker_count < IOTC_COMMAND_WORKER_COUNT) {
+        (void) cy_rtos_get_time(&now);
+        if ((now - start) >= IOTC_COMMAND_DEINIT_TIMEOUT_MS) {
+            printf("IOTC: Command handlers did not complete within %u ms. Leaving the command workers running.\n",
+                    (unsigned int) IOTC_COMMAND_DEINIT_TIMEOUT_MS);
+            return IOTCL_ERR_FAILED;
+        }
+        (void) cy_rtos_delay_milliseconds(DEINIT_POLL_MS);
+    }
+
+    for (int i = 0; i < IOTC_COMMAND_WORKER_COUNT; i++) {
+        (void) cy_rtos_join_thread(&workers[i]);
+    }
+    cy_rtos_deinit_queue(&job_queue);
+    for (int i = 0; i < IOTC_COMMAND_MAX_PENDING; i++) {
+        if (JOB_FREE != jobs[i].state) {
+            free_job(&jobs[i]);
+        }
+    }
+    next_sequence = 0;
+    next_ack_sequence = 0;
+    exited_worker_count = 0;
+    is_workers_started = false;
+    is_stopping = false;
+    return IOTCL_SUCCESS;
+}
+
+void iotc_command_dispatch(IotclC2dEventData data, IotclCommandCallback fallback) {
+    char *argv[IOTC_COMMAND_MAX_ARGS + 1];
+    char ack_msg[IOTC_COMMAND_ACK_MSG_SIZE];
+    const char *command = iotcl_c2d_get_command(data);
+    const char *ack_id = iotcl_c2d_get_ack_id(data);
+    CommandSlot *slot = NULL;
+    char *line = NULL;
+    int argc = 0;
+
+    if (command && command_count > 0) {
+        line = iotcl_strdup(command);
+        if (!line) {
+            printf("IOTC: Out of memory while processing a command!\n");
+            send_ack(ack_id, false, "Out of memory");
+            return;
+        }
+        argc = split_args(line, argv);
+        if (argc > 0) {
+            slot = find_slot(argv[0], hash_name(argv[0]));
+        }
+    }
+
+    if (slot && slot->is_async) {
+        if (submit_job(slot->handler, line, argc, argv, ack_id)) {
+            return; // the job owns the line now
+        }
+        send_ack(ack_id, false, "Busy");
+    } else if (slot) {
+        ack_msg[0] = 0;
+        int status = slot->handler(argc, argv, ack_msg, sizeof(ack_msg));
+        send_ack(ack_id, IOTCL_SUCCESS == status, ack_msg[0] ? ack_msg : NULL);
+    } else if (fallback) {
+        fallback(data);
+    } else {
+        printf("IOTC: Unknown command \"%s\"\n", command ? command : "");
+        send_ack(ack_id, false, "Unknown command");
+    }
+    iotcl_free(line);
+}
@@ -0,0 +1,187 @@
+/* SPDX-License-Identifier: MIT
+ * Copyright (C) 2025 Avnet
+ * Authors: Nikola Markovic <nikola.markovic@avnet.com> et al.
+ */
+
+#include <string.h>
+#include <stdio.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "cyabs_rtos.h"
+#include "lwip/api.h"
+#include "iotcl.h"
+
+#include "iotc_dns_cache.h"
+
+// Number of host names that can be cached. The SDK itself uses up to four (discovery, identity, MQTT and OTA)
+#ifndef IOTC_DNS_CACHE_SIZE
+#define IOTC_DNS_CACHE_SIZE 6
+#endif
+
+// Maximum host name length (including the terminating null) that will be cached.
+// Longer names are resolved every time.
+#ifndef IOTC_DNS_CACHE_HOST_MAX
+#define IOTC_DNS_CACHE_HOST_MAX 80
+#endif
+
+// lwIP does not pass record TTLs to its callers, so cached entries expire after a fixed time.
+// Keep this at or below the TTL of the records that the device resolves.
+#ifndef IOTC_DNS_CACHE_TTL_MS
+#define IOTC_DNS_CACHE_TTL_MS (5 * 60 * 1000)
+#endif
+
+// How long a failed resolution is remembered. Only long enough to collapse a burst of lookups of the same name,
+// as the HTTP and OTA clients fail without retrying while it is remembered.
+#ifndef IOTC_DNS_CACHE_NEGATIVE_TTL_MS
+#define IOTC_DNS_CACHE_NEGATIVE_TTL_MS 1000
+#endif
+
+typedef struct IotcDnsCacheEntry {
+    char host[IOTC_DNS_CACHE_HOST_MAX];
+    ip_addr_t addr;
+    cy_time_t stored_at;
+    bool is_used;
+    bool is_negative;
+} IotcDnsCacheEntry;
+
+static IotcDnsCacheEntry dns_cache[IOTC_DNS_CACHE_SIZE];
+
+static cy_time_t get_time_ms(void) {
+    cy_time_t now = 0;
+    (void) cy_rtos_get_time(&now);
+    return now;
+}
+
+static bool is_entry_fresh(const IotcDnsCacheEntry *e, cy_time_t now) {
+    cy_time_t ttl = e->is_negative ? IOTC_DNS_CACHE_NEGATIVE_TTL_MS : IOTC_DNS_CACHE_TTL_MS;
+    // unsigned subtraction handles the timer wrap
+    return e->is_used && (cy_time_t) (now - e->stored_at) < ttl;
+}
+
+// must be called within the critical section
+static IotcDnsCacheEntry *find_entry(const char *host) {
+    for (int i = 0; i < IOTC_DNS_CACHE_SIZE; i++) {
+        if (dns_cache[i].is_used && 0 == strcmp(dns_cache[i].host, host)) {
+            return &dns_cache[i];
+        }
+    }
+    return NULL;
+}
+
+IotcDnsCacheResult iotc_dns_cache_lookup(const char *host, ip_addr_t *addr) {
+    IotcDnsCacheResult ret = IOTC_DNS_CACHE_MISS;
+    if (!host) {
+        return IOTC_DNS_CACHE_MISS;
+    }
+    cy_time_t now = get_time_ms();
+
+    taskENTER_CRITICAL();
+    IotcDnsCacheEntry *e = find_entry(host);
+    if (e && is_entry_fresh(e, now)) {
+        if (e->is_negative) {
+            ret = IOTC_DNS_CACHE_NEGATIVE;
+        } else {
+            if (addr) {
+                ip_addr_copy(*addr, e->addr);
+            }
+            ret = IOTC_DNS_CACHE_HIT;
+        }
+    }
+    taskEXIT_CRITICAL();
+    return ret;
+}
+
+void iotc_dns_cache_store(const char *host, const ip_addr_t *addr) {
+    if (!host || strlen(host) >= IOTC_DNS_CACHE_HOST_MAX) {
+        return;
+    }
+    cy_time_t now = get_time_ms();
+
+    taskENTER_CRITICAL();
+    IotcDnsCacheEntry *e = find_entry(host);
+    if (!e) {
+        // take a free slot, or else evict the entry that was stored the longest time ago
+        e = &dns_cache[0];
+        for (int i = 0; i < IOTC_DNS_CACHE_SIZE; i++) {
+            if (!dns_cache[i].is_used) {
+                e = &dns_cache[i];
+                break;
+            }
+            if ((cy_time_t) (now - dns_cache[i].stored_at) > (cy_time_t) (now - e->stored_at)) {
+                e = &dns_cache[i];
+            }
+        }
+        strcpy(e->host, host);
+    }
+    if (addr) {
+        ip_addr_copy(e->addr, *addr);
+        e->is_negative = false;
+    } else {
+        ip_addr_set_zero(&e->addr);
+        e->is_negative = true;
+    }
+    e->stored_at = now;
+    e->is_used = true;
+    taskEXIT_CRITICAL();
+}
+
+void iotc_dns_cache_invalidate(const char *host) {
+    taskENTER_CRITICAL();
+    for (int i = 0; i < IOTC_DNS_CACHE_SIZE; i++) {
+        if (!host || (dns_cache[i].is_used && 0 == strcmp(dns_cache[i].host, host))) {
+            dns_cache[i].is_used = false;
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+
+cy_rslt_t iotc_dns_resolve(const char *host, ip_addr_t *addr) {
+    ip_addr_t resolved;
+
+    if (!host) {
+        return (cy_rslt_t) IOTCL_ERR_BAD_VALUE;
+    }
+
+    switch (iotc_dns_cache_lookup(host, &resolved)) {
+        case IOTC_DNS_CACHE_HIT:
+            if (addr) {
+                ip_addr_copy(*addr, resolved);
+            }
+            return CY_RSLT_SUCCESS;
+        case IOTC_DNS_CACHE_NEGATIVE:
+            printf("DNS: Resolution of %s failed recently. Not retrying yet.\n", host);
+            return (cy_rslt_t) IOTCL_ERR_FAILED;
+        default:
+            break;
+    }
+
+    err_t err = netconn_gethostbyname(host, &resolved);
+    if (ERR_OK != err) {
+        printf("DNS: Failed to resolve %s. Error was %d\n", host, (int) err);
+        iotc_dns_cache_store(host, NULL);
+        return (cy_rslt_t) IOTCL_ERR_FAILED;
+    }
+    iotc_dns_cache_store(host, &resolved);
+    if (addr) {
+        ip_addr_copy(*addr, resolved);
+    }
+    return CY_RSLT_SUCCESS;
+}
+
+cy_rslt_t iotc_dns_resolve_to_string(const char *host, char *ip_str, size_t ip_str_size) {
+    ip_addr_t addr;
+    cy_rslt_t result = iotc_dns_resolve(host, &addr);
+    if (CY_RSLT_SUCCESS != result) {
+        return result; // called function will print the error
+    }
+    if (NULL == ipaddr_ntoa_r(&addr, ip_str, (int) ip_str_size)) {
+        return (cy_rslt_t) IOTCL_ERR_FAILED;
+    }
+    return CY_RSLT_SUCCESS;
+}
+
+cy_rslt_t iotc_dns_preresolve(const char *host) {
+    return iotc_dns_resolve(host, NULL);
+}
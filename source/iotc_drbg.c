@@ -0,0 +1,123 @@
+/* SPDX-License-Identifier: MIT
+ * Copyright (C) 2025 Avnet
+ * Authors: Nikola Markovic <nikola.markovic@avnet.com> et al.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "cyabs_rtos.h"
+
+#include "mbedtls/ctr_drbg.h"
+#include "mbedtls/entropy.h"
+
+#include "iotc_drbg.h"
+
+// Personalization string mixed into the seed
+#ifndef IOTC_DRBG_PERSONALIZATION
+#define IOTC_DRBG_PERSONALIZATION "iotc-drbg"
+#endif
+
+typedef enum {
+    LOCK_NONE,
+    LOCK_CREATING,
+    LOCK_READY
+} LockState;
+
+static LockState lock_state = LOCK_NONE; // guarded by critical sections
+static cy_mutex_t lock;
+static bool is_seeded = false; // guarded by the lock
+static mbedtls_entropy_context entropy;
+static mbedtls_ctr_drbg_context ctr_drbg;
+
+// The mutex can not be created inside a critical section, so the first caller creates it
+// while the others wait for it
+static bool take_lock(void) {
+    while (true) {
+        bool is_creator = false;
+        taskENTER_CRITICAL();
+        LockState state = lock_state;
+        if (LOCK_NONE == state) {
+            lock_state = LOCK_CREATING;
+            is_creator = true;
+        }
+        taskEXIT_CRITICAL();
+
+        if (LOCK_READY == state) {
+            break;
+        }
+        if (is_creator) {
+            cy_rslt_t res = cy_rtos_init_mutex(&lock);
+            taskENTER_CRITICAL();
+            lock_state = (CY_RSLT_SUCCESS == res) ? LOCK_READY : LOCK_NONE;
+            taskEXIT_CRITICAL();
+            if (CY_RSLT_SUCCESS != res) {
+                printf("DRBG: Failed to create the mutex!\n");
+                return false;
+            }
+            break;
+        }
+        (void) cy_rtos_delay_milliseconds(1);
+    }
+    cy_rtos_get_mutex(&lock, CY_RTOS_NEVER_TIMEOUT);
+    return true;
+}
+
+// must be called with the lock taken
+static int seed(void) {
+    if (is_seeded) {
+        return 0;
+    }
+    mbedtls_entropy_init(&entropy);
+    mbedtls_ctr_drbg_init(&ctr_drbg);
+    int ret = mbedtls_ctr_drbg_seed(&ctr_drbg, mbedtls_entropy_func, &entropy,
+            (const unsigned char *) IOTC_DRBG_PERSONALIZATION, sizeof(IOTC_DRBG_PERSONALIZATION) - 1);
+    if (0 != ret) {
+        printf("DRBG: mbedtls_ctr_drbg_seed failed with -0x%04x!\n", (unsigned int) -ret);
+        mbedtls_ctr_drbg_free(&ctr_drbg);
+        mbedtls_entropy_free(&entropy);
+        return ret;
+    }
+    is_seeded = true;
+    return 0;
+}
+
+int iotc_drbg_init(void) {
+    if (!take_lock()) {
+        return MBEDTLS_ERR_CTR_DRBG_ENTROPY_SOURCE_FAILED;
+    }
+    int ret = seed();
+    cy_rtos_set_mutex(&lock);
+    return ret;
+}
+
+int iotc_drbg_random(void *ctx, unsigned char *output, size_t output_len) {
+    (void) ctx;
+    if (!take_lock()) {
+        return MBEDTLS_ERR_CTR_DRBG_ENTROPY_SOURCE_FAILED;
+    }
+    int ret = seed();
+    // mbedtls limits the size of a single request
+    while (0 == ret && output_len > 0) {
+        size_t len = output_len > MBEDTLS_CTR_DRBG_MAX_REQUEST ? MBEDTLS_CTR_DRBG_MAX_REQUEST : output_len;
+        ret = mbedtls_ctr_drbg_random(&ctr_drbg, output, len);
+        output += len;
+        output_len -= len;
+    }
+    cy_rtos_set_mutex(&lock);
+    return ret;
+}
+
+void iotc_drbg_deinit(void) {
+    if (!take_lock()) {
+        return;
+    }
+    if (is_seeded) {
+        mbedtls_ctr_drbg_free(&ctr_drbg);
+        mbedtls_entropy_free(&entropy);
+        is_seeded = false;
+    }
+    cy_rtos_set_mutex(&lock);
+}
@@ -0,0 +1,34 @@
+/* SPDX-License-Identifier: MIT
+ * Copyright (C) 2025 Avnet
+ * Authors: Nikola Markovic <nikola.markovic@avnet.com> et al.
+ */
+
+#ifndef IOTC_DRBG_H
+#define IOTC_DRBG_H
+
+// One CTR-DRBG for the whole SDK, seeded from the mbedtls entropy sources on first use,
+// so that the entropy is gathered only once instead of for each key, signature or connection.
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Seeds the DRBG if it was not seeded yet. Calling this is optional, as iotc_drbg_random() seeds it as well,
+// but seeding at init keeps the entropy gathering out of the first key generation or TLS handshake.
+// Returns 0 or the mbedtls error.
+int iotc_drbg_init(void);
+
+// An mbedtls f_rng function that can be passed to any mbedtls call that takes one, with ctx set to NULL.
+// It can be called from any task. Returns 0 or the mbedtls error.
+int iotc_drbg_random(void *ctx, unsigned char *output, size_t output_len);
+
+// Frees the DRBG. The next iotc_drbg_random() call will seed it again.
+void iotc_drbg_deinit(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IOTC_DRBG_H
@@ -0,0 +1,646 @@
+/* SPDX-License-Identifier: MIT
+ * Copyright (C) 2025 Avnet
+ * Authors: Nikola Markovic <nikola.markovic@avnet.com> et al.
+ */
+
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+#include <limits.h>
+
+#include "iotc_fmt.h"
+
+// The shortest round-trip conversion is the Grisu3 algorithm by Florian Loitsch,
+// "Printing Floating-Point Numbers Quickly and Accurately with Integers", PLDI 2010,
+// on the cached powers of Milo Yip's dtoa benchmark, with the digit generation of double-conversion.
+// It uses only 64-bit integer arithmetic, which is much cheaper on a Cortex-M4
+// than the soft-float loops of printf "%1.15g" followed by the strtod round trip check.
+// For the few values where Grisu3 cannot prove that its digits are the shortest, an exact bignum algorithm is used.
+
+#define DP_SIGNIFICAND_MASK 0x000FFFFFFFFFFFFFULL
+#define DP_EXPONENT_MASK    0x7FF0000000000000ULL
+#define DP_HIDDEN_BIT       0x0010000000000000ULL
+#define DP_SIGNIFICAND_SIZE 52
+#define DP_EXPONENT_BIAS    (0x3FF + DP_SIGNIFICAND_SIZE)
+#define DP_MIN_EXPONENT     (-DP_EXPONENT_BIAS)
+#define DIY_SIGNIFICAND_SIZE 64
+
+// Use the exponent form below 10^-4 and at or above 10^15, like "%1.15g", or 10^17 like "%1.17g"
+#define EXP_FORM_MIN (-4)
+#define EXP_FORM_MAX 15
+#define EXP_FORM_MAX_17 17
+
+typedef struct {
+    uint64_t f;
+    int e;
+} DiyFp;
+
+// Normalized 64-bit approximations of 10^k for k = -348, -340, ..., 340
+static const uint64_t cached_powers_f[] = {
+    0xfa8fd5a0081c0288ULL, 0xbaaee17fa23ebf76ULL, 0x8b16fb203055ac76ULL, 0xcf42894a5dce35eaULL,
+    0x9a6bb0aa55653b2dULL, 0xe61acf033d1a45dfULL, 0xab70fe17c79ac6caULL, 0xff77b1fcbebcdc4fULL,
+    0xbe5691ef416bd60cULL, 0x8dd01fad907ffc3cULL, 0xd3515c2831559a83ULL, 0x9d71ac8fada6c9b5ULL,
+    0xea9c227723ee8bcbULL, 0xaecc49914078536dULL, 0x823c12795db6ce57ULL, 0xc21094364dfb5637ULL,
+    0x9096ea6f3848984fULL, 0xd77485cb25823ac7ULL, 0xa086cfcd97bf97f4ULL, 0xef340a98172aace5ULL,
+    0xb23867fb2a35b28eULL, 0x84c8d4dfd2c63f3bULL, 0xc5dd44271ad3cdbaULL, 0x936b9fcebb25c996ULL,
+    0xdbac6c247d62a584ULL, 0xa3ab66580d5fdaf6ULL, 0xf3e2f893dec3f126ULL, 0xb5b5ada8aaff80b8ULL,
+    0x87625f056c7c4a8bULL, 0xc9bcff6034c13053ULL, 0x964e858c91ba2655ULL, 0xdff9772470297ebdULL,
+    0xa6dfbd9fb8e5b88fULL, 0xf8a95fcf88747d94ULL, 0xb94470938fa89bcfULL, 0x8a08f0f8bf0f156bULL,
+    0xcdb02555653131b6ULL, 0x993fe2c6d07b7facULL, 0xe45c10c42a2b3b06ULL, 0xaa242499697392d3ULL,
+    0xfd87b5f28300ca0eULL, 0xbce5086492111aebULL, 0x8cbccc096f5088ccULL, 0xd1b71758e219652cULL,
+    0x9c40000000000000ULL, 0xe8d4a51000000000ULL, 0xad78ebc5ac620000ULL, 0x813f3978f8940984ULL,
+    0xc097ce7bc90715b3ULL, 0x8f7e32ce7bea5c70ULL, 0xd5d238a4abe98068ULL, 0x9f4f2726179a2245ULL,
+    0xed63a231d4c4fb27ULL, 0xb0de65388cc8ada8ULL, 0x83c7088e1aab65dbULL, 0xc45d1df942711d9aULL,
+    0x924d692ca61be758ULL, 0xda01ee641a708deaULL, 0xa26da3999aef774aULL, 0xf209787bb47d6b85ULL,
+    0xb454e4a179dd1877ULL, 0x865b86925b9bc5c2ULL, 0xc83553c5c8965d3dULL, 0x952ab45cfa97a0b3ULL,
+    0xde469fbd99a05fe3ULL, 0xa59bc234db398c25ULL, 0xf6c69a72a3989f5cULL, 0xb7dcbf5354e9beceULL,
+    0x88fcf317f22241e2ULL, 0xcc20ce9bd35c78a5ULL, 0x98165af37b2153dfULL, 0xe2a0b5dc971f303aULL,
+    0xa8d9d1535ce3b396ULL, 0xfb9b7cd9a4a7443cULL, 0xbb764c4ca7a44410ULL, 0x8bab8eefb6409c1aULL,
+    0xd01fef10a657842cULL, 0x9b10a4e5e9913129ULL, 0xe7109bfba19c0c9dULL, 0xac2820d9623bf429ULL,
+    0x80444b5e7aa7cf85ULL, 0xbf21e44003acdd2dULL, 0x8e679c2f5e44ff8fULL, 0xd433179d9c8cb841ULL,
+    0x9e19db92b4e31ba9ULL, 0xeb96bf6ebadf77d9ULL, 0xaf87023b9bf0ee6bULL,
+};
+
+static const int16_t cached_powers_e[] = {
+    -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980, -954, -927, -901, -874, -847, -821,
+    -794, -768, -741, -715, -688, -661, -635, -608, -582, -555, -529, -502, -475, -449, -422, -396,
+    -369, -343, -316, -289, -263, -236, -210, -183, -157, -130, -103, -77, -50, -24, 3, 30,
+    56, 83, 109, 136, 162, 189, 216, 242, 269, 295, 322, 348, 375, 402, 428, 455,
+    481, 508, 534, 561, 588, 614, 641, 667, 694, 720, 747, 774, 800, 827, 853, 880,
+    907, 933, 960, 986, 1013, 1039, 1066,
+};
+
+static const uint64_t pow10_64[] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL,
+    10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL, 100000000000000ULL,
+    1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL, 1000000000000000000ULL,
+    10000000000000000000ULL
+};
+
+static const char digit_pairs[200] = {
+    '0','0','0','1','0','2','0','3','0','4','0','5','0','6','0','7','0','8','0','9',
+    '1','0','1','1','1','2','1','3','1','4','1','5','1','6','1','7','1','8','1','9',
+    '2','0','2','1','2','2','2','3','2','4','2','5','2','6','2','7','2','8','2','9',
+    '3','0','3','1','3','2','3','3','3','4','3','5','3','6','3','7','3','8','3','9',
+    '4','0','4','1','4','2','4','3','4','4','4','5','4','6','4','7','4','8','4','9',
+    '5','0','5','1','5','2','5','3','5','4','5','5','5','6','5','7','5','8','5','9',
+    '6','0','6','1','6','2','6','3','6','4','6','5','6','6','6','7','6','8','6','9',
+    '7','0','7','1','7','2','7','3','7','4','7','5','7','6','7','7','7','8','7','9',
+    '8','0','8','1','8','2','8','3','8','4','8','5','8','6','8','7','8','8','8','9',
+    '9','0','9','1','9','2','9','3','9','4','9','5','9','6','9','7','9','8','9','9'
+};
+
+static DiyFp diy_from_double(double d) {
+    DiyFp r;
+    uint64_t u;
+    memcpy(&u, &d, sizeof(u));
+    int biased_e = (int) ((u & DP_EXPONENT_MASK) >> DP_SIGNIFICAND_SIZE);
+    uint64_t significand = u & DP_SIGNIFICAND_MASK;
+    if (biased_e != 0) {
+        r.f = significand + DP_HIDDEN_BIT;
+        r.e = biased_e - DP_EXPONENT_BIAS;
+    } else {
+        r.f = significand;
+        r.e = DP_MIN_EXPONENT + 1;
+    }
+    return r;
+}
+
+static DiyFp diy_mul(DiyFp x, DiyFp y) {
+    const uint64_t m32 = 0xFFFFFFFFULL;
+    uint64_t a = x.f >> 32;
+    uint64_t b = x.f & m32;
+    uint64_t c = y.f >> 32;
+    uint64_t d = y.f & m32;
+    uint64_t ac = a * c;
+    uint64_t bc = b * c;
+    uint64_t ad = a * d;
+    uint64_t bd = b * d;
+    uint64_t tmp = (bd >> 32) + (ad & m32) + (bc & m32);
+    tmp += 1ULL << 31; // round
+    DiyFp r = { ac + (ad >> 32) + (bc >> 32) + (tmp >> 32), x.e + y.e + 64 };
+    return r;
+}
+
+static DiyFp diy_normalize(DiyFp x) {
+    while (!(x.f & DP_HIDDEN_BIT)) {
+        x.f <<= 1;
+        x.e--;
+    }
+    x.f <<= (DIY_SIGNIFICAND_SIZE - DP_SIGNIFICAND_SIZE - 1);
+    x.e -= (DIY_SIGNIFICAND_SIZE - DP_SIGNIFICAND_SIZE - 1);
+    return x;
+}
+
+static DiyFp diy_normalize_boundary(DiyFp x) {
+    while (!(x.f & (DP_HIDDEN_BIT << 1))) {
+        x.f <<= 1;
+        x.e--;
+    }
+    x.f <<= (DIY_SIGNIFICAND_SIZE - DP_SIGNIFICAND_SIZE - 2);
+    x.e -= (DIY_SIGNIFICAND_SIZE - DP_SIGNIFICAND_SIZE - 2);
+    return x;
+}
+
+static void diy_normalized_boundaries(DiyFp v, DiyFp *minus, DiyFp *plus) {
+    DiyFp pl = { (v.f << 1) + 1, v.e - 1 };
+    pl = diy_normalize_boundary(pl);
+    DiyFp mi;
+    // the smallest normal value has the same spacing below it as the subnormals
+    if (v.f == DP_HIDDEN_BIT && v.e != DP_MIN_EXPONENT + 1) {
+        mi.f = (v.f << 2) - 1;
+        mi.e = v.e - 2;
+    } else {
+        mi.f = (v.f << 1) - 1;
+        mi.e = v.e - 1;
+    }
+    mi.f <<= mi.e - pl.e;
+    mi.e = pl.e;
+    *plus = pl;
+    *minus = mi;
+}
+
+static DiyFp get_cached_power(int e, int *k) {
+    // dk must be positive, so it can be ceiled with a cast
+    double dk = (-61 - e) * 0.30102999566398114 + 347;
+    int ik = (int) dk;
+    if (dk - ik > 0.0) {
+        ik++;
+    }
+    unsigned int index = (unsigned int) ((ik >> 3) + 1);
+    *k = -(-348 + (int) (index << 3)); // decimal exponent doesn't need lookup
+    DiyFp r = { cached_powers_f[index], cached_powers_e[index] };
+    return r;
+}
+
+static int count_decimal_digits_32(uint32_t n) {
+    int count = 1;
+    while (count < 10 && n >= pow10_64[count]) {
+        count++;
+    }
+    return count;
+}
+
+// Grisu3 rounding of the last digit towards w. Returns false if the digits cannot be proven
+// to be the shortest and closest ones, because of the imprecision of the cached power of ten.
+static bool round_weed(char *buffer, int len, uint64_t distance_too_high_w, uint64_t unsafe_interval,
+        uint64_t rest, uint64_t ten_kappa, uint64_t unit) {
+    const uint64_t small_distance = distance_too_high_w - unit;
+    const uint64_t big_distance = distance_too_high_w + unit;
+    while (rest < small_distance && unsafe_interval - rest >= ten_kappa
+            && (rest + ten_kappa < small_distance || small_distance - rest >= rest + ten_kappa - small_distance)) {
+        buffer[len - 1]--;
+        rest += ten_kappa;
+    }
+    if (rest < big_distance && unsafe_interval - rest >= ten_kappa
+            && (rest + ten_kappa < big_distance || big_distance - rest > rest + ten_kappa - big_distance)) {
+        return false;
+    }
+    return 2 * unit <= rest && rest <= unsafe_interval - 4 * unit;
+}
+
+static bool digit_gen(DiyFp low, DiyFp w, DiyFp high, char *buffer, int *len, int *kappa) {
+    uint64_t unit = 1;
+    const uint64_t too_low = low.f - unit;
+    const uint64_t too_high = high.f + unit;
+    uint64_t unsafe_interval = too_high - too_low;
+    const DiyFp one = { 1ULL << -w.e, w.e };
+    uint32_t integrals = (uint32_t) (too_high >> -one.e);
+    uint64_t fractionals = too_high & (one.f - 1);
+    *kappa = count_decimal_digits_32(integrals);
+    uint32_t divisor = (uint32_t) pow10_64[*kappa - 1];
+    *len = 0;
+
+    while (*kappa > 0) {
+        buffer[(*len)++] = (char) ('0' + integrals / divisor);
+        integrals %= divisor;
+        (*kappa)--;
+        uint64_t rest = ((uint64_t) integrals << -one.e) + fractionals;
+        if (rest < unsafe_interval) {
+            return round_weed(buffer, *len, too_high - w.f, unsafe_interval, rest, (uint64_t) divisor << -one.e, unit);
+        }
+        divisor /= 10;
+    }
+
+    for (;;) {
+        fractionals *= 10;
+        unit *= 10;
+        unsafe_interval *= 10;
+        buffer[(*len)++] = (char) ('0' + (fractionals >> -one.e));
+        fractionals &= one.f - 1;
+        (*kappa)--;
+        if (fractionals < unsafe_interval) {
+            return round_weed(buffer, *len, (too_high - w.f) * unit, unsafe_interval, fractionals, one.f, unit);
+        }
+    }
+}
+
+// Produces the digits of a positive finite value such that value = digits * 10^k.
+// Fails for about 0.5% of the values, which then need bignum_shortest().
+static bool grisu3(double value, char *digits, int *len, int *k) {
+    DiyFp v = diy_from_double(value);
+    DiyFp w_m, w_p;
+    diy_normalized_boundaries(v, &w_m, &w_p);
+
+    const DiyFp c_mk = get_cached_power(w_p.e, k);
+    const DiyFp w = diy_mul(diy_normalize(v), c_mk);
+    const DiyFp wp = diy_mul(w_p, c_mk);
+    const DiyFp wm = diy_mul(w_m, c_mk);
+    int kappa;
+    bool is_shortest = digit_gen(wm, w, wp, digits, len, &kappa);
+    *k += kappa;
+    return is_shortest;
+}
+
+// Exact fallback: the free-format algorithm of Steele & White and Burger & Dybvig on big integers.
+// The scaled values of doubles need up to about 1090 bits. The numbers live on the stack,
+// which is about 750 bytes, but this is only used for the values where Grisu3 fails.
+#define BIG_WORDS 36
+
+typedef struct {
+    int n; // number of used words
+    uint32_t w[BIG_WORDS]; // least significant word first
+} BigInt;
+
+static void big_set(BigInt *a, uint64_t value) {
+    a->n = 0;
+    while (value) {
+        a->w[a->n++] = (uint32_t) value;
+        value >>= 32;
+    }
+}
+
+static void big_shift_left(BigInt *a, int bits) {
+    const int words = bits / 32;
+    bits %= 32;
+    if (!a->n) {
+        return;
+    }
+    if (bits) {
+        uint32_t carry = 0;
+        for (int i = 0; i < a->n; i++) {
+            uint32_t word = a->w[i];
+            a->w[i] = (word << bits) | carry;
+            carry = word >> (32 - bits);
+        }
+        if (carry) {
+            a->w[a->n++] = carry;
+        }
+    }
+    if (words) {
+        memmove(&a->w[words], a->w, (size_t) a->n * sizeof(a->w[0]));
+        memset(a->w, 0, (size_t) words * sizeof(a->w[0]));
+        a->n += words;
+    }
+}
+
+static void big_mul(BigInt *a, uint32_t factor) {
+    uint64_t carry = 0;
+    for (int i = 0; i < a->n; i++) {
+        uint64_t product = (uint64_t) a->w[i] * factor + carry;
+        a->w[i] = (uint32_t) product;
+        carry = product >> 32;
+    }
+    if (carry) {
+        a->w[a->n++] = (uint32_t) carry;
+    }
+}
+
+static void big_mul_pow10(BigInt *a, int exponent) {
+    for (; exponent >= 9; exponent -= 9) {
+        big_mul(a, 1000000000U);
+    }
+    if (exponent) {
+        big_mul(a, (uint32_t) pow10_64[exponent]);
+    }
+}
+
+static int big_compare(const BigInt *a, const BigInt *b) {
+    if (a->n != b->n) {
+        return a->n < b->n ? -1 : 1;
+    }
+    for (int i = a->n - 1; i >= 0; i--) {
+        if (a->w[i] != b->w[i]) {
+            return a->w[i] < b->w[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+// Compares a + b with c
+static int big_plus_compare(const BigInt *a, const BigInt *b, const BigInt *c) {
+    BigInt sum;
+    uint64_t carry = 0;
+    sum.n = a->n > b->n ? a->n : b->n;
+    for (int i = 0; i < sum.n; i++) {
+        carry += (i < a->n ? a->w[i] : 0);
+        carry += (i < b->n ? b->w[i] : 0);
+        sum.w[i] = (uint32_t) carry;
+        carry >>= 32;
+    }
+    if (carry) {
+        sum.w[sum.n++] = (uint32_t) carry;
+    }
+    return big_compare(&sum, c);
+}
+
+// a -= b, where a >= b
+static void big_sub(BigInt *a, const BigInt *b) {
+    uint32_t borrow = 0;
+    for (int i = 0; i < a->n; i++) {
+        uint64_t subtrahend = (uint64_t) (i < b->n ? b->w[i] : 0) + borrow;
+        borrow = a->w[i] < subtrahend;
+        a->w[i] = (uint32_t) ((uint64_t) a->w[i] - subtrahend);
+    }
+    while (a->n && !a->w[a->n - 1]) {
+        a->n--;
+    }
+}
+
+// Always produces the shortest digits of a positive finite value such that value = digits * 10^k
+static void bignum_shortest(double value, char *digits, int *len, int *k) {
+    const DiyFp v = diy_from_double(value);
+    // round-to-even parsing accepts the boundaries if the significand is even
+    const bool is_even = !(v.f & 1);
+    const bool is_lower_closer = v.f == DP_HIDDEN_BIT && v.e != DP_MIN_EXPONENT + 1;
+    const int shift = is_lower_closer ? 2 : 1;
+    // value = r / s, and the boundaries are value - m_minus / s and value + m_plus / s
+    BigInt r, s, m_minus, m_plus;
+
+    big_set(&r, v.f);
+    big_set(&m_minus, 1);
+    if (v.e >= 0) {
+        big_shift_left(&r, v.e + shift);
+        big_set(&s, 1ULL << shift);
+        big_shift_left(&m_minus, v.e);
+    } else {
+        big_shift_left(&r, shift);
+        big_set(&s, 1);
+        big_shift_left(&s, shift - v.e);
+    }
+    m_plus = m_minus;
+    if (is_lower_closer) {
+        big_shift_left(&m_plus, 1);
+    }
+
+    // 10^estimate is at most one power of ten too low
+    int bits = 0;
+    while (bits < 64 && (v.f >> bits)) {
+        bits++;
+    }
+    int estimate = (int) ceil((v.e + bits - 1) * 0.30102999566398114 - 1e-10);
+    if (estimate >= 0) {
+        big_mul_pow10(&s, estimate);
+    } else {
+        big_mul_pow10(&r, -estimate);
+        big_mul_pow10(&m_minus, -estimate);
+        big_mul_pow10(&m_plus, -estimate);
+    }
+    int cmp = big_plus_compare(&r, &m_plus, &s);
+    int decimal_point = estimate;
+    if (is_even ? cmp >= 0 : cmp > 0) {
+        decimal_point++;
+    } else {
+        big_mul(&r, 10);
+        big_mul(&m_minus, 10);
+        big_mul(&m_plus, 10);
+    }
+
+    *len = 0;
+    for (;;) {
+        int d = 0;
+        while (big_compare(&r, &s) >= 0) {
+            big_sub(&r, &s);
+            d++;
+        }
+        digits[(*len)++] = (char) ('0' + d);
+        cmp = big_compare(&r, &m_minus);
+        const bool is_low = is_even ? cmp <= 0 : cmp < 0;
+        cmp = big_plus_compare(&r, &m_plus, &s);
+        const bool is_high = is_even ? cmp >= 0 : cmp > 0;
+        if (is_low && is_high) {
+            // both the digit and the next one are within the boundaries: take the closer one
+            cmp = big_plus_compare(&r, &r, &s);
+            if (cmp > 0 || (cmp == 0 && (d & 1))) {
+                digits[*len - 1]++;
+            }
+            break;
+        } else if (is_low) {
+            break;
+        } else if (is_high) {
+            digits[*len - 1]++;
+            break;
+        }
+        big_mul(&r, 10);
+        big_mul(&m_minus, 10);
+        big_mul(&m_plus, 10);
+    }
+    *k = decimal_point - *len;
+}
+
+// Writes the unsigned value right-aligned ending at end and returns the pointer to the first digit
+static char *write_u64_backwards(char *end, uint64_t value) {
+    char *p = end;
+    while (value >= 100) {
+        unsigned int pair = (unsigned int) (value % 100) * 2;
+        value /= 100;
+        *--p = digit_pairs[pair + 1];
+        *--p = digit_pairs[pair];
+    }
+    if (value >= 10) {
+        unsigned int pair = (unsigned int) value * 2;
+        *--p = digit_pairs[pair + 1];
+        *--p = digit_pairs[pair];
+    } else {
+        *--p = (char) ('0' + value);
+    }
+    return p;
+}
+
+static size_t write_u64(char *buf, uint64_t value) {
+    char tmp[20];
+    char *end = tmp + sizeof(tmp);
+    char *start = write_u64_backwards(end, value);
+    size_t len = (size_t) (end - start);
+    memcpy(buf, start, len);
+    return len;
+}
+
+size_t iotc_fmt_int(char *buf, int64_t value) {
+    size_t len = 0;
+    uint64_t u = (uint64_t) value;
+    if (value < 0) {
+        buf[len++] = '-';
+        u = 0 - u; // well defined for INT64_MIN as well
+    }
+    len += write_u64(&buf[len], u);
+    buf[len] = 0;
+    return len;
+}
+
+size_t iotc_fmt_double(char *buf, double value) {
+    char digits[18];
+    int n;
+    int k;
+    size_t len = 0;
+
+    if (isnan(value) || isinf(value)) {
+        memcpy(buf, "null", 5);
+        return 4;
+    }
+    // integers in int range are printed with "%d" by cJSON, so -0.0 is 0 as well
+    if (value >= INT_MIN && value <= INT_MAX && value == (double) (int) value) {
+        return iotc_fmt_int(buf, (int) value);
+    }
+
+    if (value < 0) {
+        buf[len++] = '-';
+        value = -value;
+    }
+    if (!grisu3(value, digits, &n, &k)) {
+        bignum_shortest(value, digits, &n, &k);
+    }
+
+    int exp10 = n + k - 1; // value is in [10^exp10, 10^(exp10+1))
+    // cJSON prints the values that need more than 15 digits with "%1.17g"
+    if (exp10 < EXP_FORM_MIN || exp10 >= (n > 15 ? EXP_FORM_MAX_17 : EXP_FORM_MAX)) {
+        buf[len++] = digits[0];
+        if (n > 1) {
+            buf[len++] = '.';
+            memcpy(&buf[len], &digits[1], (size_t) (n - 1));
+            len += (size_t) (n - 1);
+        }
+        buf[len++] = 'e';
+        if (exp10 < 0) {
+            buf[len++] = '-';
+            exp10 = -exp10;
+        } else {
+            buf[len++] = '+';
+        }
+        if (exp10 < 10) {
+            buf[len++] = '0'; // printf uses at least two exponent digits
+        }
+        len += write_u64(&buf[len], (uint64_t) exp10);
+    } else if (k >= 0) {
+        // integer beyond int range: digits followed by zeros
+        memcpy(&buf[len], digits, (size_t) n);
+        len += (size_t) n;
+        memset(&buf[len], '0', (size_t) k);
+        len += (size_t) k;
+    } else if (n + k > 0) {
+        // decimal point inside of the digits
+        memcpy(&buf[len], digits, (size_t) (n + k));
+        len += (size_t) (n + k);
+        buf[len++] = '.';
+        memcpy(&buf[len], &digits[n + k], (size_t) -k);
+        len += (size_t) -k;
+    } else {
+        // 0.000ddd
+        buf[len++] = '0';
+        buf[len++] = '.';
+        memset(&buf[len], '0', (size_t) -(n + k));
+        len += (size_t) -(n + k);
+        memcpy(&buf[len], digits, (size_t) n);
+        len += (size_t) n;
+    }
+    buf[len] = 0;
+    return len;
+}
+
+size_t iotc_fmt_fixed(char *buf, double value, int decimals) {
+    static const double scale[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9 };
+    size_t len = 0;
+
+    if (decimals < 0) {
+        decimals = 0;
+    } else if (decimals > 9) {
+        decimals = 9;
+    }
+    double scaled = value * scale[decimals];
+    // beyond 2^53, the scaled value can no longer be rounded precisely
+    if (isnan(scaled) || fabs(scaled) >= 9007199254740992.0) {
+        return iotc_fmt_double(buf, value);
+    }
+    int64_t rounded = llround(scaled);
+    if (rounded < 0) {
+        buf[len++] = '-';
+        rounded = -rounded;
+    }
+    uint64_t int_part = (uint64_t) rounded / pow10_64[decimals];
+    uint32_t frac_part = (uint32_t) ((uint64_t) rounded % pow10_64[decimals]);
+    len += write_u64(&buf[len], int_part);
+    if (frac_part) {
+        // strip the trailing zeros
+        int frac_digits = decimals;
+        while (frac_part % 10 == 0) {
+            frac_part /= 10;
+            frac_digits--;
+        }
+        buf[len++] = '.';
+        char *end = &buf[len + (size_t) frac_digits];
+        char *start = write_u64_backwards(end, frac_part);
+        memset(&buf[len], '0', (size_t) (start - &buf[len])); // leading zeros of the fraction
+        len += (size_t) frac_digits;
+    }
+    buf[len] = 0;
+    return len;
+}
+
+// Escapes the same characters as cJSON's print_string_ptr()
+size_t iotc_fmt_json_string(char *buf, size_t buf_size, const char *str) {
+    static const char hex_digits[] = "0123456789abcdef";
+    size_t len = 0;
+
+    // the opening quote, closing quote and the null terminator
+    if (buf_size < 3) {
+        return 0;
+    }
+    buf[len++] = '"';
+    for (const char *p = str; *p; p++) {
+        unsigned char c = (unsigned char) *p;
+        char escape = 0;
+        switch (c) {
+            case '"': escape = '"'; break;
+            case '\\': escape = '\\'; break;
+            case '\b': escape = 'b'; break;
+            case '\f': escape = 'f'; break;
+            case '\n': escape = 'n'; break;
+            case '\r': escape = 'r'; break;
+            case '\t': escape = 't'; break;
+            default: break;
+        }
+        // leave room for the closing quote and the null terminator
+        if (escape) {
+            if (len + 2 + 2 > buf_size) {
+                return 0;
+            }
+            buf[len++] = '\\';
+            buf[len++] = escape;
+        } else if (c < 32) {
+            if (len + 6 + 2 > buf_size) {
+                return 0;
+            }
+            memcpy(&buf[len], "\\u00", 4);
+            buf[len + 4] = hex_digits[c >> 4];
+            buf[len + 5] = hex_digits[c & 0xF];
+            len += 6;
+        } else {
+            if (len + 1 + 2 > buf_size) {
+                return 0;
+            }
+            buf[len++] = (char) c;
+        }
+    }
+    buf[len++] = '"';
+    buf[len] = 0;
+    return len;
+}
+
+size_t iotc_fmt_iso_time(char *buf, time_t t) {
+    struct tm tm_time;
+    if (!gmtime_r(&t, &tm_time)) {
+        buf[0] = 0;
+        return 0;
+    }
+    return strftime(buf, IOTC_FMT_ISO_TIME_SIZE, "%Y-%m-%dT%H:%M:%S.000Z", &tm_time);
+}
@@ -4,18 +4,22 @@
  */
 
 #include <stdio.h>
+#include <string.h>
 #include "cy_syslib.h"
 #include "x509_crt.h"
 
 /* mbedTLS includes. */
 #include "mbedtls/pk.h"
 #include "mbedtls/x509_crt.h"
-#include "mbedtls/ctr_drbg.h"
-#include "mbedtls/entropy.h"
+#include "mbedtls/x509_csr.h"
 #include "mbedtls/sha256.h"
 #include "mbedtls/platform.h"
 #include "mbedtls/threading.h"
 
+#include "iotc_drbg.h"
+#include "iotc_kvstore.h"
+#include "iotc_gencert.h"
+
 #ifndef IOTC_GENCRT_KEY_CURVE
 #define IOTC_GENCRT_KEY_CURVE 			MBEDTLS_ECP_DP_SECP256R1
 #endif
@@ -40,15 +44,39 @@
 #define IOTC_GENCRT_SUBJECT_NAME 		"CN=IoTConnectDevCert,O=Avnet,C=US"
 #endif
 
+// Prefixes of the key-value store keys of the stored certificate and key. The unique ID is appended in hex.
+#ifndef IOTC_GENCRT_KV_CERT_PREFIX
+#define IOTC_GENCRT_KV_CERT_PREFIX		"iotc_crt_"
+#endif
+
+#ifndef IOTC_GENCRT_KV_KEY_PREFIX
+#define IOTC_GENCRT_KV_KEY_PREFIX		"iotc_key_"
+#endif
+
+#define KV_NAME_SIZE 32
+
+// mbedtls writes DER to the end of the buffer and returns its length. Moves it to the start of the buffer.
+// For PEM, ret is 0 on success and the length includes the null terminator, as the TLS layer expects.
+static int finish_output(int ret, IotcX509Format format, unsigned char* buffer, size_t buffer_size, size_t* len) {
+	if (ret < 0) {
+		return ret;
+	}
+	if (IOTC_X509_FORMAT_DER == format) {
+		memmove(buffer, &buffer[buffer_size - ret], ret);
+		*len = (size_t) ret;
+	} else {
+		*len = strlen((char *) buffer) + 1;
+	}
+	return 0;
+}
+
 // reference code from https://github.com/Mbed-TLS/mbedtls/issues/7050 and mbedtls examples
-static int generate_selfsigned_cert(mbedtls_pk_context *key, unsigned char* pem_buffer, size_t buf_len) {
+static int generate_selfsigned_cert(mbedtls_pk_context *key, IotcX509Format format, unsigned char* buffer, size_t buf_len, size_t* len) {
 	int ret = 1;
 	mbedtls_mpi serial;
 	mbedtls_x509write_cert crt;
-	mbedtls_ctr_drbg_context ctr_drbg;
 
 	mbedtls_mpi_init(&serial);
-	mbedtls_ctr_drbg_init(&ctr_drbg);
 	mbedtls_x509write_crt_init(&crt);
 
 	// use the unique ID of chip as certificate serial number
@@ -87,67 +115,105 @@ static int generate_selfsigned_cert(mbedtls_pk_context *key, unsigned char* pem_
 		goto exit;
 	}
 
-	ret = mbedtls_x509write_crt_pem(&crt, pem_buffer, buf_len, mbedtls_ctr_drbg_random, &ctr_drbg);
+	if (IOTC_X509_FORMAT_DER == format) {
+		ret = mbedtls_x509write_crt_der(&crt, buffer, buf_len, iotc_drbg_random, NULL);
+	} else {
+		ret = mbedtls_x509write_crt_pem(&crt, buffer, buf_len, iotc_drbg_random, NULL);
+	}
+	ret = finish_output(ret, format, buffer, buf_len, len);
 	if (ret != 0) {
-		printf("GENCERT: Failed to convert cert to pem!\n");
+		printf("GENCERT: Failed to write the cert!\n");
 		goto exit;
 	}
 
 exit:
 	mbedtls_mpi_free(&serial);
-	mbedtls_ctr_drbg_free(&ctr_drbg);
 	mbedtls_x509write_crt_free(&crt);
 	return ret;
 }
 
-static int make_key(mbedtls_pk_context* key, unsigned char* key_buffer, size_t buf_len) {
+static int generate_csr(mbedtls_pk_context *key, IotcX509Format format, unsigned char* buffer, size_t buf_len, size_t* len) {
 	int ret;
-	mbedtls_entropy_context entropy;
-	mbedtls_ctr_drbg_context ctr_drbg;
+	mbedtls_x509write_csr csr;
 
-	mbedtls_entropy_init(&entropy);
-	mbedtls_ctr_drbg_init(&ctr_drbg);
+	mbedtls_x509write_csr_init(&csr);
+	mbedtls_x509write_csr_set_key(&csr, key);
+	mbedtls_x509write_csr_set_md_alg(&csr, IOTC_GENCRT_SIGN_ALG);
 
-	ret = mbedtls_pk_setup(key, mbedtls_pk_info_from_type(MBEDTLS_PK_ECKEY));
+	ret = mbedtls_x509write_csr_set_subject_name(&csr, IOTC_GENCRT_SUBJECT_NAME);
 	if (ret != 0) {
-		printf("GENCERT: mbedtls_pk_setup failed!\n");
+		printf("GENCERT: Failed to set CSR subject name!\n");
+		goto exit;
+	}
+
+	if (IOTC_X509_FORMAT_DER == format) {
+		ret = mbedtls_x509write_csr_der(&csr, buffer, buf_len, iotc_drbg_random, NULL);
+	} else {
+		ret = mbedtls_x509write_csr_pem(&csr, buffer, buf_len, iotc_drbg_random, NULL);
+	}
+	ret = finish_output(ret, format, buffer, buf_len, len);
+	if (ret != 0) {
+		printf("GENCERT: Failed to write the CSR!\n");
 		goto exit;
 	}
 
-	ret = mbedtls_ctr_drbg_seed(&ctr_drbg, mbedtls_entropy_func, &entropy, NULL, 0);
+exit:
+	mbedtls_x509write_csr_free(&csr);
+	return ret;
+}
+
+static int make_key(mbedtls_pk_context* key, IotcX509Format format, unsigned char* key_buffer, size_t buf_len, size_t* len) {
+	int ret;
+
+	ret = mbedtls_pk_setup(key, mbedtls_pk_info_from_type(MBEDTLS_PK_ECKEY));
 	if (ret != 0) {
-		printf("GENCERT: mbedtls_ctr_drbg_seed failed!\n");
+		printf("GENCERT: mbedtls_pk_setup failed!\n");
 		goto exit;
 	}
 
-	ret = mbedtls_ecp_gen_key(IOTC_GENCRT_KEY_CURVE, mbedtls_pk_ec(*key), mbedtls_ctr_drbg_random, &ctr_drbg);
+	ret = mbedtls_ecp_gen_key(IOTC_GENCRT_KEY_CURVE, mbedtls_pk_ec(*key), iotc_drbg_random, NULL);
 	if (ret != 0) {
 		printf("GENCERT: mbedtls_ecp_gen_key failed!\n");
 		goto exit;
 	}
-	ret = mbedtls_pk_write_key_pem(key, key_buffer, buf_len);
+	if (IOTC_X509_FORMAT_DER == format) {
+		ret = mbedtls_pk_write_key_der(key, key_buffer, buf_len);
+	} else {
+		ret = mbedtls_pk_write_key_pem(key, key_buffer, buf_len);
+	}
+	ret = finish_output(ret, format, key_buffer, buf_len, len);
 	if (ret != 0) {
-		printf("GENCERT: Failed write key to pem!\n");
+		printf("GENCERT: Failed to write the key!\n");
 		goto exit;
 	}
 
 exit:
-	mbedtls_entropy_free(&entropy);
-	mbedtls_ctr_drbg_free(&ctr_drbg);
-
 	return ret;
 }
 
-int iotc_x509_generate_credentials(char* cert_buffer, size_t cert_buffer_size, char* key_buffer, size_t key_buffer_size) {
+int iotc_x509_generate_credentials_ex(
+		IotcX509Format format,
+		unsigned char* cert_buffer, size_t cert_buffer_size, size_t* cert_len,
+		unsigned char* key_buffer, size_t key_buffer_size, size_t* key_len
+) {
 	int ret;
 	mbedtls_pk_context key;
 	mbedtls_pk_init(&key);
 
-	ret = make_key(&key, (unsigned char *) key_buffer, key_buffer_size);
-	if (0 != ret) {
-		return ret; // called function will print the error
-	}
-	ret = generate_selfsigned_cert(&key, (unsigned char *) cert_buffer, cert_buffer_size);
+	ret = make_key(&key, format, key_buffer, key_buffer_size, key_len);
+	if (0 == ret) {
+		ret = generate_selfsigned_cert(&key, format, cert_buffer, cert_buffer_size, cert_len);
+	} // else called function will print the error
+	mbedtls_pk_free(&key);
+	return ret;
+}
+
+int iotc_x509_generate_credentials(char* cert_buffer, size_t cert_buffer_size, char* key_buffer, size_t key_buffer_size) {
+	size_t cert_len;
+	size_t key_len;
+	int ret = iotc_x509_generate_credentials_ex(IOTC_X509_FORMAT_PEM,
+			(unsigned char *) cert_buffer, cert_buffer_size, &cert_len,
+			(unsigned char *) key_buffer, key_buffer_size, &key_len);
 	if (0 != ret) {
 		return ret; // called function will print the error
 	}
@@ -157,3 +223,105 @@ int iotc_x509_generate_credentials(char* cert_buffer, size_t cert_buffer_size, c
 	return 0;
 }
 
+int iotc_x509_generate_csr(
+		IotcX509Format format,
+		unsigned char* csr_buffer, size_t csr_buffer_size, size_t* csr_len,
+		unsigned char* key_buffer, size_t key_buffer_size, size_t* key_len
+) {
+	int ret;
+	mbedtls_pk_context key;
+	mbedtls_pk_init(&key);
+
+	ret = make_key(&key, format, key_buffer, key_buffer_size, key_len);
+	if (0 == ret) {
+		ret = generate_csr(&key, format, csr_buffer, csr_buffer_size, csr_len);
+	} // else called function will print the error
+	mbedtls_pk_free(&key);
+	return ret;
+}
+
+// Builds the store key for the given prefix and the unique ID of this chip,
+// so that a store that was copied from another device is not used
+static void make_kv_name(char *name, const char *prefix) {
+	uint64_t hwuid = IOTC_GENCRT_SERIAL_FUNC();
+	snprintf(name, KV_NAME_SIZE, "%s%08lx%08lx", prefix, (unsigned long) (hwuid >> 32), (unsigned long) (hwuid & 0xffffffffu));
+}
+
+// Returned by read_pem() if the value is not stored
+#define PEM_MISSING 1
+
+// Reads a stored PEM value. Returns 0, PEM_MISSING, or an IOTC_GENCRT_ERR_* error.
+static int read_pem(const char *name, char *buffer, size_t buffer_size) {
+	int len = iotc_kvstore_read(name, buffer, buffer_size);
+	if (-1 == len) {
+		return PEM_MISSING;
+	}
+	if (len <= 0) {
+		printf("GENCERT: Failed to read %s from the store. Error was %d\n", name, len);
+		return IOTC_GENCRT_ERR_STORED;
+	}
+	if ((size_t) len >= buffer_size) {
+		// it may have been truncated, and there is no room for the null terminator either way
+		printf("GENCERT: The stored %s does not fit into a buffer of %lu bytes!\n", name, (unsigned long) buffer_size);
+		return IOTC_GENCRT_ERR_BUFFER_TOO_SMALL;
+	}
+	buffer[len] = 0;
+	if (0 != strncmp(buffer, "-----BEGIN", strlen("-----BEGIN"))) {
+		printf("GENCERT: The stored %s is not PEM!\n", name);
+		return IOTC_GENCRT_ERR_STORED;
+	}
+	return 0;
+}
+
+int iotc_x509_get_credentials(char* cert_buffer, size_t cert_buffer_size, char* key_buffer, size_t key_buffer_size) {
+	char cert_name[KV_NAME_SIZE];
+	char key_name[KV_NAME_SIZE];
+	make_kv_name(cert_name, IOTC_GENCRT_KV_CERT_PREFIX);
+	make_kv_name(key_name, IOTC_GENCRT_KV_KEY_PREFIX);
+
+	if (!iotc_kvstore_is_available()) {
+		return iotc_x509_generate_credentials(cert_buffer, cert_buffer_size, key_buffer, key_buffer_size);
+	}
+
+	int cert_status = read_pem(cert_name, cert_buffer, cert_buffer_size);
+	int key_status = read_pem(key_name, key_buffer, key_buffer_size);
+	if (0 == cert_status && 0 == key_status) {
+		return 0;
+	}
+	if (PEM_MISSING != cert_status) {
+		// A certificate is stored, and it may be registered in the cloud, so never replace it
+		if (cert_status < 0) {
+			return cert_status;
+		}
+		if (PEM_MISSING == key_status) {
+			printf("GENCERT: The certificate is stored without its private key!\n");
+			return IOTC_GENCRT_ERR_STORED;
+		}
+		return key_status;
+	}
+	if (key_status < 0) {
+		return key_status;
+	}
+	// There is no certificate. As the certificate is written last, a stored key without one is left over
+	// from a save that was interrupted, and was never used, so it is replaced along with the certificate.
+
+	int ret = iotc_x509_generate_credentials(cert_buffer, cert_buffer_size, key_buffer, key_buffer_size);
+	if (0 != ret) {
+		return ret;
+	}
+	// The certificate is written last, so a stored certificate always has its key stored with it,
+	// even if the device resets in the middle of this
+	if (0 != iotc_kvstore_write(key_name, key_buffer, strlen(key_buffer))
+			|| 0 != iotc_kvstore_write(cert_name, cert_buffer, strlen(cert_buffer))) {
+		printf("GENCERT: Failed to store the generated credentials. They will be generated again on the next boot.\n");
+	}
+	return 0;
+}
+
+void iotc_x509_clear_credentials(void) {
+	char name[KV_NAME_SIZE];
+	make_kv_name(name, IOTC_GENCRT_KV_CERT_PREFIX);
+	(void) iotc_kvstore_remove(name);
+	make_kv_name(name, IOTC_GENCRT_KV_KEY_PREFIX);
+	(void) iotc_kvstore_remove(name);
+}
@@ -7,9 +7,56 @@
 
 #include <stdlib.h>
 
+typedef enum {
+	IOTC_X509_FORMAT_PEM = 0,
+	IOTC_X509_FORMAT_DER
+} IotcX509Format;
+
+// Generates a new private key and a self-signed certificate for it into the buffers as PEM.
+// This takes seconds, so most applications should use iotc_x509_get_credentials() instead.
 int iotc_x509_generate_credentials(
 		char* pem_certificate_buffer,
 		size_t pem_certificate_buffer_size,
 		char* pem_private_key_buffer,
 		size_t pem_private_key_buffer_size
 );
+
+// Same as iotc_x509_generate_credentials(), but can write DER, which is smaller and is not base64-decoded
+// by the TLS layer on every connect. The lengths of the written data are returned in certificate_len and private_key_len.
+// For PEM the lengths include the null terminator. Pass them as device_cert_size and device_key_size
+// in IotConnectX509Config.
+int iotc_x509_generate_credentials_ex(
+		IotcX509Format format,
+		unsigned char* certificate_buffer, size_t certificate_buffer_size, size_t* certificate_len,
+		unsigned char* private_key_buffer, size_t private_key_buffer_size, size_t* private_key_len
+);
+
+// Generates a new private key and a certificate signing request for it with the IOTC_GENCRT_SUBJECT_NAME subject,
+// for devices that enroll with a certificate signed by a CA. The lengths are returned the same way
+// as with iotc_x509_generate_credentials_ex().
+int iotc_x509_generate_csr(
+		IotcX509Format format,
+		unsigned char* csr_buffer, size_t csr_buffer_size, size_t* csr_len,
+		unsigned char* private_key_buffer, size_t private_key_buffer_size, size_t* private_key_len
+);
+
+// Returned by iotc_x509_get_credentials(), outside of the range of the mbedtls error codes
+#define IOTC_GENCRT_ERR_BUFFER_TOO_SMALL	(-0x10001)	// a stored value does not fit into its buffer
+#define IOTC_GENCRT_ERR_STORED				(-0x10002)	// the stored credentials cannot be read, or are not valid
+
+// Same as iotc_x509_generate_credentials(), but the generated key and certificate are saved with iotc_kvstore
+// under the unique ID of the chip, and later calls return the saved pair without generating anything.
+// New credentials are generated only if none are stored (the store read returns -1). If the stored credentials
+// do not fit into the buffers or cannot be read, an IOTC_GENCRT_ERR_* error is returned and they are left in place,
+// so that the identity of the device does not change.
+// Without a key-value store (see iotc_kvstore_set()), new credentials are generated on every call.
+// The private key is saved as-is, so the store should be backed by protected storage.
+int iotc_x509_get_credentials(
+		char* pem_certificate_buffer,
+		size_t pem_certificate_buffer_size,
+		char* pem_private_key_buffer,
+		size_t pem_private_key_buffer_size
+);
+
+// Removes the saved credentials, so that the next iotc_x509_get_credentials() call generates a new pair
+void iotc_x509_clear_credentials(void);
@@ -8,7 +8,10 @@
 
 #include <cy_http_client_api.h>
 
-#include "iotcl_certs.h"
+#include "iotcl.h"
+#include "iotc_ca_store.h"
+#include "iotc_certs.h"
+#include "iotc_dns_cache.h"
 #include "iotc_http_client.h"
 
 #ifndef IOTC_HTTP_SEND_RECV_TIMEOUT_MS
@@ -40,14 +43,24 @@ unsigned int iotconnect_https_request(IotConnectHttpResponse *response, const ch
     server_info.host_name = host;
     server_info.port = 443;
 
-    credentials.root_ca = IOTCL_CERT_GODADDY_SECURE_SERVER_CERTIFICATE_G2;
-    credentials.root_ca_size = strlen(IOTCL_CERT_GODADDY_SECURE_SERVER_CERTIFICATE_G2) + 1; // needs to include the null
+    // The HTTP root is not in the CA store (see iotc_ca_store_init()), so it is passed with each connection
+    size_t root_ca_size = 0; // for PEM, this needs to include the null
+    credentials.root_ca = iotc_certs_get_http_root(&root_ca_size);
+    credentials.root_ca_size = root_ca_size;
     credentials.root_ca_verify_mode = CY_AWS_ROOTCA_VERIFY_REQUIRED;
     credentials.sni_host_name = host;
     credentials.sni_host_name_size = strlen(host) + 1; // needs to include the null
 
     response->data = NULL;
 
+    // The request needs the host name for the Host header, so we cannot connect to a cached address directly.
+    // Fail fast on a name that recently failed to resolve and otherwise keep the lwIP DNS table warm for the connect.
+    if (IOTC_DNS_CACHE_NEGATIVE == iotc_dns_cache_lookup(host, NULL)) {
+        printf("Failed to resolve %s recently. Not connecting.\n", host);
+        return (unsigned int) IOTCL_ERR_FAILED;
+    }
+    (void) iotc_dns_preresolve(host);
+
     res = cy_http_client_init();
     if (res != CY_RSLT_SUCCESS) {
         printf("Failed to init the http client. Error=0x%08x\n", (unsigned int) res);
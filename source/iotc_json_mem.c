@@ -0,0 +1,200 @@
+/* SPDX-License-Identifier: MIT
+ * Copyright (C) 2025 Avnet
+ * Authors: Nikola Markovic <nikola.markovic@avnet.com> et al.
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <cJSON.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "iotc_json_mem.h"
+
+#define ARENA_ALIGNMENT 8
+
+#if IOTC_JSON_ARENA_SIZE > 0
+static uint64_t arena[(IOTC_JSON_ARENA_SIZE + sizeof(uint64_t) - 1) / sizeof(uint64_t)]; // 8-byte aligned
+#define ARENA_BYTES sizeof(arena)
+#define ARENA_START ((uint8_t *) arena)
+#endif
+
+#if IOTC_JSON_PRINT_BUFFER_COUNT > 0
+#if IOTC_JSON_PRINT_BUFFER_COUNT > 32
+#error "IOTC_JSON_PRINT_BUFFER_COUNT can be at most 32"
+#endif
+static uint64_t print_buffers[IOTC_JSON_PRINT_BUFFER_COUNT][(IOTC_JSON_PRINT_BUFFER_SIZE + sizeof(uint64_t) - 1) / sizeof(uint64_t)];
+static uint32_t print_buffers_in_use = 0; // bit N is set if buffer N is in use
+#define PRINT_POOL_START ((uint8_t *) print_buffers)
+#define PRINT_POOL_END (PRINT_POOL_START + sizeof(print_buffers))
+#endif
+
+static bool is_hooks_installed = false;
+static TaskHandle_t arena_owner = NULL; // the task in an arena scope, or NULL
+static size_t arena_top = 0;            // bytes handed out since the last reset
+static unsigned int arena_live = 0;     // arena allocations that were not freed yet
+static IotcJsonMemStats stats = {0};
+
+#if IOTC_JSON_PRINT_BUFFER_COUNT > 0
+// Returns the index of a free print buffer, or -1 if all are in use
+static int print_buffer_acquire(void) {
+    int index = -1;
+    taskENTER_CRITICAL();
+    for (int i = 0; i < IOTC_JSON_PRINT_BUFFER_COUNT; i++) {
+        if (0 == (print_buffers_in_use & (1u << i))) {
+            print_buffers_in_use |= (1u << i);
+            index = i;
+            break;
+        }
+    }
+    if (index < 0) {
+        stats.print_buffer_exhausted++;
+    }
+    taskEXIT_CRITICAL();
+    return index;
+}
+
+static void print_buffer_release(int index) {
+    taskENTER_CRITICAL();
+    print_buffers_in_use &= ~(1u << index);
+    taskEXIT_CRITICAL();
+}
+#endif
+
+static void *json_malloc(size_t size) {
+#if IOTC_JSON_ARENA_SIZE > 0
+    if (arena_owner && xTaskGetCurrentTaskHandle() == arena_owner) {
+        size_t aligned_size = (size + ARENA_ALIGNMENT - 1) & ~((size_t) ARENA_ALIGNMENT - 1);
+        void *p = NULL;
+        taskENTER_CRITICAL();
+        if (aligned_size <= ARENA_BYTES - arena_top) {
+            p = ARENA_START + arena_top;
+            arena_top += aligned_size;
+            arena_live++;
+            stats.arena_allocations++;
+            if (arena_top > stats.peak_usage) {
+                stats.peak_usage = arena_top;
+            }
+        } else {
+            stats.heap_fallbacks++;
+        }
+        taskEXIT_CRITICAL();
+        if (p) {
+            return p;
+        }
+    }
+#endif
+    return malloc(size);
+}
+
+static void json_free(void *p) {
+    uint8_t *bp = (uint8_t *) p;
+    (void) bp;
+#if IOTC_JSON_ARENA_SIZE > 0
+    // An object may be freed by any task, so decide by the address
+    if (bp >= ARENA_START && bp < ARENA_START + ARENA_BYTES) {
+        taskENTER_CRITICAL();
+        if (arena_live > 0 && 0 == --arena_live) {
+            arena_top = 0; // everything was freed, so the whole arena can be reused
+        }
+        taskEXIT_CRITICAL();
+        return;
+    }
+#endif
+    free(p);
+}
+
+void iotc_json_mem_init(void) {
+    // Objects allocated by cJSON before this point came from malloc(), so they can still be freed with json_free()
+    if (!is_hooks_installed) {
+        cJSON_Hooks hooks = {json_malloc, json_free};
+        cJSON_InitHooks(&hooks);
+        is_hooks_installed = true;
+    }
+}
+
+void iotc_json_mem_begin(void) {
+    arena_owner = xTaskGetCurrentTaskHandle();
+}
+
+void iotc_json_mem_end(void) {
+    arena_owner = NULL;
+}
+
+static void count_print(unsigned int *counter) {
+    taskENTER_CRITICAL();
+    (*counter)++;
+    taskEXIT_CRITICAL();
+}
+
+#if IOTC_JSON_PRINT_BUFFER_COUNT > 0
+static bool is_pool_buffer(const char *json) {
+    const uint8_t *bp = (const uint8_t *) json;
+    return bp >= PRINT_POOL_START && bp < PRINT_POOL_END;
+}
+#endif
+
+char *iotc_json_mem_print(cJSON *item) {
+#if IOTC_JSON_PRINT_BUFFER_COUNT > 0
+    int index = print_buffer_acquire();
+    if (index >= 0) {
+        char *buffer = (char *) print_buffers[index];
+        if (cJSON_PrintPreallocated(item, buffer, IOTC_JSON_PRINT_BUFFER_SIZE, false)) {
+            count_print(&stats.print_buffer_allocations);
+            return buffer;
+        }
+        print_buffer_release(index);
+        count_print(&stats.print_buffer_too_large);
+    }
+#endif
+    return cJSON_PrintUnformatted(item);
+}
+
+char *iotc_json_mem_get_buffer(void) {
+#if IOTC_JSON_PRINT_BUFFER_COUNT > 0
+    int index = print_buffer_acquire();
+    if (index >= 0) {
+        count_print(&stats.print_buffer_allocations);
+        return (char *) print_buffers[index];
+    }
+#endif
+    return (char *) cJSON_malloc(IOTC_JSON_PRINT_BUFFER_SIZE);
+}
+
+char *iotc_json_mem_grow(char *json, size_t length, size_t new_size) {
+    char *buffer = (char *) cJSON_malloc(new_size);
+    if (!buffer) {
+        return NULL;
+    }
+    memcpy(buffer, json, length);
+#if IOTC_JSON_PRINT_BUFFER_COUNT > 0
+    if (is_pool_buffer(json)) {
+        // counted once per message, when it leaves the pool
+        taskENTER_CRITICAL();
+        stats.print_buffer_allocations--;
+        stats.print_buffer_too_large++;
+        taskEXIT_CRITICAL();
+    }
+#endif
+    iotc_json_mem_free_print(json);
+    return buffer;
+}
+
+void iotc_json_mem_free_print(char *json) {
+#if IOTC_JSON_PRINT_BUFFER_COUNT > 0
+    if (is_pool_buffer(json)) {
+        print_buffer_release((int) (((uint8_t *) json - PRINT_POOL_START) / sizeof(print_buffers[0])));
+        return;
+    }
+#endif
+    cJSON_free(json);
+}
+
+void iotc_json_mem_get_stats(IotcJsonMemStats *s) {
+    taskENTER_CRITICAL();
+    memcpy(s, &stats, sizeof(IotcJsonMemStats));
+    taskEXIT_CRITICAL();
+}
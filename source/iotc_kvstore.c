@@ -0,0 +1,43 @@
+/* SPDX-License-Identifier: MIT
+ * Copyright (C) 2025 Avnet
+ * Authors: Nikola Markovic <nikola.markovic@avnet.com> et al.
+ */
+
+#include <stdio.h>
+
+#include "iotc_kvstore.h"
+
+static const IotcKvStore *kvstore = NULL;
+
+void iotc_kvstore_set(const IotcKvStore *store) {
+    if (store && (!store->read || !store->write || !store->remove)) {
+        printf("IOTC: All key-value store callbacks must be provided!\n");
+        return;
+    }
+    kvstore = store;
+}
+
+bool iotc_kvstore_is_available(void) {
+    return NULL != kvstore;
+}
+
+int iotc_kvstore_read(const char *key, void *data, size_t size) {
+    if (!kvstore) {
+        return -1;
+    }
+    return kvstore->read(key, data, size);
+}
+
+int iotc_kvstore_write(const char *key, const void *data, size_t size) {
+    if (!kvstore) {
+        return -1;
+    }
+    return kvstore->write(key, data, size);
+}
+
+int iotc_kvstore_remove(const char *key) {
+    if (!kvstore) {
+        return -1;
+    }
+    return kvstore->remove(key);
+}
@@ -9,10 +9,13 @@
 /* FreeRTOS header files */
 #include "FreeRTOS.h"
 #include "task.h"
+#include "cyabs_rtos.h"
 
 #include "cy_mqtt_api.h"
 
-#include "iotcl_certs.h"
+#include "iotc_ca_store.h"
+#include "iotc_certs.h"
+#include "iotc_dns_cache.h"
 #include "iotc_mqtt_client.h"
 
 /* Maximum number of retries for MQTT subscribe operation */
@@ -38,11 +41,14 @@
 
 static cy_mqtt_t mqtt_connection;
 static uint8_t mqtt_network_buffer[MQTT_NETWORK_BUFFER_SIZE];
+static char mqtt_broker_address[IPADDR_STRLEN_MAX]; // resolved broker IP. Must outlive the MQTT handle.
 static bool is_connected = false;
 static bool is_disconnect_requested = false;
 static bool is_mqtt_initialized = false;
 static IotConnectMqttInboundMessageCallback mqtt_inbound_msg_cb = NULL; // callback for inbound messages
 static IotConnectStatusCallback status_cb = NULL; // callback for connection status
+static int publishes_in_progress = 0; // guarded by critical sections, as publishes can come from any task
+static cy_time_t last_publish_time = 0;
 
 static void mqtt_event_callback(cy_mqtt_t mqtt_handle, cy_mqtt_event_t event, void *user_data) {
     (void) mqtt_handle;
@@ -120,7 +126,8 @@ static cy_rslt_t mqtt_subscribe(IotclMqttConfig *mc, cy_mqtt_qos_t qos) {
     return result;
 }
 
-static cy_rslt_t mqtt_connect(IotclMqttConfig *mc) {
+// Makes the connection attempts from first_attempt up to (excluding) last_attempt
+static cy_rslt_t mqtt_connect(IotclMqttConfig *mc, uint32_t first_attempt, uint32_t last_attempt) {
     /* Variable to indicate status of various operations. */
     cy_rslt_t result = CY_RSLT_SUCCESS;
 
@@ -140,7 +147,7 @@ static cy_rslt_t mqtt_connect(IotclMqttConfig *mc) {
      * as a prefix if the `GENERATE_UNIQUE_CLIENT_ID` macro is enabled.
      */
 
-    for (uint32_t retry_count = 0; retry_count < IOTC_MAX_MQTT_CONN_RETRIES; retry_count++) {
+    for (uint32_t retry_count = first_attempt; retry_count < last_attempt; retry_count++) {
 
         /* Establish the MQTT connection. */
         result = cy_mqtt_connect(mqtt_connection, &connection_info);
@@ -162,6 +169,9 @@ static cy_rslt_t mqtt_connect(IotclMqttConfig *mc) {
         vTaskDelay(pdMS_TO_TICKS(backoff));
     }
 
+    if (last_attempt < IOTC_MAX_MQTT_CONN_RETRIES) {
+        return result; // the caller will retry
+    }
     printf("Exceeded maximum MQTT connection attempts\n");
     printf("MQTT connection failed after retrying for %d mins\n",
             (int) ((IOTC_MQTT_CONN_RETRY_INTERVAL_MS * IOTC_MAX_MQTT_CONN_RETRIES) / 60000u));
@@ -214,6 +224,15 @@ bool iotc_mqtt_client_is_connected() {
     return is_connected;
 }
 
+bool iotc_mqtt_client_is_publish_recent(cy_time_t quiet_ms) {
+    cy_time_t now = 0;
+    (void) cy_rtos_get_time(&now);
+    taskENTER_CRITICAL();
+    bool is_recent = publishes_in_progress > 0 || (0 != last_publish_time && now - last_publish_time < quiet_ms);
+    taskEXIT_CRITICAL();
+    return is_recent;
+}
+
 cy_rslt_t iotc_mqtt_client_publish(const char* topic, const char *payload, int qos) {
     /* Status variable */
     cy_rslt_t result;
@@ -231,8 +250,19 @@ cy_rslt_t iotc_mqtt_client_publish(const char* topic, const char *payload, int q
     publish_info.payload = payload;
     publish_info.payload_len = strlen(payload);
 
+    taskENTER_CRITICAL();
+    publishes_in_progress++;
+    taskEXIT_CRITICAL();
+
     result = cy_mqtt_publish(mqtt_connection, &publish_info);
 
+    cy_time_t now = 0;
+    (void) cy_rtos_get_time(&now);
+    taskENTER_CRITICAL();
+    publishes_in_progress--;
+    last_publish_time = now;
+    taskEXIT_CRITICAL();
+
     if (result != CY_RSLT_SUCCESS) {
         printf("Publisher: MQTT Publish failed with error 0x%0X.\n", (int) result);
         return result;
@@ -240,34 +270,13 @@ cy_rslt_t iotc_mqtt_client_publish(const char* topic, const char *payload, int q
     return CY_RSLT_SUCCESS;
 }
 
-cy_rslt_t iotc_mqtt_client_init(IotConnectMqttConfig *c) {
-    /* Variable to indicate status of various operations. */
+// broker_hostname is either the host name or the resolved address. cy_mqtt keeps the pointer, so it must outlive the handle.
+static cy_rslt_t create_client(IotConnectMqttConfig *c, IotclMqttConfig *mc, const char *broker_hostname) {
     cy_rslt_t result;
 
-    IotclMqttConfig* mc = iotcl_mqtt_get_config();
-    if (!mc) {
-    	return CY_RSLT_MODULE_MQTT_ERROR; // called function will print the error
-    }
-
-    if (!mc->sub_c2d)
-
-    mqtt_inbound_msg_cb = NULL;
-    status_cb = NULL;
-    is_connected = false;
-    is_disconnect_requested = false;
-
-    /* Initialize the MQTT library. */
-    result = cy_mqtt_init();
-    if (result) {
-        iotc_cleanup_mqtt();
-        printf("Failed to initialize the MQTT library. Error was:0x%08x\n", (unsigned int) result);
-        return result;
-    }
-    is_mqtt_initialized = true;
-
     cy_mqtt_broker_info_t broker_info = { //
-    		.hostname = mc->host, //
-			.hostname_len = strlen(mc->host),
+    		.hostname = broker_hostname, //
+			.hostname_len = strlen(broker_hostname),
 			.port = 8883 //
     };
 
@@ -278,24 +287,27 @@ cy_rslt_t iotc_mqtt_client_init(IotConnectMqttConfig *c) {
 
     if (c->x509_config->server_ca_cert) {
     	security_info.root_ca = c->x509_config->server_ca_cert;
+    	security_info.root_ca_size = strlen(c->x509_config->server_ca_cert) + 1;
+    } else if (iotc_ca_store_lend(c->connection_type)) {
+    	security_info.root_ca = NULL; // verify against the pre-parsed roots in the TLS layer
+    	security_info.root_ca_size = 0;
     } else {
-    	switch(c->connection_type) {
-    	case IOTC_CT_AWS:
-    		security_info.root_ca = IOTCL_AMAZON_ROOT_CA1;
-    		break;
-    	case IOTC_CT_AZURE:
-    		security_info.root_ca = IOTCL_CERT_DIGICERT_GLOBAL_ROOT_G2;
-    		break;
-    	default:
+    	size_t root_ca_size = 0;
+    	security_info.root_ca = iotc_certs_get_root(c->connection_type, &root_ca_size);
+    	if (!security_info.root_ca) {
     		// the SDK will check, but just in case
     		printf("connection_type must be set Azure or AWS\n");
         	return CY_RSLT_MODULE_MQTT_BADARG;
     	}
+    	security_info.root_ca_size = root_ca_size;
     }
-    security_info.root_ca_size = strlen(security_info.root_ca) + 1;
 
 	security_info.client_cert = c->x509_config->device_cert;
-	security_info.client_cert_size = strlen(c->x509_config->device_cert) + 1;
+	// Same as for the key below. A DER cert has no terminator, so it needs the size.
+	security_info.client_cert_size = c->x509_config->device_cert_size;
+	if (0 == security_info.client_cert_size) {
+		security_info.client_cert_size = strlen(c->x509_config->device_cert) + 1;
+	}
 	security_info.private_key = c->x509_config->device_key;
     // NOTE: This could be an opaque key and not a PEM cert.
     // So if they user sets the size, trust them.
@@ -315,7 +327,6 @@ cy_rslt_t iotc_mqtt_client_init(IotConnectMqttConfig *c) {
 
     if (result) {
         printf("Failed to create the MQTT client. Error was:0x%08x\n", (unsigned int) result);
-        iotc_cleanup_mqtt();
         return result;
     }
 
@@ -323,11 +334,60 @@ cy_rslt_t iotc_mqtt_client_init(IotConnectMqttConfig *c) {
 	result = cy_mqtt_register_event_callback( mqtt_connection, (cy_mqtt_callback_t)mqtt_event_callback, NULL );
     if (result) {
         printf("Failed to register the MQTT callback! Error was:0x%08x\n", (unsigned int) result);
+    }
+    return result;
+}
+
+cy_rslt_t iotc_mqtt_client_init(IotConnectMqttConfig *c) {
+    /* Variable to indicate status of various operations. */
+    cy_rslt_t result;
+
+    IotclMqttConfig* mc = iotcl_mqtt_get_config();
+    if (!mc) {
+    	return CY_RSLT_MODULE_MQTT_ERROR; // called function will print the error
+    }
+
+    if (!mc->sub_c2d)
+
+    mqtt_inbound_msg_cb = NULL;
+    status_cb = NULL;
+    is_connected = false;
+    is_disconnect_requested = false;
+
+    /* Initialize the MQTT library. */
+    result = cy_mqtt_init();
+    if (result) {
+        iotc_cleanup_mqtt();
+        printf("Failed to initialize the MQTT library. Error was:0x%08x\n", (unsigned int) result);
+        return result;
+    }
+    is_mqtt_initialized = true;
+
+    // Connect to the cached broker address so that reconnects do not wait on DNS.
+    // The TLS SNI and certificate hostname checks still use the host name.
+    bool is_cached_address =
+    		CY_RSLT_SUCCESS == iotc_dns_resolve_to_string(mc->host, mqtt_broker_address, sizeof(mqtt_broker_address));
+    result = create_client(c, mc, is_cached_address ? mqtt_broker_address : mc->host);
+    if (result) {
         iotc_cleanup_mqtt();
         return result;
     }
 
-    result = mqtt_connect(mc);
+    // With a cached address, make only the first attempt to it
+    result = mqtt_connect(mc, 0, is_cached_address ? 1 : IOTC_MAX_MQTT_CONN_RETRIES);
+    if (result && is_cached_address && IOTC_MAX_MQTT_CONN_RETRIES > 1) {
+        // The cached address may be stale, or the broker behind it may be gone. Drop it and connect
+        // to the host name for the remaining attempts, so that each attempt resolves it again.
+        iotc_dns_cache_invalidate(mc->host);
+        (void) cy_mqtt_delete(mqtt_connection);
+        mqtt_connection = NULL;
+        result = create_client(c, mc, mc->host);
+        if (result) {
+            iotc_cleanup_mqtt();
+            return result;
+        }
+        result = mqtt_connect(mc, 1, IOTC_MAX_MQTT_CONN_RETRIES);
+    }
     if (result) {
         iotc_cleanup_mqtt();
         return result;
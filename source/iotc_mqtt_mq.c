@@ -6,6 +6,8 @@
 #include <stdbool.h>
 #include <string.h>
 #include <stdio.h>
+#include "FreeRTOS.h"
+#include "task.h"
 #include "iotcl.h"
 #include "iotcl_util.h"
 #include "iotc_mqtt_mq.h"
@@ -14,6 +16,16 @@
 #define IOTC_MQ_PUT_TIMEOUT 100
 #endif
 
+// Messages other than commands and OTA updates do not hold up the MQTT client if the queue is full
+#ifndef IOTC_MQ_PUT_TIMEOUT_LOW_PRIORITY
+#define IOTC_MQ_PUT_TIMEOUT_LOW_PRIORITY 0
+#endif
+
+typedef struct {
+	char ack_id[IOTC_MQ_DEDUP_ACK_ID_SIZE]; // null terminated
+	cy_time_t seen_time;
+} IotcMqDedupEntry;
+
 typedef struct IotcMqMessage {
 	char *topic;
 	char *message;
@@ -22,8 +34,150 @@ typedef struct IotcMqMessage {
 
 static cy_queue_t cy_queue = NULL;
 static bool is_initialized = false;
+// Set while a wake-up from iotc_mq_wake() is in the queue, so that it holds at most one queue slot
+static volatile bool is_wake_pending = false;
+// Set if the queue was full when a wake-up was requested. iotc_mq_process() then returns after the next message.
+static volatile bool is_wake_missed = false;
 
 static IotConnectMqttInboundMessageCallback client_msg_cb = NULL;
+static IotcMqFilterCallback filter_cb = NULL;
+
+// Most recently seen first. Only accessed from the MQTT client's callback.
+static IotcMqDedupEntry dedup_entries[IOTC_MQ_DEDUP_SIZE > 0 ? IOTC_MQ_DEDUP_SIZE : 1];
+static size_t dedup_count = 0;
+static unsigned int duplicate_count = 0;
+
+// Returns the index of the entry with the message's ack ID, or dedup_count if there is none
+static size_t iotc_mq_find_seen(const IotcMqC2dInfo *info) {
+	size_t i;
+	for (i = 0; i < dedup_count; i++) {
+		if (0 == strncmp(dedup_entries[i].ack_id, info->ack_id, info->ack_id_len)
+				&& 0 == dedup_entries[i].ack_id[info->ack_id_len]) {
+			break;
+		}
+	}
+	return i;
+}
+
+// Messages are identified by their ack ID. Messages without one (or with one too long to remember) are never
+// considered duplicates, because a repeated payload, such as the same command sent twice, can be intended.
+static bool iotc_mq_is_dedup_candidate(const IotcMqC2dInfo *info) {
+	return IOTC_MQ_DEDUP_SIZE > 0 && info->ack_id && info->ack_id_len > 0 && info->ack_id_len < IOTC_MQ_DEDUP_ACK_ID_SIZE;
+}
+
+// Returns true if a message with the same ack ID was queued recently
+static bool iotc_mq_is_duplicate(const IotcMqC2dInfo *info) {
+	cy_time_t now = 0;
+	if (!iotc_mq_is_dedup_candidate(info)) {
+		return false;
+	}
+	(void) cy_rtos_get_time(&now);
+	size_t i = iotc_mq_find_seen(info);
+	return i < dedup_count && (now - dedup_entries[i].seen_time) < IOTC_MQ_DEDUP_TTL_MS;
+}
+
+// Records the message's ack ID as the most recently seen one. Called only once the message is queued,
+// so that a redelivery of a message that could not be queued is not dropped.
+static void iotc_mq_record_seen(const IotcMqC2dInfo *info) {
+	IotcMqDedupEntry entry;
+	if (!iotc_mq_is_dedup_candidate(info)) {
+		return;
+	}
+	memcpy(entry.ack_id, info->ack_id, info->ack_id_len);
+	entry.ack_id[info->ack_id_len] = 0;
+	(void) cy_rtos_get_time(&entry.seen_time);
+
+	size_t i = iotc_mq_find_seen(info);
+	if (i == dedup_count) {
+		// not found. Evict the least recently seen entry if full.
+		if (dedup_count < IOTC_MQ_DEDUP_SIZE) {
+			dedup_count++;
+		}
+		i = dedup_count - 1;
+	}
+	memmove(&dedup_entries[1], &dedup_entries[0], i * sizeof(IotcMqDedupEntry));
+	dedup_entries[0] = entry;
+}
+
+static size_t iotc_mq_skip_whitespace(const char *message, size_t message_len, size_t i) {
+	while (i < message_len && (' ' == message[i] || '\t' == message[i] || '\r' == message[i] || '\n' == message[i])) {
+		i++;
+	}
+	return i;
+}
+
+bool iotc_mq_scan_c2d(const char *message, size_t message_len, IotcMqC2dInfo *info) {
+	const char *key = NULL; // the top level key whose value comes next
+	size_t key_len = 0;
+	int depth = 0;
+	size_t i = iotc_mq_skip_whitespace(message, message_len, 0);
+
+	info->ct = IOTC_MQ_CT_UNKNOWN;
+	info->ack_id = NULL;
+	info->ack_id_len = 0;
+
+	if (i >= message_len || '{' != message[i]) {
+		return false;
+	}
+	while (i < message_len) {
+		char c = message[i];
+		if ('"' == c) {
+			size_t start = ++i;
+			while (i < message_len && '"' != message[i]) {
+				i += ('\\' == message[i]) ? 2 : 1;
+			}
+			if (i >= message_len) {
+				return false; // unterminated string
+			}
+			size_t len = i - start;
+			i++;
+			if (1 != depth) {
+				continue;
+			}
+			size_t next = iotc_mq_skip_whitespace(message, message_len, i);
+			if (next < message_len && ':' == message[next]) {
+				key = &message[start];
+				key_len = len;
+				i = next + 1;
+			} else {
+				if (key && 3 == key_len && 0 == memcmp(key, "ack", 3)) {
+					info->ack_id = &message[start];
+					info->ack_id_len = len;
+				}
+				key = NULL;
+			}
+			continue;
+		}
+		if ('{' == c || '[' == c) {
+			depth++;
+			key = NULL;
+		} else if ('}' == c || ']' == c) {
+			depth--;
+			if (0 == depth) {
+				return true;
+			}
+		} else if (1 == depth && key && ('-' == c || (c >= '0' && c <= '9'))) {
+			int value = 0;
+			bool is_negative = '-' == c;
+			if (is_negative) {
+				i++;
+			}
+			while (i < message_len && message[i] >= '0' && message[i] <= '9') {
+				value = value * 10 + (message[i] - '0');
+				i++;
+			}
+			if (2 == key_len && 0 == memcmp(key, "ct", 2)) {
+				info->ct = is_negative ? -value : value;
+			}
+			key = NULL;
+			continue;
+		} else if (1 == depth && key && !(' ' == c || '\t' == c || '\r' == c || '\n' == c)) {
+			key = NULL; // true, false or null
+		}
+		i++;
+	}
+	return false; // unterminated object
+}
 
 static void iotc_mq_destroy_message(IotcMqMessage *msg) {
 	if (msg->topic) {
@@ -58,6 +212,9 @@ cy_rslt_t iotc_mq_init(size_t queue_size) {
     	printf("ERROR: iotc_mq_init queue error 0x%lx.\n", CY_RSLT_GET_CODE(result));
     }
     is_initialized = true;
+    is_wake_pending = false;
+    is_wake_missed = false;
+    dedup_count = 0;
     return result;
 }
 
@@ -79,16 +236,37 @@ void iotc_mq_on_mqtt_inbound_message(const char* topic, const char *message, siz
     	return;
     }
 
+    // Classify the message without building the JSON tree
+    IotcMqC2dInfo info;
+    if (!iotc_mq_scan_c2d(message, message_len, &info)) {
+    	printf("WARN: iotc_mq: Received a message that does not look like a JSON object\n");
+    	// let the library report the parsing error
+    }
+
+    if (filter_cb && !filter_cb(&info)) {
+    	return;
+    }
+
+    // QoS 1 can redeliver a message after a reconnect. Drop it here so that a command or OTA does not run twice.
+    if (iotc_mq_is_duplicate(&info)) {
+    	duplicate_count++;
+    	printf("WARN: iotc_mq: Dropped a duplicate message (%u so far)\n", duplicate_count);
+    	return;
+    }
+
     if (false == iotc_mq_create_message(&msg, topic, message, message_len)) {
     	return; // called function will print the error. We just need to return.
     }
 
     // we should be able to put the message in immediately, so give it a rough timeout
-    result = cy_rtos_put_queue(&cy_queue, &msg, IOTC_MQ_PUT_TIMEOUT, false);
+    bool is_high_priority = IOTC_MQ_CT_COMMAND == info.ct || IOTC_MQ_CT_OTA == info.ct;
+    result = cy_rtos_put_queue(&cy_queue, &msg, is_high_priority ? IOTC_MQ_PUT_TIMEOUT : IOTC_MQ_PUT_TIMEOUT_LOW_PRIORITY, false);
     if (CY_RSLT_SUCCESS != result) {
     	iotc_mq_destroy_message(&msg);
     	printf("ERROR: iotc_mq: queue put error 0x%lx.\n", CY_RSLT_GET_CODE(result));
+    	return;
     }
+    iotc_mq_record_seen(&info);
 }
 
 void iotc_mq_process(cy_time_t timeout_ms) {
@@ -107,7 +285,17 @@ void iotc_mq_process(cy_time_t timeout_ms) {
 	    }
 
 	    if (result == CY_RSLT_SUCCESS) {
+	    	if (!msg.topic) {
+	    		// woken up by iotc_mq_wake(). Cleared before the caller acts on it, so that a later wake-up is not lost.
+	    		is_wake_pending = false;
+	    		return;
+	    	}
 			client_msg_cb(msg.topic, msg.message, msg.message_len);
+			iotc_mq_destroy_message(&msg);
+			if (is_wake_missed) {
+				is_wake_missed = false;
+				return;
+			}
 	    } else {
 	    	// Seems that with this case https://github.com/Infineon/freertos/blob/release-v10.5.002/Source/queue.c#L1494
 	    	// there is no return from the queue, so we have to do some shenanigans here...
@@ -125,6 +313,35 @@ void iotc_mq_process(cy_time_t timeout_ms) {
 	} while (result == CY_RSLT_SUCCESS);
 }
 
+void iotc_mq_set_filter(IotcMqFilterCallback cb) {
+	filter_cb = cb;
+}
+
+unsigned int iotc_mq_get_duplicate_count(void) {
+	return duplicate_count;
+}
+
+void iotc_mq_wake(void) {
+	IotcMqMessage msg;
+	bool is_already_pending;
+	if (!is_initialized) {
+		return;
+	}
+	taskENTER_CRITICAL();
+	is_already_pending = is_wake_pending;
+	is_wake_pending = true;
+	taskEXIT_CRITICAL();
+	if (is_already_pending) {
+		return; // the poll has not returned for the pending one yet, and will see this event too
+	}
+	memset(&msg, 0, sizeof(IotcMqMessage));
+	if (CY_RSLT_SUCCESS != cy_rtos_put_queue(&cy_queue, &msg, 0, false)) {
+		// the queue is full, so the poll will return after the next message instead
+		is_wake_missed = true;
+		is_wake_pending = false;
+	}
+}
+
 void iotc_mq_flush(void) {
 	IotcMqMessage msg;
 
@@ -134,6 +351,8 @@ void iotc_mq_flush(void) {
 	while(CY_RSLT_SUCCESS == cy_rtos_get_queue( &cy_queue, (void *)&msg, 1, false )) {
 		iotc_mq_destroy_message(&msg);
 	}
+	is_wake_pending = false;
+	is_wake_missed = false;
 }
 
 void iotc_mq_deregister(void) {
@@ -8,21 +8,43 @@
 // To avoid potential issues with older BSPs if OTA is not supported
 #ifdef IOTC_OTA_SUPPORT
 
+#include <string.h>
+
 #include "cyabs_rtos.h"
 #include "cy_log.h"
 #include "cy_ota_api.h"
 #include "cy_ota_storage_api.h"
 
-#include "iotcl_certs.h"
 #include "iotcl.h"
 #include "iotcl_util.h"
 
+#include "iotc_ca_store.h"
+#include "iotc_certs.h"
+#include "iotc_dns_cache.h"
 #include "iotc_ota.h"
+#include "iotc_ota_preflight.h"
+#include "iotc_ota_stats.h"
+#include "iotc_ota_throttle.h"
 
 /* Application ID */
 #define APP_ID                              (0)
 #define HTTP_SERVER_PORT	443
 
+// Set to 0 to have iotc_ota_start() skip checking the image size and header before starting the OTA agent
+#ifndef IOTC_OTA_PREFLIGHT
+#define IOTC_OTA_PREFLIGHT 1
+#endif
+
+#ifdef IOTC_OTA_DIRECT_DOWNLOAD
+// The thread that runs iotc_ota_download() for iotc_ota_start(). It needs room for the TLS handshake.
+#ifndef IOTC_OTA_START_STACK_SIZE
+#define IOTC_OTA_START_STACK_SIZE (8 * 1024)
+#endif
+
+#ifndef IOTC_OTA_START_PRIORITY
+#define IOTC_OTA_START_PRIORITY CY_RTOS_PRIORITY_NORMAL
+#endif
+#endif
 
 
 // Captured task handle that will will resume in case of synchronous OTA
@@ -34,12 +56,45 @@ static cy_rslt_t last_session_result = CY_RSLT_OTA_ERROR_GENERAL; // assume a fa
 
 static cy_ota_context_ptr ota_context;
 
+#ifdef IOTC_OTA_DIRECT_DOWNLOAD
+// State of the iotc_ota_start() download thread. The strings are owned by the thread.
+static cy_thread_t download_thread;
+static bool is_download_thread_created = false; // until it is joined by the next iotc_ota_start()
+static volatile bool is_download_running = false;
+static IotConnectConnectionType download_connection_type;
+static char *download_host;
+static char *download_path;
+static cy_ota_callback_t download_cb;
+#endif
+
+// Start of the current phase of the agent download, for the download stats
+static cy_time_t phase_start_time;
+
+// The agent calls this after receiving each block, so the time since the previous block is the download time.
+// The agent receives the next block only after this returns, which is what lets the throttle slow it down.
+static cy_rslt_t ota_timed_write(cy_ota_context_ptr ctx_ptr, cy_ota_storage_write_info_t *chunk_info) {
+	cy_time_t start_time = iotc_ota_stats_add(IOTC_OTA_PHASE_DOWNLOAD, phase_start_time);
+	cy_rslt_t result = cy_ota_storage_write(ctx_ptr, chunk_info);
+	(void) iotc_ota_stats_add(IOTC_OTA_PHASE_WRITE, start_time);
+	iotc_ota_stats_add_bytes(chunk_info->size);
+	iotc_ota_throttle_wait(chunk_info->size);
+	phase_start_time = iotc_ota_stats_now();
+	return result;
+}
+
+static cy_rslt_t ota_timed_verify(cy_ota_context_ptr ctx_ptr) {
+	cy_time_t start_time = iotc_ota_stats_now();
+	cy_rslt_t result = cy_ota_storage_verify(ctx_ptr);
+	(void) iotc_ota_stats_add(IOTC_OTA_PHASE_VERIFY, start_time);
+	return result;
+}
+
 static cy_ota_storage_interface_t ota_interfaces = {
    .ota_file_open            = cy_ota_storage_open,
    .ota_file_read            = cy_ota_storage_read,
-   .ota_file_write           = cy_ota_storage_write,
+   .ota_file_write           = ota_timed_write,
    .ota_file_close           = cy_ota_storage_close,
-   .ota_file_verify          = cy_ota_storage_verify,
+   .ota_file_verify          = ota_timed_verify,
    .ota_file_validate        = cy_ota_storage_image_validate,
    .ota_file_get_app_info    = cy_ota_storage_get_app_info
 };
@@ -161,11 +216,13 @@ static cy_ota_callback_results_t iotc_ota_callback(cy_ota_cb_struct_t *cb_data)
 			break;
 
 		case CY_OTA_STATE_DATA_CONNECT:
+			phase_start_time = iotc_ota_stats_now();
 			printf("APP CB OTA CONNECT FOR DATA using ");
 			printf("HTTP: %s:%d \n", cb_data->broker_server.host_name, cb_data->broker_server.port);
 			break;
 
 		case CY_OTA_STATE_DATA_DOWNLOAD:
+			phase_start_time = iotc_ota_stats_add(IOTC_OTA_PHASE_CONNECT, phase_start_time);
 			printf("APP CB OTA DATA DOWNLOAD using ");
 			/* NOTE:
 			 *  HTTP - json_doc holds the HTTP "GET" request
@@ -204,6 +261,7 @@ static cy_ota_callback_results_t iotc_ota_callback(cy_ota_cb_struct_t *cb_data)
 
 		case CY_OTA_STATE_OTA_COMPLETE:
 			printf("APP CB OTA Session Complete\n");
+			iotc_ota_stats_finish();
 			last_session_result = cy_ota_get_last_error();
 			xTaskNotifyGive(app_task_handle);
 			cb_result = CY_OTA_CB_RSLT_OTA_STOP;
@@ -214,6 +272,9 @@ static cy_ota_callback_results_t iotc_ota_callback(cy_ota_cb_struct_t *cb_data)
 			break;
 
 		case CY_OTA_STATE_STORAGE_WRITE:
+			if (!iotc_ota_stats_is_progress_due(cb_data->bytes_written, cb_data->total_size)) {
+				break;
+			}
 			printf("APP CB OTA STORAGE WRITE %ld%% (%ld of %ld)\n", (unsigned long) cb_data->percentage,
 					(unsigned long) cb_data->bytes_written, (unsigned long) cb_data->total_size);
 
@@ -257,28 +318,134 @@ cy_rslt_t iotc_ota_storage_validated(void) {
 	return result;
 }
 
+#ifdef IOTC_OTA_DIRECT_DOWNLOAD
+// Reports the end of a download to the callback of iotc_ota_start() like the OTA agent reports the end of a session,
+// with CY_OTA_REASON_SUCCESS or CY_OTA_REASON_FAILURE, followed by the CY_OTA_STATE_OTA_COMPLETE state change.
+static void report_download_result(void) {
+	cy_ota_cb_struct_t cb_data;
+
+	if (!download_cb) {
+		if (CY_RSLT_SUCCESS == last_session_result) {
+			printf("OTA download complete.\n");
+		} else {
+			printf("OTA download failed: %s\n", iotc_ota_get_download_error_string());
+		}
+		return;
+	}
+	memset(&cb_data, 0, sizeof(cb_data));
+	cb_data.cb_arg = ota_agent_params.cb_arg;
+	cb_data.ota_agt_state = CY_OTA_STATE_OTA_COMPLETE;
+	cb_data.reason = (CY_RSLT_SUCCESS == last_session_result) ? CY_OTA_REASON_SUCCESS : CY_OTA_REASON_FAILURE;
+	(void) download_cb(&cb_data);
+	cb_data.reason = CY_OTA_REASON_STATE_CHANGE;
+	(void) download_cb(&cb_data);
+}
+
+static void free_download_url(void) {
+	if (download_host) {
+		iotcl_free(download_host);
+		download_host = NULL;
+	}
+	if (download_path) {
+		iotcl_free(download_path);
+		download_path = NULL;
+	}
+}
+
+static void download_thread_fn(cy_thread_arg_t arg) {
+	(void) arg;
+	last_session_result = iotc_ota_download(download_connection_type, download_host, download_path);
+	free_download_url();
+	report_download_result();
+	bool is_reset_needed = CY_RSLT_SUCCESS == last_session_result && ota_agent_params.reboot_upon_completion;
+	is_download_running = false;
+	if (is_reset_needed) {
+		iotc_ota_system_reset();
+	}
+	cy_rtos_exit_thread();
+}
+
+// Runs iotc_ota_download() in a thread, so that iotc_ota_start() can resume an interrupted download as well
+static cy_rslt_t start_download(IotConnectConnectionType connection_type, const char *host, const char *path, cy_ota_callback_t usr_ota_cb) {
+	if (is_download_running) {
+		printf("Error: OTA download is already running!\n");
+		return CY_RSLT_OTA_ERROR_ALREADY_STARTED;
+	}
+	if (is_download_thread_created) {
+		// the previous download has finished, so this returns right away
+		(void) cy_rtos_join_thread(&download_thread);
+		is_download_thread_created = false;
+	}
+
+	download_host = iotcl_strdup(host);
+	download_path = iotcl_strdup(path);
+	if (!download_host || !download_path) {
+		printf("Error: Failed to allocate the OTA URL!\n");
+		free_download_url();
+		return CY_RSLT_OTA_ERROR_GENERAL;
+	}
+	download_connection_type = connection_type;
+	download_cb = usr_ota_cb;
+	last_session_result = CY_RSLT_OTA_ERROR_GENERAL; // until the download completes
+	is_download_running = true;
+	cy_rslt_t result = cy_rtos_create_thread(&download_thread, download_thread_fn, "iotc_ota_start", NULL,
+			IOTC_OTA_START_STACK_SIZE, IOTC_OTA_START_PRIORITY, NULL);
+	if (CY_RSLT_SUCCESS != result) {
+		printf("Failed to start the OTA download thread. Error is %lu\n", result);
+		is_download_running = false;
+		free_download_url();
+		return result;
+	}
+	is_download_thread_created = true;
+	return CY_RSLT_SUCCESS;
+}
+#endif
+
 cy_rslt_t iotc_ota_start(IotConnectConnectionType connection_type, const char *host, const char *path, cy_ota_callback_t usr_ota_cb) {
 	if (path == NULL || host == NULL) {
 		return -1;
 	}
 
-	switch(connection_type) {
-		case IOTC_CT_AWS:
-			ota_network_params.http.credentials.root_ca = IOTCL_AMAZON_ROOT_CA1;
-			ota_network_params.http.credentials.root_ca_size = sizeof(IOTCL_AMAZON_ROOT_CA1);
-			break;
-		case IOTC_CT_AZURE:
-			ota_network_params.http.credentials.root_ca = IOTCL_CERT_DIGICERT_GLOBAL_ROOT_G2;
-			ota_network_params.http.credentials.root_ca_size = sizeof(IOTCL_CERT_DIGICERT_GLOBAL_ROOT_G2);
-			break;
-		default:
-			printf("Error: OTA Connection Type invalid!\n");
-			return -2;
+#ifdef IOTC_OTA_DIRECT_DOWNLOAD
+	// the agent code below is not used in this case
+	return start_download(connection_type, host, path, usr_ota_cb);
+#endif
+
+	size_t root_ca_size = 0;
+	ota_network_params.http.credentials.root_ca = iotc_certs_get_root(connection_type, &root_ca_size);
+	if (!ota_network_params.http.credentials.root_ca) {
+		printf("Error: OTA Connection Type invalid!\n");
+		return -2;
+	}
+	ota_network_params.http.credentials.root_ca_size = root_ca_size;
+	if (iotc_ca_store_lend(connection_type)) {
+		// verify against the pre-parsed roots in the TLS layer
+		ota_network_params.http.credentials.root_ca = NULL;
+		ota_network_params.http.credentials.root_ca_size = 0;
+	}
 
+	// The OTA agent resolves the host on its own, but we can fail fast on a name that recently failed to resolve
+	// and otherwise ensure that the agent's lookup is answered from the lwIP DNS table.
+	if (IOTC_DNS_CACHE_NEGATIVE == iotc_dns_cache_lookup(host, NULL)) {
+		printf("Error: OTA host %s failed to resolve recently!\n", host);
+		return -3;
+	}
+	(void) iotc_dns_preresolve(host);
+
+#if IOTC_OTA_PREFLIGHT
+	// The agent would find out that the image does not fit, or is not an image, only after downloading it
+	cy_rslt_t preflight_result = iotc_ota_preflight(connection_type, host, path);
+	if (CY_RSLT_SUCCESS != preflight_result) {
+		last_session_result = preflight_result;
+		return preflight_result;
 	}
+#endif
 
 	last_session_result = CY_RSLT_OTA_ERROR_GENERAL; // assume a failure unless we get CY_OTA_STATE_OTA_COMPLETE
 	iotc_ota_cleanup();
+	iotc_ota_stats_reset();
+	iotc_ota_throttle_start();
+	phase_start_time = iotc_ota_stats_now();
 
 	ota_agent_params.cb_func = usr_ota_cb ? usr_ota_cb : iotc_ota_callback;
 
@@ -294,6 +461,18 @@ cy_rslt_t iotc_ota_start(IotConnectConnectionType connection_type, const char *h
 }
 
 cy_rslt_t iotc_ota_run(IotConnectConnectionType connection_type, const char *host, const char *path, cy_ota_callback_t usr_ota_cb) {
+#ifdef IOTC_OTA_DIRECT_DOWNLOAD
+	(void) usr_ota_cb; // the OTA agent is not used, so there are no agent callbacks
+	if (is_download_running) {
+		printf("Error: OTA download is already running!\n");
+		return CY_RSLT_OTA_ERROR_ALREADY_STARTED;
+	}
+	last_session_result = iotc_ota_download(connection_type, host, path);
+	if (CY_RSLT_SUCCESS == last_session_result && ota_agent_params.reboot_upon_completion) {
+		iotc_ota_system_reset();
+	}
+	return last_session_result;
+#else
 	cy_rslt_t result = iotc_ota_start(connection_type, host, path, usr_ota_cb);
 	if (CY_RSLT_SUCCESS != result) {
 		// OTA did not start. The called function will print the error.
@@ -302,11 +481,13 @@ cy_rslt_t iotc_ota_run(IotConnectConnectionType connection_type, const char *hos
 	app_task_handle = xTaskGetCurrentTaskHandle();
 	// wait for OTA completion
 	ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(60 * 60 * 1000)); // one hour
+	iotc_ota_stats_finish(); // in case that the user callback handled the completion
 
 	iotc_ota_cleanup();
 
 	// the user should call
 	return result;
+#endif
 }
 
 cy_rslt_t iotc_ota_get_download_status(void) {
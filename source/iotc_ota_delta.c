@@ -0,0 +1,175 @@
+/* SPDX-License-Identifier: MIT
+ * Copyright (C) 2025 Avnet
+ * Authors: Nikola Markovic <nikola.markovic@avnet.com> et al.
+ */
+
+#if defined(IOTC_OTA_SUPPORT) && defined(IOTC_OTA_DIRECT_DOWNLOAD)
+
+#include <string.h>
+
+#include "iotc_ota_delta.h"
+
+#define OP_COPY     0x01
+#define OP_ADD      0x02
+#define OP_INSERT   0x03
+
+#define STATE_HEADER    0
+#define STATE_OP        1
+#define STATE_ARGS      2
+#define STATE_DATA      3
+
+#define SOURCE_PIECE_SIZE 64
+
+static uint32_t get_u32(const uint8_t *p) {
+    return (uint32_t) p[0] | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+static size_t min_size(size_t a, size_t b) {
+    return a < b ? a : b;
+}
+
+bool iotc_ota_delta_is_delta(const uint8_t *data, size_t len) {
+    return len >= 4 && 0 == memcmp(data, IOTC_OTA_DELTA_MAGIC, 4);
+}
+
+uint32_t iotc_ota_delta_get_target_size(const uint8_t *data, size_t len) {
+    if (len < IOTC_OTA_DELTA_HEADER_SIZE || !iotc_ota_delta_is_delta(data, len)) {
+        return 0;
+    }
+    return get_u32(&data[8]);
+}
+
+void iotc_ota_delta_init(IotcOtaDelta *d) {
+    memset(d, 0, sizeof(IotcOtaDelta));
+    d->state = STATE_HEADER;
+}
+
+static int check_source(IotcOtaDelta *d, IotcOtaDeltaSourceRead read_source, uint32_t expected_hash) {
+    uint8_t piece[SOURCE_PIECE_SIZE];
+    uint32_t hash = 2166136261u;
+    for (uint32_t offset = 0; offset < d->source_size; offset += SOURCE_PIECE_SIZE) {
+        size_t len = min_size(SOURCE_PIECE_SIZE, d->source_size - offset);
+        if (0 != read_source(offset, piece, len)) {
+            return IOTC_OTA_DELTA_ERR_SOURCE;
+        }
+        for (size_t i = 0; i < len; i++) {
+            hash ^= piece[i];
+            hash *= 16777619u;
+        }
+    }
+    return hash == expected_hash ? IOTC_OTA_DELTA_OK : IOTC_OTA_DELTA_ERR_SOURCE;
+}
+
+static int parse_header(IotcOtaDelta *d, IotcOtaDeltaSourceRead read_source) {
+    if (!iotc_ota_delta_is_delta(d->buf, IOTC_OTA_DELTA_HEADER_SIZE) || IOTC_OTA_DELTA_VERSION != d->buf[4]) {
+        return IOTC_OTA_DELTA_ERR_FORMAT;
+    }
+    d->target_size = get_u32(&d->buf[8]);
+    d->source_size = get_u32(&d->buf[12]);
+    return check_source(d, read_source, get_u32(&d->buf[16]));
+}
+
+// Called once the arguments of the record are collected
+static int start_record(IotcOtaDelta *d) {
+    if (OP_INSERT == d->op) {
+        d->src_offset = 0;
+        d->remaining = get_u32(&d->buf[0]);
+    } else {
+        d->src_offset = get_u32(&d->buf[0]);
+        d->remaining = get_u32(&d->buf[4]);
+        if (d->src_offset > d->source_size || d->remaining > d->source_size - d->src_offset) {
+            return IOTC_OTA_DELTA_ERR_FORMAT;
+        }
+    }
+    if (d->remaining > d->target_size - d->produced) {
+        return IOTC_OTA_DELTA_ERR_FORMAT;
+    }
+    d->state = d->remaining > 0 ? STATE_DATA : STATE_OP;
+    return IOTC_OTA_DELTA_OK;
+}
+
+int iotc_ota_delta_process(IotcOtaDelta *d, IotcOtaDeltaSourceRead read_source,
+        const uint8_t *in, size_t in_len, size_t *in_used,
+        uint8_t *out, size_t out_size, size_t *out_len) {
+    size_t ip = 0;
+    size_t op = 0;
+    int ret = IOTC_OTA_DELTA_OK;
+
+    while (IOTC_OTA_DELTA_OK == ret && op < out_size) {
+        if (STATE_DATA == d->state) {
+            size_t n = min_size(d->remaining, out_size - op);
+            if (OP_COPY != d->op) {
+                n = min_size(n, in_len - ip); // ADD and INSERT consume a byte of input per byte of output
+                if (0 == n) {
+                    break;
+                }
+            }
+            if (OP_INSERT == d->op) {
+                memcpy(&out[op], &in[ip], n);
+            } else {
+                if (0 != read_source(d->src_offset, &out[op], n)) {
+                    ret = IOTC_OTA_DELTA_ERR_SOURCE;
+                    break;
+                }
+                if (OP_ADD == d->op) {
+                    for (size_t i = 0; i < n; i++) {
+                        out[op + i] = (uint8_t) (out[op + i] + in[ip + i]);
+                    }
+                }
+                d->src_offset += n;
+            }
+            if (OP_COPY != d->op) {
+                ip += n;
+            }
+            op += n;
+            d->produced += n;
+            d->remaining -= n;
+            if (0 == d->remaining) {
+                d->state = STATE_OP;
+            }
+            continue;
+        }
+
+        if (ip >= in_len) {
+            break;
+        }
+        uint8_t byte = in[ip++];
+        switch (d->state) {
+            case STATE_HEADER:
+                d->buf[d->have++] = byte;
+                if (IOTC_OTA_DELTA_HEADER_SIZE == d->have) {
+                    ret = parse_header(d, read_source);
+                    d->state = STATE_OP;
+                }
+                break;
+            case STATE_OP:
+                if (OP_COPY != byte && OP_ADD != byte && OP_INSERT != byte) {
+                    ret = IOTC_OTA_DELTA_ERR_FORMAT;
+                    break;
+                }
+                d->op = byte;
+                d->have = 0;
+                d->state = STATE_ARGS;
+                break;
+            case STATE_ARGS:
+                d->buf[d->have++] = byte;
+                if (d->have == (OP_INSERT == d->op ? 4 : 8)) {
+                    ret = start_record(d);
+                }
+                break;
+            default:
+                ret = IOTC_OTA_DELTA_ERR_FORMAT;
+                break;
+        }
+    }
+
+    *in_used = ip;
+    *out_len = op;
+    return ret;
+}
+
+bool iotc_ota_delta_is_complete(const IotcOtaDelta *d) {
+    return STATE_OP == d->state && d->produced == d->target_size;
+}
+
+#endif // IOTC_OTA_SUPPORT && IOTC_OTA_DIRECT_DOWNLOAD
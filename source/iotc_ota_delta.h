@@ -0,0 +1,76 @@
+/* SPDX-License-Identifier: MIT
+ * Copyright (C) 2025 Avnet
+ * Authors: Nikola Markovic <nikola.markovic@avnet.com> et al.
+ */
+
+#ifndef IOTC_OTA_DELTA_H
+#define IOTC_OTA_DELTA_H
+
+// Streaming decoder for delta OTA artifacts, which describe the new image in terms of the image that is running.
+// Delta artifacts are generated with tools/iotc_ota_delta.py. All numbers are little endian.
+//
+// Header (IOTC_OTA_DELTA_HEADER_SIZE bytes):
+//     "IOTD", version (1 byte), 3 reserved bytes,
+//     target size (4), source size (4), FNV-1a hash of the first <source size> bytes of the running image (4)
+// Followed by records:
+//     0x01 COPY   source offset (4), length (4)                  - copy bytes from the running image
+//     0x02 ADD    source offset (4), length (4), <length> bytes  - add the bytes to the running image bytes, modulo 256
+//     0x03 INSERT length (4), <length> bytes                     - new bytes
+//
+// The decoder state is a plain struct, so that it can be saved and restored to continue an interrupted download.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IOTC_OTA_DELTA_MAGIC "IOTD"
+#define IOTC_OTA_DELTA_VERSION 1
+#define IOTC_OTA_DELTA_HEADER_SIZE 20
+
+#define IOTC_OTA_DELTA_OK 0
+#define IOTC_OTA_DELTA_ERR_FORMAT (-1)  // the artifact is not a valid delta
+#define IOTC_OTA_DELTA_ERR_SOURCE (-2)  // the running image could not be read or is not the one the delta was made for
+
+// Reads len bytes of the running image at offset. Returns 0 on success.
+typedef int (*IotcOtaDeltaSourceRead)(uint32_t offset, uint8_t *buf, size_t len);
+
+typedef struct {
+    uint8_t state;
+    uint8_t op;
+    uint8_t have;           // header or argument bytes collected so far
+    uint8_t buf[IOTC_OTA_DELTA_HEADER_SIZE];
+    uint32_t target_size;
+    uint32_t source_size;
+    uint32_t src_offset;    // of the current record
+    uint32_t remaining;     // bytes of the current record yet to be output
+    uint32_t produced;      // total bytes output so far
+} IotcOtaDelta;
+
+// Returns true if the data starts with the delta magic
+bool iotc_ota_delta_is_delta(const uint8_t *data, size_t len);
+
+// Returns the target image size from the header at the start of data, or 0 if data does not start with a delta header
+uint32_t iotc_ota_delta_get_target_size(const uint8_t *data, size_t len);
+
+void iotc_ota_delta_init(IotcOtaDelta *d);
+
+// Consumes input and produces output until the input is used up or the output buffer is full.
+// *in_used and *out_len return the number of bytes consumed and produced.
+// Call again with the remaining input after the output is flushed. The call may produce output
+// without consuming any input (COPY records), so keep calling while it produces output.
+int iotc_ota_delta_process(IotcOtaDelta *d, IotcOtaDeltaSourceRead read_source,
+        const uint8_t *in, size_t in_len, size_t *in_used,
+        uint8_t *out, size_t out_size, size_t *out_len);
+
+// Returns true if the whole target image was produced and the decoder is not in the middle of a record
+bool iotc_ota_delta_is_complete(const IotcOtaDelta *d);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IOTC_OTA_DELTA_H
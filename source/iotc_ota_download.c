@@ -0,0 +1,889 @@
+/* SPDX-License-Identifier: MIT
+ * Copyright (C) 2025 Avnet
+ * Authors: Nikola Markovic <nikola.markovic@avnet.com> et al.
+ */
+
+// Direct OTA download with HTTP range requests, which can continue an interrupted download
+// and apply delta and compressed artifacts. While a chunk is downloaded into one buffer, a writer thread
+// decodes, programs, verifies and hashes the previous chunk from the other buffer.
+// See IOTC_OTA_DIRECT_DOWNLOAD in iotc_ota.h
+
+#if defined(IOTC_OTA_SUPPORT) && defined(IOTC_OTA_DIRECT_DOWNLOAD)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "cyabs_rtos.h"
+
+#include <cy_http_client_api.h>
+#include "cy_ota_api.h"
+#include "sysflash/sysflash.h"
+#include "flash_map_backend.h"
+#include "bootutil/bootutil.h"
+
+#include "iotcl.h"
+#include "iotc_ca_store.h"
+#include "iotc_certs.h"
+#include "iotc_dns_cache.h"
+#include "iotc_kvstore.h"
+#include "iotc_ota.h"
+#include "iotc_ota_delta.h"
+#include "iotc_ota_image.h"
+#include "iotc_ota_lzss.h"
+#include "iotc_ota_stats.h"
+#include "iotc_ota_throttle.h"
+
+// Size of each range request. Must be a multiple of IOTC_OTA_ERASE_BLOCK_SIZE or the other way around.
+#ifndef IOTC_OTA_DOWNLOAD_CHUNK_SIZE
+#define IOTC_OTA_DOWNLOAD_CHUNK_SIZE 4096
+#endif
+
+// Room for the HTTP response headers in the receive buffer
+#ifndef IOTC_OTA_DOWNLOAD_HEADER_SIZE
+#define IOTC_OTA_DOWNLOAD_HEADER_SIZE 1024
+#endif
+
+#ifndef IOTC_OTA_DOWNLOAD_TIMEOUT_MS
+#define IOTC_OTA_DOWNLOAD_TIMEOUT_MS 10000
+#endif
+
+// Number of failed requests in a row, without any progress, before the download is abandoned
+#ifndef IOTC_OTA_DOWNLOAD_MAX_RETRIES
+#define IOTC_OTA_DOWNLOAD_MAX_RETRIES 10
+#endif
+
+#ifndef IOTC_OTA_DOWNLOAD_RETRY_DELAY_MS
+#define IOTC_OTA_DOWNLOAD_RETRY_DELAY_MS 3000
+#endif
+
+// How often the download offset is saved to the key-value store. Smaller values mean that less is downloaded again
+// after a reboot, at the cost of more writes to the store.
+#ifndef IOTC_OTA_DOWNLOAD_PERSIST_INTERVAL
+#define IOTC_OTA_DOWNLOAD_PERSIST_INTERVAL (32 * 1024)
+#endif
+
+#ifndef IOTC_OTA_DOWNLOAD_KV_KEY
+#define IOTC_OTA_DOWNLOAD_KV_KEY "iotc_ota"
+#endif
+
+// The slot is erased in blocks of this size. Must be a multiple of the erase sector size of the flash holding the slot.
+#ifndef IOTC_OTA_ERASE_BLOCK_SIZE
+#define IOTC_OTA_ERASE_BLOCK_SIZE 4096
+#endif
+
+// Largest write alignment of the flash holding the slot
+#ifndef IOTC_OTA_WRITE_ALIGN_MAX
+#define IOTC_OTA_WRITE_ALIGN_MAX 512
+#endif
+
+// Size of the buffer that holds the image produced from a delta or compressed artifact before it is written.
+// Must be a multiple of the flash write alignment.
+#ifndef IOTC_OTA_OUT_BUFFER_SIZE
+#define IOTC_OTA_OUT_BUFFER_SIZE 512
+#endif
+
+// Set to 0 to download and write the chunks one after the other, which saves a chunk buffer and the writer stack
+#ifndef IOTC_OTA_DOWNLOAD_PIPELINE
+#define IOTC_OTA_DOWNLOAD_PIPELINE 1
+#endif
+
+#ifndef IOTC_OTA_WRITER_STACK_SIZE
+#define IOTC_OTA_WRITER_STACK_SIZE 4096
+#endif
+
+#ifndef IOTC_OTA_WRITER_PRIORITY
+#define IOTC_OTA_WRITER_PRIORITY CY_RTOS_PRIORITY_NORMAL
+#endif
+
+#define HTTP_SERVER_PORT 443
+#define RESUME_RECORD_MAGIC 0x494f5454 // "IOTT"
+#define VERIFY_PIECE_SIZE 128
+
+#if IOTC_OTA_ERASE_BLOCK_SIZE > IOTC_OTA_DOWNLOAD_CHUNK_SIZE + IOTC_OTA_DOWNLOAD_HEADER_SIZE
+#error "The HTTP buffer is used to preserve the start of an erase block when continuing a download, so it must not be smaller"
+#endif
+
+#define MODE_UNKNOWN 0  // the first chunk was not received yet
+#define MODE_RAW     1  // the artifact is the image
+#define MODE_DELTA   2  // the artifact is a delta against the running image
+#define MODE_LZSS    3  // the artifact is the compressed image
+
+// A point at which the download can continue: everything before offset in the artifact was processed and
+// everything before out_offset in the slot was written and verified
+typedef union {
+    IotcOtaDelta delta;
+    IotcOtaLzss lzss;
+} OtaDecoderState;
+
+typedef struct {
+    uint32_t offset;
+    uint32_t out_offset;
+    OtaDecoderState decoder;
+} OtaResumePoint;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t identity;      // hash of the image location, size and ETag
+    uint32_t total_size;
+    uint32_t out_total_size;
+    uint32_t mode;
+    OtaResumePoint point;
+} OtaResumeRecord;
+
+#if IOTC_OTA_DOWNLOAD_PIPELINE
+#define HTTP_BUFFER_COUNT 2
+#else
+#define HTTP_BUFFER_COUNT 1
+#endif
+
+// A downloaded chunk handed to the writer. NULL data tells the writer to exit.
+typedef struct {
+    const uint8_t *data;
+    uint32_t len;
+} OtaBlock;
+
+static uint8_t http_buffers[HTTP_BUFFER_COUNT][IOTC_OTA_DOWNLOAD_CHUNK_SIZE + IOTC_OTA_DOWNLOAD_HEADER_SIZE];
+static uint8_t out_buffer[IOTC_OTA_OUT_BUFFER_SIZE];
+static uint8_t lzss_window[IOTC_OTA_LZSS_WINDOW_SIZE];
+
+static struct {
+    cy_http_client_t handle;
+    bool is_connected;
+    const struct flash_area *fap;
+    const struct flash_area *source_fap; // the running image, for delta artifacts
+    uint32_t identity;
+    uint32_t total_size;        // of the artifact
+    uint32_t out_total_size;    // of the image written to the slot
+    uint32_t mode;
+    uint32_t fetch_offset;      // of the next artifact byte to download
+    uint32_t offset;            // of the next artifact byte to process. Owned by the writer while it runs.
+    uint32_t out_offset;        // of the next byte to write to the slot
+    size_t out_used;            // bytes in out_buffer
+    OtaDecoderState decoder;
+    OtaResumePoint point;       // the latest point at which the download can continue
+    uint32_t persisted_out_offset;
+    uint32_t resumed_bytes;
+    IotcOtaImageCheck image_check;
+    cy_thread_t writer;
+    cy_queue_t block_queue;     // of OtaBlock, to the writer
+    cy_queue_t result_queue;    // of cy_rslt_t, one for each block
+    bool is_writer_started;
+    bool is_block_pending;      // submitted, and its result was not collected yet
+    cy_rslt_t block_result;     // of the pending block, when there is no writer
+} dl;
+
+static uint32_t fnv1a(uint32_t hash, const void *data, size_t len) {
+    const uint8_t *p = (const uint8_t *) data;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= p[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static uint32_t align_up(uint32_t value, uint32_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Slot access
+
+static cy_rslt_t slot_open(void) {
+    if (0 != flash_area_open(FLASH_AREA_IMAGE_SECONDARY(0), &dl.fap)) {
+        printf("OTA: Failed to open the secondary slot!\n");
+        dl.fap = NULL;
+        return CY_RSLT_OTA_ERROR_OPEN_STORAGE;
+    }
+    return CY_RSLT_SUCCESS;
+}
+
+static void slot_close(void) {
+    if (dl.fap) {
+        flash_area_close(dl.fap);
+        dl.fap = NULL;
+    }
+}
+
+// Writes and reads back the data. The write is padded to the flash write alignment at the end of the image.
+static cy_rslt_t slot_write(uint32_t offset, const uint8_t *data, size_t len) {
+    uint32_t alignment = flash_area_align(dl.fap);
+    size_t aligned_len = len / alignment * alignment;
+    if (aligned_len > 0 && 0 != flash_area_write(dl.fap, offset, data, aligned_len)) {
+        goto write_failed;
+    }
+    if (aligned_len < len) {
+        uint8_t tail[IOTC_OTA_WRITE_ALIGN_MAX];
+        if (alignment > sizeof(tail)) {
+            goto write_failed;
+        }
+        memset(tail, flash_area_erased_val(dl.fap), alignment);
+        memcpy(tail, &data[aligned_len], len - aligned_len);
+        if (0 != flash_area_write(dl.fap, offset + aligned_len, tail, alignment)) {
+            goto write_failed;
+        }
+    }
+
+    for (size_t i = 0; i < len; i += VERIFY_PIECE_SIZE) {
+        uint8_t piece[VERIFY_PIECE_SIZE];
+        size_t piece_len = (len - i < VERIFY_PIECE_SIZE) ? len - i : VERIFY_PIECE_SIZE;
+        if (0 != flash_area_read(dl.fap, offset + i, piece, piece_len) || 0 != memcmp(piece, &data[i], piece_len)) {
+            printf("OTA: Data written at %lu does not read back correctly!\n", (unsigned long) (offset + i));
+            return CY_RSLT_OTA_ERROR_WRITE_STORAGE;
+        }
+    }
+    return CY_RSLT_SUCCESS;
+
+    write_failed:
+    printf("OTA: Failed to write the secondary slot at %lu!\n", (unsigned long) offset);
+    return CY_RSLT_OTA_ERROR_WRITE_STORAGE;
+}
+
+// Writes the next part of the image, in order, and adds it to the image check
+static cy_rslt_t image_write(const uint8_t *data, size_t len) {
+    cy_rslt_t res = slot_write(dl.out_offset, data, len);
+    if (CY_RSLT_SUCCESS != res) {
+        return res;
+    }
+    if (!iotc_ota_image_check_update(&dl.image_check, dl.out_offset, data, len, dl.out_total_size)) {
+        return CY_RSLT_OTA_ERROR_VERIFY;
+    }
+    dl.out_offset += len;
+    return CY_RSLT_SUCCESS;
+}
+
+static int slot_read(uint32_t offset, uint8_t *buf, size_t len) {
+    return flash_area_read(dl.fap, offset, buf, len);
+}
+
+// Erases the slot from offset up to the end of the image. The bytes between the start of the erase block
+// and offset are written back, so they are preserved. This must be called while the writer is not running.
+static cy_rslt_t slot_erase_from(uint32_t offset) {
+    uint32_t start = offset / IOTC_OTA_ERASE_BLOCK_SIZE * IOTC_OTA_ERASE_BLOCK_SIZE;
+    uint32_t head_len = offset - start;
+    uint32_t end = align_up(dl.out_total_size, IOTC_OTA_ERASE_BLOCK_SIZE);
+    if (end > dl.fap->fa_size) {
+        end = dl.fap->fa_size;
+    }
+    if (start >= end) {
+        return CY_RSLT_SUCCESS;
+    }
+    if (head_len > 0 && 0 != flash_area_read(dl.fap, start, http_buffers[0], head_len)) {
+        printf("OTA: Failed to read the secondary slot at %lu!\n", (unsigned long) start);
+        return CY_RSLT_OTA_ERROR_WRITE_STORAGE;
+    }
+    if (0 != flash_area_erase(dl.fap, start, end - start)) {
+        printf("OTA: Failed to erase the secondary slot at %lu!\n", (unsigned long) start);
+        return CY_RSLT_OTA_ERROR_WRITE_STORAGE;
+    }
+    return head_len > 0 ? slot_write(start, http_buffers[0], head_len) : CY_RSLT_SUCCESS;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Resume record
+
+static void record_save(void) {
+    OtaResumeRecord record = {
+        .magic = RESUME_RECORD_MAGIC,
+        .identity = dl.identity,
+        .total_size = dl.total_size,
+        .out_total_size = dl.out_total_size,
+        .mode = dl.mode,
+        .point = dl.point
+    };
+    if (0 != iotc_kvstore_write(IOTC_OTA_DOWNLOAD_KV_KEY, &record, sizeof(record)) && iotc_kvstore_is_available()) {
+        printf("OTA: Failed to save the download offset\n");
+    }
+    dl.persisted_out_offset = dl.point.out_offset;
+}
+
+// Restores the point at which the download of the current image can continue, if there is one
+static bool record_load(void) {
+    OtaResumeRecord record;
+    if (sizeof(record) != iotc_kvstore_read(IOTC_OTA_DOWNLOAD_KV_KEY, &record, sizeof(record))) {
+        return false;
+    }
+    if (RESUME_RECORD_MAGIC != record.magic
+            || record.identity != dl.identity
+            || record.total_size != dl.total_size
+            || record.point.offset >= dl.total_size
+            || record.point.out_offset > record.out_total_size
+            || record.out_total_size > dl.fap->fa_size
+            || (MODE_RAW != record.mode && MODE_DELTA != record.mode && MODE_LZSS != record.mode)) {
+        return false;
+    }
+    dl.mode = record.mode;
+    dl.out_total_size = record.out_total_size;
+    dl.point = record.point;
+    dl.offset = dl.point.offset;
+    dl.out_offset = dl.point.out_offset;
+    dl.decoder = dl.point.decoder;
+    dl.persisted_out_offset = dl.out_offset;
+    return true;
+}
+
+// Called after data was written to the slot, at a point where the download can continue
+static void record_update(void) {
+    dl.point.offset = dl.offset;
+    dl.point.out_offset = dl.out_offset;
+    dl.point.decoder = dl.decoder;
+    if (dl.out_offset - dl.persisted_out_offset >= IOTC_OTA_DOWNLOAD_PERSIST_INTERVAL) {
+        record_save();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// HTTP
+
+static cy_rslt_t http_connect(void) {
+    if (dl.is_connected) {
+        return CY_RSLT_SUCCESS;
+    }
+    cy_time_t start_time = iotc_ota_stats_now();
+    cy_rslt_t res = cy_http_client_connect(dl.handle, IOTC_OTA_DOWNLOAD_TIMEOUT_MS, IOTC_OTA_DOWNLOAD_TIMEOUT_MS);
+    (void) iotc_ota_stats_add(IOTC_OTA_PHASE_CONNECT, start_time);
+    if (CY_RSLT_SUCCESS != res) {
+        printf("OTA: Failed to connect to the server. Error=0x%08x\n", (unsigned int) res);
+        return CY_RSLT_OTA_ERROR_CONNECT;
+    }
+    dl.is_connected = true;
+    return CY_RSLT_SUCCESS;
+}
+
+static void http_disconnect(void) {
+    if (dl.is_connected) {
+        (void) cy_http_client_disconnect(dl.handle);
+        dl.is_connected = false;
+    }
+}
+
+// Requests bytes start to end (inclusive) into one of the http_buffers and checks that the server returned exactly those
+static cy_rslt_t http_get_range(const char *path, uint32_t start, uint32_t end, uint8_t *buffer, cy_http_client_response_t *response) {
+    cy_http_client_request_header_t request = {0};
+    request.buffer = buffer;
+    request.buffer_len = sizeof(http_buffers[0]);
+    request.method = CY_HTTP_CLIENT_METHOD_GET;
+    request.resource_path = path;
+    request.range_start = (int32_t) start;
+    request.range_end = (int32_t) end;
+
+    cy_time_t start_time = iotc_ota_stats_now();
+    cy_rslt_t res = cy_http_client_write_header(dl.handle, &request, NULL, 0);
+    if (CY_RSLT_SUCCESS == res) {
+        res = cy_http_client_send(dl.handle, &request, NULL, 0, response);
+    }
+    (void) iotc_ota_stats_add(IOTC_OTA_PHASE_DOWNLOAD, start_time);
+    if (CY_RSLT_SUCCESS != res) {
+        printf("OTA: Request for bytes %lu-%lu failed. Error=0x%08x\n",
+                (unsigned long) start, (unsigned long) end, (unsigned int) res);
+        http_disconnect(); // the connection may be in any state, so start over with a new one
+        return CY_RSLT_OTA_ERROR_GET_DATA;
+    }
+    if (206 != response->status_code) {
+        printf("OTA: Unexpected HTTP status %d for a range request\n", (int) response->status_code);
+        http_disconnect();
+        return CY_RSLT_OTA_ERROR_GET_DATA;
+    }
+    if (response->body_len != end - start + 1) {
+        printf("OTA: Received %lu bytes instead of %lu\n",
+                (unsigned long) response->body_len, (unsigned long) (end - start + 1));
+        http_disconnect();
+        return CY_RSLT_OTA_ERROR_GET_DATA;
+    }
+    iotc_ota_stats_add_bytes(response->body_len);
+    return CY_RSLT_SUCCESS;
+}
+
+// Gets the image size from the Content-Range header of a request for the first byte,
+// and computes the identity of the image. The query string is left out of the identity,
+// because it carries an access token that changes every time that an update is requested.
+static cy_rslt_t http_probe(const char *host, const char *path) {
+    cy_http_client_response_t response;
+    cy_rslt_t res = http_get_range(path, 0, 0, http_buffers[0], &response);
+    if (CY_RSLT_SUCCESS != res) {
+        return res;
+    }
+
+    cy_http_client_header_t headers[2] = {
+        {.field = "Content-Range", .field_len = strlen("Content-Range")},
+        {.field = "ETag", .field_len = strlen("ETag")}
+    };
+    (void) cy_http_client_read_header(dl.handle, &response, headers, 2);
+
+    // "bytes 0-0/<total>"
+    const char *slash = headers[0].value ? memchr(headers[0].value, '/', headers[0].value_len) : NULL;
+    dl.total_size = slash ? (uint32_t) strtoul(slash + 1, NULL, 10) : 0;
+    if (0 == dl.total_size) {
+        printf("OTA: The server did not report the image size\n");
+        return CY_RSLT_OTA_ERROR_GET_DATA;
+    }
+
+    const char *query = strchr(path, '?');
+    dl.identity = fnv1a(2166136261u, host, strlen(host));
+    dl.identity = fnv1a(dl.identity, path, query ? (size_t) (query - path) : strlen(path));
+    dl.identity = fnv1a(dl.identity, &dl.total_size, sizeof(dl.total_size));
+    if (headers[1].value) {
+        dl.identity = fnv1a(dl.identity, headers[1].value, headers[1].value_len);
+    }
+    return CY_RSLT_SUCCESS;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Processing
+
+static int source_read(uint32_t offset, uint8_t *buf, size_t len) {
+    return flash_area_read(dl.source_fap, offset, buf, len);
+}
+
+static cy_rslt_t source_open(void) {
+    if (0 != flash_area_open(FLASH_AREA_IMAGE_PRIMARY(0), &dl.source_fap)) {
+        printf("OTA: Failed to open the primary slot!\n");
+        dl.source_fap = NULL;
+        return CY_RSLT_OTA_ERROR_OPEN_STORAGE;
+    }
+    return CY_RSLT_SUCCESS;
+}
+
+static void source_close(void) {
+    if (dl.source_fap) {
+        flash_area_close(dl.source_fap);
+        dl.source_fap = NULL;
+    }
+}
+
+// Errors that will not go away by downloading again
+static bool is_fatal_error(cy_rslt_t res) {
+    return CY_RSLT_OTA_ERROR_WRITE_STORAGE == res
+            || CY_RSLT_OTA_ERROR_OPEN_STORAGE == res
+            || CY_RSLT_OTA_ERROR_VERIFY == res;
+}
+
+// Called with the first chunk of a download that starts from the beginning
+static cy_rslt_t start_image(const uint8_t *data, size_t len) {
+    cy_rslt_t res;
+
+    // A saved point of an earlier download is no longer valid once the slot is erased
+    (void) iotc_kvstore_remove(IOTC_OTA_DOWNLOAD_KV_KEY);
+
+    if (iotc_ota_delta_is_delta(data, len)) {
+        dl.mode = MODE_DELTA;
+        dl.out_total_size = iotc_ota_delta_get_target_size(data, len);
+        iotc_ota_delta_init(&dl.decoder.delta);
+        res = source_open();
+        if (CY_RSLT_SUCCESS != res) {
+            return res;
+        }
+        printf("OTA: Applying a delta update of %lu bytes for an image of %lu bytes\n",
+                (unsigned long) dl.total_size, (unsigned long) dl.out_total_size);
+    } else if (iotc_ota_lzss_is_compressed(data, len)) {
+        dl.mode = MODE_LZSS;
+        dl.out_total_size = iotc_ota_lzss_get_target_size(data, len);
+        iotc_ota_lzss_init(&dl.decoder.lzss);
+        printf("OTA: Decompressing %lu bytes into an image of %lu bytes\n",
+                (unsigned long) dl.total_size, (unsigned long) dl.out_total_size);
+    } else {
+        dl.mode = MODE_RAW;
+        dl.out_total_size = dl.total_size;
+    }
+    if (0 == dl.out_total_size || dl.out_total_size > dl.fap->fa_size) {
+        printf("OTA: The image size %lu does not fit the slot size %lu!\n",
+                (unsigned long) dl.out_total_size, (unsigned long) dl.fap->fa_size);
+        return CY_RSLT_OTA_ERROR_WRITE_STORAGE;
+    }
+    return slot_erase_from(0);
+}
+
+static cy_rslt_t flush_out_buffer(void) {
+    cy_rslt_t res = image_write(out_buffer, dl.out_used);
+    if (CY_RSLT_SUCCESS == res) {
+        dl.out_used = 0;
+    }
+    return res;
+}
+
+// Runs the decoder of the current mode. Returns CY_RSLT_SUCCESS or an error that was already printed.
+static cy_rslt_t decode(const uint8_t *in, size_t in_len, size_t *in_used, uint8_t *out, size_t out_size, size_t *out_len) {
+    if (MODE_DELTA == dl.mode) {
+        int ret = iotc_ota_delta_process(&dl.decoder.delta, source_read, in, in_len, in_used, out, out_size, out_len);
+        if (IOTC_OTA_DELTA_ERR_SOURCE == ret) {
+            printf("OTA: The delta was not made for the running image!\n");
+        } else if (IOTC_OTA_DELTA_OK != ret) {
+            printf("OTA: Invalid delta at %lu!\n", (unsigned long) (dl.offset + *in_used));
+        }
+        return IOTC_OTA_DELTA_OK == ret ? CY_RSLT_SUCCESS : CY_RSLT_OTA_ERROR_VERIFY;
+    } else {
+        int ret = iotc_ota_lzss_process(&dl.decoder.lzss, lzss_window, in, in_len, in_used, out, out_size, out_len);
+        if (IOTC_OTA_LZSS_OK != ret) {
+            printf("OTA: Invalid compressed data at %lu!\n", (unsigned long) (dl.offset + *in_used));
+        }
+        return IOTC_OTA_LZSS_OK == ret ? CY_RSLT_SUCCESS : CY_RSLT_OTA_ERROR_VERIFY;
+    }
+}
+
+static bool is_decoder_complete(void) {
+    if (MODE_DELTA == dl.mode) {
+        return iotc_ota_delta_is_complete(&dl.decoder.delta);
+    } else {
+        return iotc_ota_lzss_is_complete(&dl.decoder.lzss);
+    }
+}
+
+// Decodes a delta or compressed chunk into out_buffer, and writes out_buffer to the slot whenever it is full
+static cy_rslt_t process_encoded(const uint8_t *data, size_t len) {
+    uint32_t base = dl.offset;
+    size_t pos = 0;
+    cy_rslt_t res;
+
+    for (;;) {
+        size_t in_used;
+        size_t out_len;
+        res = decode(&data[pos], len - pos, &in_used, &out_buffer[dl.out_used], sizeof(out_buffer) - dl.out_used, &out_len);
+        if (CY_RSLT_SUCCESS != res) {
+            return res;
+        }
+        pos += in_used;
+        dl.out_used += out_len;
+        if (dl.out_used < sizeof(out_buffer)) {
+            break; // the decoder needs more input
+        }
+        res = flush_out_buffer();
+        if (CY_RSLT_SUCCESS != res) {
+            return res;
+        }
+        dl.offset = base + pos;
+        record_update();
+    }
+    dl.offset = base + len;
+
+    if (dl.offset == dl.total_size) {
+        if (dl.out_used > 0) {
+            res = flush_out_buffer();
+            if (CY_RSLT_SUCCESS != res) {
+                return res;
+            }
+        }
+        if (!is_decoder_complete() || dl.out_offset != dl.out_total_size) {
+            printf("OTA: The artifact ended before the whole image was produced!\n");
+            return CY_RSLT_OTA_ERROR_VERIFY;
+        }
+    }
+    return CY_RSLT_SUCCESS;
+}
+
+static cy_rslt_t process_chunk(const uint8_t *data, size_t len) {
+    cy_rslt_t res;
+    if (MODE_UNKNOWN == dl.mode) {
+        res = start_image(data, len);
+        if (CY_RSLT_SUCCESS != res) {
+            return res;
+        }
+    }
+    if (MODE_RAW != dl.mode) {
+        return process_encoded(data, len);
+    }
+    res = image_write(data, len);
+    if (CY_RSLT_SUCCESS != res) {
+        return res;
+    }
+    dl.offset += len;
+    record_update();
+    return CY_RSLT_SUCCESS;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Writer
+
+static cy_rslt_t process_block(const uint8_t *data, uint32_t len) {
+    cy_time_t start_time = iotc_ota_stats_now();
+    cy_rslt_t res = process_chunk(data, len);
+    (void) iotc_ota_stats_add(IOTC_OTA_PHASE_WRITE, start_time);
+    return res;
+}
+
+#if IOTC_OTA_DOWNLOAD_PIPELINE
+static void writer_thread(cy_thread_arg_t arg) {
+    OtaBlock block;
+    (void) arg;
+    while (CY_RSLT_SUCCESS == cy_rtos_get_queue(&dl.block_queue, &block, CY_RTOS_NEVER_TIMEOUT, false) && block.data) {
+        cy_rslt_t res = process_block(block.data, block.len);
+        (void) cy_rtos_put_queue(&dl.result_queue, &res, CY_RTOS_NEVER_TIMEOUT, false);
+    }
+    cy_rtos_exit_thread();
+}
+#endif
+
+// Without a writer, the chunks are processed by the downloading thread
+static void writer_start(void) {
+#if IOTC_OTA_DOWNLOAD_PIPELINE
+    // one block can be in the queue while the writer processes another
+    if (CY_RSLT_SUCCESS != cy_rtos_init_queue(&dl.block_queue, 1, sizeof(OtaBlock))) {
+        goto failed;
+    }
+    if (CY_RSLT_SUCCESS != cy_rtos_init_queue(&dl.result_queue, 1, sizeof(cy_rslt_t))) {
+        cy_rtos_deinit_queue(&dl.block_queue);
+        goto failed;
+    }
+    if (CY_RSLT_SUCCESS != cy_rtos_create_thread(&dl.writer, writer_thread, "iotc_ota", NULL,
+            IOTC_OTA_WRITER_STACK_SIZE, IOTC_OTA_WRITER_PRIORITY, NULL)) {
+        cy_rtos_deinit_queue(&dl.result_queue);
+        cy_rtos_deinit_queue(&dl.block_queue);
+        goto failed;
+    }
+    dl.is_writer_started = true;
+    return;
+
+    failed:
+    printf("OTA: Failed to start the writer. Downloading without overlapping the writes.\n");
+#endif
+}
+
+static void writer_stop(void) {
+    if (!dl.is_writer_started) {
+        return;
+    }
+    OtaBlock stop = {0};
+    (void) cy_rtos_put_queue(&dl.block_queue, &stop, CY_RTOS_NEVER_TIMEOUT, false);
+    (void) cy_rtos_join_thread(&dl.writer);
+    cy_rtos_deinit_queue(&dl.result_queue);
+    cy_rtos_deinit_queue(&dl.block_queue);
+    dl.is_writer_started = false;
+}
+
+// Waits for the block that was submitted last, and returns its result
+static cy_rslt_t block_wait(void) {
+    if (!dl.is_block_pending) {
+        return CY_RSLT_SUCCESS;
+    }
+    dl.is_block_pending = false;
+    if (dl.is_writer_started) {
+        (void) cy_rtos_get_queue(&dl.result_queue, &dl.block_result, CY_RTOS_NEVER_TIMEOUT, false);
+    }
+    return dl.block_result;
+}
+
+// The data must not be touched until block_wait() returns
+static void block_submit(const uint8_t *data, uint32_t len) {
+    dl.is_block_pending = true;
+    if (dl.is_writer_started) {
+        OtaBlock block = {.data = data, .len = len};
+        (void) cy_rtos_put_queue(&dl.block_queue, &block, CY_RTOS_NEVER_TIMEOUT, false);
+    } else {
+        dl.block_result = process_block(data, len);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Download
+
+// Downloads the next chunk and hands it to the writer once the previous chunk is written.
+// The chunk is downloaded into the buffer that the writer is not using.
+static cy_rslt_t download_chunk(const char *path, uint8_t *buffer) {
+    cy_http_client_response_t response;
+    uint32_t len = dl.total_size - dl.fetch_offset;
+    if (len > IOTC_OTA_DOWNLOAD_CHUNK_SIZE) {
+        len = IOTC_OTA_DOWNLOAD_CHUNK_SIZE;
+    }
+    iotc_ota_throttle_wait(len);
+    cy_rslt_t res = http_get_range(path, dl.fetch_offset, dl.fetch_offset + len - 1, buffer, &response);
+    if (CY_RSLT_SUCCESS != res) {
+        return res;
+    }
+    res = block_wait();
+    if (CY_RSLT_SUCCESS != res) {
+        return res; // the previous chunk failed, so there is no point in writing this one
+    }
+    block_submit(response.body, len);
+    dl.fetch_offset += len;
+    return CY_RSLT_SUCCESS;
+}
+
+// Continues the download from the saved point, if there is one for this image
+static cy_rslt_t resume(void) {
+    if (!record_load()) {
+        return CY_RSLT_SUCCESS;
+    }
+    dl.resumed_bytes = dl.offset;
+    printf("OTA: Continuing the download at %lu of %lu bytes\n",
+            (unsigned long) dl.offset, (unsigned long) dl.total_size);
+    if (MODE_DELTA == dl.mode) {
+        cy_rslt_t res = source_open();
+        if (CY_RSLT_SUCCESS != res) {
+            return res;
+        }
+    }
+    // Anything after the verified offset may have been partially written before the interruption
+    cy_rslt_t res = slot_erase_from(dl.out_offset);
+    if (CY_RSLT_SUCCESS != res) {
+        return res;
+    }
+    // The image hash covers what is already in the slot, and the decoder window is the output that precedes the point
+    uint32_t window_start = dl.out_offset < IOTC_OTA_LZSS_WINDOW_SIZE ? 0 : dl.out_offset - IOTC_OTA_LZSS_WINDOW_SIZE;
+    for (uint32_t pos = 0; pos < dl.out_offset; pos += VERIFY_PIECE_SIZE) {
+        uint32_t n = dl.out_offset - pos < VERIFY_PIECE_SIZE ? dl.out_offset - pos : VERIFY_PIECE_SIZE;
+        uint8_t piece[VERIFY_PIECE_SIZE];
+        if (0 != flash_area_read(dl.fap, pos, piece, n)) {
+            printf("OTA: Failed to read the secondary slot at %lu!\n", (unsigned long) pos);
+            return CY_RSLT_OTA_ERROR_WRITE_STORAGE;
+        }
+        if (!iotc_ota_image_check_update(&dl.image_check, pos, piece, n, dl.out_total_size)) {
+            return CY_RSLT_OTA_ERROR_VERIFY;
+        }
+        if (MODE_LZSS == dl.mode && pos + n > window_start) {
+            for (uint32_t i = 0; i < n; i++) {
+                lzss_window[(pos + i) & (IOTC_OTA_LZSS_WINDOW_SIZE - 1)] = piece[i];
+            }
+        }
+    }
+    dl.fetch_offset = dl.offset;
+    return CY_RSLT_SUCCESS;
+}
+
+static cy_rslt_t download(const char *host, const char *path) {
+    cy_rslt_t res;
+    bool is_started = false;
+    int failures = 0;
+    int next_buffer = 0;
+
+    while (!is_started || dl.fetch_offset < dl.total_size) {
+        res = http_connect();
+        if (CY_RSLT_SUCCESS == res) {
+            if (!is_started) {
+                res = http_probe(host, path);
+                if (CY_RSLT_SUCCESS == res) {
+                    res = resume();
+                    if (CY_RSLT_SUCCESS != res) {
+                        return res;
+                    }
+                    is_started = true;
+                }
+            } else {
+                res = download_chunk(path, http_buffers[next_buffer]);
+                if (is_fatal_error(res)) {
+                    return res;
+                }
+                if (CY_RSLT_SUCCESS == res) {
+                    next_buffer = (next_buffer + 1) % HTTP_BUFFER_COUNT;
+                    failures = 0;
+                    if (iotc_ota_stats_is_progress_due(dl.fetch_offset, dl.total_size)) {
+                        printf("OTA: Downloaded %lu of %lu bytes\n", (unsigned long) dl.fetch_offset, (unsigned long) dl.total_size);
+                    }
+                }
+            }
+        }
+        if (CY_RSLT_SUCCESS != res) {
+            failures++;
+            if (failures >= IOTC_OTA_DOWNLOAD_MAX_RETRIES) {
+                printf("OTA: Giving up after %d failed attempts at %lu bytes\n", failures, (unsigned long) dl.fetch_offset);
+                return res;
+            }
+            iotc_ota_stats_add_retry();
+            vTaskDelay(pdMS_TO_TICKS(IOTC_OTA_DOWNLOAD_RETRY_DELAY_MS));
+        }
+    }
+    return CY_RSLT_SUCCESS;
+}
+
+cy_rslt_t iotc_ota_download(IotConnectConnectionType connection_type, const char *host, const char *path) {
+    cy_awsport_ssl_credentials_t credentials;
+    cy_awsport_server_info_t server_info;
+    cy_rslt_t res;
+
+    if (path == NULL || host == NULL) {
+        return CY_RSLT_OTA_ERROR_BADARG;
+    }
+
+    memset(&dl, 0, sizeof(dl));
+    iotc_ota_image_check_init(&dl.image_check);
+    memset(&credentials, 0, sizeof(credentials));
+    memset(&server_info, 0, sizeof(server_info));
+    server_info.host_name = host;
+    server_info.port = HTTP_SERVER_PORT;
+
+    if (!iotc_ca_store_lend(connection_type)) {
+        size_t root_ca_size = 0;
+        credentials.root_ca = iotc_certs_get_root(connection_type, &root_ca_size);
+        if (!credentials.root_ca) {
+            printf("Error: OTA Connection Type invalid!\n");
+            return CY_RSLT_OTA_ERROR_BADARG;
+        }
+        credentials.root_ca_size = root_ca_size;
+    } // else leave root_ca NULL and verify against the pre-parsed roots in the TLS layer
+    credentials.root_ca_verify_mode = CY_AWS_ROOTCA_VERIFY_REQUIRED;
+    credentials.sni_host_name = host;
+    credentials.sni_host_name_size = strlen(host) + 1; // needs to include the null
+
+    if (IOTC_DNS_CACHE_NEGATIVE == iotc_dns_cache_lookup(host, NULL)) {
+        printf("Error: OTA host %s failed to resolve recently!\n", host);
+        return CY_RSLT_OTA_ERROR_CONNECT;
+    }
+    (void) iotc_dns_preresolve(host);
+
+    res = slot_open();
+    if (CY_RSLT_SUCCESS != res) {
+        iotc_ota_image_check_free(&dl.image_check);
+        return res;
+    }
+
+    if (CY_RSLT_SUCCESS != cy_http_client_init()) {
+        printf("OTA: Failed to init the http client\n");
+        iotc_ota_image_check_free(&dl.image_check);
+        slot_close();
+        return CY_RSLT_OTA_ERROR_GENERAL;
+    }
+    if (CY_RSLT_SUCCESS != cy_http_client_create(&credentials, &server_info, NULL, NULL, &dl.handle)) {
+        printf("OTA: Failed to create the http client\n");
+        (void) cy_http_client_deinit();
+        iotc_ota_image_check_free(&dl.image_check);
+        slot_close();
+        return CY_RSLT_OTA_ERROR_GENERAL;
+    }
+
+    iotc_ota_stats_reset();
+    iotc_ota_throttle_start();
+    writer_start();
+    res = download(host, path);
+    // The last chunk, or the chunk that was being written when the download failed
+    cy_rslt_t write_res = block_wait();
+    if (CY_RSLT_SUCCESS == res || is_fatal_error(write_res)) {
+        res = write_res;
+    }
+    writer_stop();
+
+    http_disconnect();
+    (void) cy_http_client_delete(dl.handle);
+    (void) cy_http_client_deinit();
+
+    cy_time_t verify_start_time = iotc_ota_stats_now();
+    if (CY_RSLT_SUCCESS == res && !iotc_ota_image_check_finish(&dl.image_check, slot_read, dl.out_total_size)) {
+        res = CY_RSLT_OTA_ERROR_VERIFY;
+    }
+    if (CY_RSLT_SUCCESS == res) {
+        // The image is complete, so a later download must start from the beginning
+        (void) iotc_kvstore_remove(IOTC_OTA_DOWNLOAD_KV_KEY);
+        if (0 != boot_set_pending(0)) {
+            printf("OTA: Failed to mark the image as pending!\n");
+            res = CY_RSLT_OTA_ERROR_VERIFY;
+        } else {
+            (void) iotc_ota_stats_add(IOTC_OTA_PHASE_VERIFY, verify_start_time);
+            printf("OTA: Downloaded %lu bytes. Continuing the earlier download saved %lu bytes.\n",
+                    (unsigned long) (dl.total_size - dl.resumed_bytes), (unsigned long) dl.resumed_bytes);
+        }
+    } else if (is_fatal_error(res)) {
+        (void) iotc_kvstore_remove(IOTC_OTA_DOWNLOAD_KV_KEY);
+    } else if (dl.point.out_offset > dl.persisted_out_offset) {
+        record_save(); // save what we have, so that the next attempt continues from here
+    }
+    iotc_ota_stats_finish();
+    iotc_ota_image_check_free(&dl.image_check);
+    source_close();
+    slot_close();
+    return res;
+}
+
+uint32_t iotc_ota_get_resumed_bytes(void) {
+    return dl.resumed_bytes;
+}
+
+#endif // IOTC_OTA_SUPPORT && IOTC_OTA_DIRECT_DOWNLOAD
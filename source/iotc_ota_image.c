@@ -0,0 +1,137 @@
+/* SPDX-License-Identifier: MIT
+ * Copyright (C) 2025 Avnet
+ * Authors: Nikola Markovic <nikola.markovic@avnet.com> et al.
+ */
+
+#ifdef IOTC_OTA_SUPPORT
+
+#include <stdio.h>
+#include <string.h>
+
+#include "iotc_ota_image.h"
+
+// See bootutil/image.h in MCUboot
+#define IMAGE_MAGIC                 0x96f3b83d
+#define IMAGE_TLV_INFO_MAGIC        0x6907
+#define IMAGE_TLV_SHA256            0x10
+#define IMAGE_F_ENCRYPTED_AES128    0x04
+#define IMAGE_F_ENCRYPTED_AES256    0x08
+#define TLV_INFO_SIZE               4
+#define SHA256_SIZE                 32
+
+static uint16_t get_u16(const uint8_t *p) {
+    return (uint16_t) (p[0] | (p[1] << 8));
+}
+
+static uint32_t get_u32(const uint8_t *p) {
+    return (uint32_t) p[0] | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+void iotc_ota_image_check_init(IotcOtaImageCheck *c) {
+    memset(c, 0, sizeof(IotcOtaImageCheck));
+    mbedtls_sha256_init(&c->sha);
+    mbedtls_sha256_starts(&c->sha, 0);
+}
+
+void iotc_ota_image_check_free(IotcOtaImageCheck *c) {
+    mbedtls_sha256_free(&c->sha);
+}
+
+// Returns the length of the hashed part of the image, or 0 if the header is not valid
+static uint32_t parse_header(const uint8_t *header, uint32_t image_size, uint32_t *flags) {
+    if (IMAGE_MAGIC != get_u32(&header[0])) {
+        printf("OTA: The artifact is not an MCUboot image!\n");
+        return 0;
+    }
+    uint32_t hdr_size = get_u16(&header[8]);
+    uint32_t protect_tlv_size = get_u16(&header[10]);
+    uint32_t img_size = get_u32(&header[12]);
+    uint32_t hash_len = hdr_size + img_size + protect_tlv_size;
+    *flags = get_u32(&header[16]);
+    if (hdr_size < IOTC_OTA_IMAGE_HEADER_SIZE || hash_len < img_size || hash_len + TLV_INFO_SIZE > image_size) {
+        printf("OTA: The image header describes %lu bytes, but the image is only %lu bytes!\n",
+                (unsigned long) (hash_len + TLV_INFO_SIZE), (unsigned long) image_size);
+        return 0;
+    }
+    return hash_len;
+}
+
+bool iotc_ota_image_check_header(const uint8_t *header, uint32_t image_size) {
+    uint32_t flags;
+    return 0 != parse_header(header, image_size, &flags);
+}
+
+static bool check_header(IotcOtaImageCheck *c, const uint8_t *header, uint32_t image_size) {
+    uint32_t flags;
+    c->hash_len = parse_header(header, image_size, &flags);
+    if (0 == c->hash_len) {
+        return false;
+    }
+    c->is_hash_checked = 0 == (flags & (IMAGE_F_ENCRYPTED_AES128 | IMAGE_F_ENCRYPTED_AES256));
+    c->is_header_checked = true;
+    return true;
+}
+
+bool iotc_ota_image_check_update(IotcOtaImageCheck *c, uint32_t offset, const uint8_t *data, size_t len, uint32_t image_size) {
+    if (0 == offset && (len < IOTC_OTA_IMAGE_HEADER_SIZE || !check_header(c, data, image_size))) {
+        return false;
+    }
+    if (!c->is_hash_checked || offset != c->hashed || c->hashed >= c->hash_len) {
+        return true; // nothing (more) to hash
+    }
+    size_t n = c->hash_len - c->hashed < len ? c->hash_len - c->hashed : len;
+    mbedtls_sha256_update(&c->sha, data, n);
+    c->hashed += (uint32_t) n;
+    return true;
+}
+
+bool iotc_ota_image_check_finish(IotcOtaImageCheck *c, IotcOtaImageRead read, uint32_t image_size) {
+    uint8_t digest[SHA256_SIZE];
+    uint8_t tlv[TLV_INFO_SIZE];
+
+    if (!c->is_header_checked) {
+        return false;
+    }
+    if (!c->is_hash_checked) {
+        return true;
+    }
+    if (c->hashed != c->hash_len) {
+        printf("OTA: Only %lu of %lu image bytes were hashed!\n", (unsigned long) c->hashed, (unsigned long) c->hash_len);
+        return false;
+    }
+    mbedtls_sha256_finish(&c->sha, digest);
+
+    if (0 != read(c->hash_len, tlv, TLV_INFO_SIZE) || IMAGE_TLV_INFO_MAGIC != get_u16(&tlv[0])) {
+        printf("OTA: The image has no TLV area!\n");
+        return false;
+    }
+    uint32_t end = c->hash_len + get_u16(&tlv[2]);
+    if (end > image_size) {
+        printf("OTA: The image TLV area is truncated!\n");
+        return false;
+    }
+    for (uint32_t pos = c->hash_len + TLV_INFO_SIZE; pos + TLV_INFO_SIZE <= end;) {
+        if (0 != read(pos, tlv, TLV_INFO_SIZE)) {
+            return false;
+        }
+        uint16_t type = get_u16(&tlv[0]);
+        uint16_t len = get_u16(&tlv[2]);
+        pos += TLV_INFO_SIZE;
+        if (IMAGE_TLV_SHA256 == type && SHA256_SIZE == len && pos + len <= end) {
+            uint8_t expected[SHA256_SIZE];
+            if (0 != read(pos, expected, SHA256_SIZE)) {
+                return false;
+            }
+            if (0 != memcmp(expected, digest, SHA256_SIZE)) {
+                printf("OTA: The SHA-256 of the written image does not match the image!\n");
+                return false;
+            }
+            return true;
+        }
+        pos += len;
+    }
+    printf("OTA: The image has no SHA-256 TLV!\n");
+    return false;
+}
+
+#endif // IOTC_OTA_SUPPORT
@@ -0,0 +1,55 @@
+/* SPDX-License-Identifier: MIT
+ * Copyright (C) 2025 Avnet
+ * Authors: Nikola Markovic <nikola.markovic@avnet.com> et al.
+ */
+
+#ifndef IOTC_OTA_IMAGE_H
+#define IOTC_OTA_IMAGE_H
+
+// Checks an MCUboot image while it is being written to the slot. The header is checked as soon as it is written,
+// so that an artifact that is not an image, or is too short for the image that its header describes,
+// fails at the first block. The SHA-256 of the image is computed block by block as the image is written,
+// and compared with the SHA-256 TLV of the image once the download completes, instead of finding out at the next boot.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "mbedtls/sha256.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IOTC_OTA_IMAGE_HEADER_SIZE 32
+
+typedef struct {
+    mbedtls_sha256_context sha;
+    bool is_header_checked;
+    bool is_hash_checked;   // false for encrypted images, because the TLV has the hash of the decrypted image
+    uint32_t hash_len;      // header, image and protected TLVs, which are covered by the hash
+    uint32_t hashed;        // bytes hashed so far
+} IotcOtaImageCheck;
+
+// Reads len bytes of the slot at offset. Returns 0 on success.
+typedef int (*IotcOtaImageRead)(uint32_t offset, uint8_t *buf, size_t len);
+
+// Checks the first IOTC_OTA_IMAGE_HEADER_SIZE bytes of an image against the size of the whole image, without hashing.
+// Prints the reason and returns false if they are not a valid MCUboot header for an image of that size.
+bool iotc_ota_image_check_header(const uint8_t *header, uint32_t image_size);
+
+void iotc_ota_image_check_init(IotcOtaImageCheck *c);
+void iotc_ota_image_check_free(IotcOtaImageCheck *c);
+
+// Called for each block in the order in which the image is written, starting at offset 0.
+// The first block must be at least IOTC_OTA_IMAGE_HEADER_SIZE bytes. image_size is the size of the whole download.
+// Returns false if the data is not a valid image.
+bool iotc_ota_image_check_update(IotcOtaImageCheck *c, uint32_t offset, const uint8_t *data, size_t len, uint32_t image_size);
+
+// Called once the whole image is written. Returns false if the hash of the written image does not match its SHA-256 TLV.
+bool iotc_ota_image_check_finish(IotcOtaImageCheck *c, IotcOtaImageRead read, uint32_t image_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IOTC_OTA_IMAGE_H
@@ -0,0 +1,137 @@
+/* SPDX-License-Identifier: MIT
+ * Copyright (C) 2025 Avnet
+ * Authors: Nikola Markovic <nikola.markovic@avnet.com> et al.
+ */
+
+#if defined(IOTC_OTA_SUPPORT) && defined(IOTC_OTA_DIRECT_DOWNLOAD)
+
+#include <string.h>
+
+#include "iotc_ota_lzss.h"
+
+#define STATE_HEADER    0
+#define STATE_ITEM      1   // expecting a flag byte, a literal or the first byte of a match
+#define STATE_MATCH     2   // expecting the second byte of a match
+#define STATE_COPY      3   // outputting a match
+
+#define WINDOW_MASK (IOTC_OTA_LZSS_WINDOW_SIZE - 1)
+#define MIN_MATCH 3
+
+static uint32_t get_u32(const uint8_t *p) {
+    return (uint32_t) p[0] | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+bool iotc_ota_lzss_is_compressed(const uint8_t *data, size_t len) {
+    return len >= 4 && 0 == memcmp(data, IOTC_OTA_LZSS_MAGIC, 4);
+}
+
+uint32_t iotc_ota_lzss_get_target_size(const uint8_t *data, size_t len) {
+    if (len < IOTC_OTA_LZSS_HEADER_SIZE || !iotc_ota_lzss_is_compressed(data, len)) {
+        return 0;
+    }
+    return get_u32(&data[8]);
+}
+
+void iotc_ota_lzss_init(IotcOtaLzss *z) {
+    memset(z, 0, sizeof(IotcOtaLzss));
+    z->state = STATE_HEADER;
+}
+
+static int parse_header(IotcOtaLzss *z) {
+    if (!iotc_ota_lzss_is_compressed(z->buf, IOTC_OTA_LZSS_HEADER_SIZE)
+            || IOTC_OTA_LZSS_VERSION != z->buf[4]
+            || IOTC_OTA_LZSS_WINDOW_BITS != z->buf[5]
+            || IOTC_OTA_LZSS_LENGTH_BITS != z->buf[6]) {
+        return IOTC_OTA_LZSS_ERR_FORMAT;
+    }
+    z->target_size = get_u32(&z->buf[8]);
+    return IOTC_OTA_LZSS_OK;
+}
+
+int iotc_ota_lzss_process(IotcOtaLzss *z, uint8_t *window,
+        const uint8_t *in, size_t in_len, size_t *in_used,
+        uint8_t *out, size_t out_size, size_t *out_len) {
+    size_t ip = 0;
+    size_t op = 0;
+    int ret = IOTC_OTA_LZSS_OK;
+
+    while (op < out_size) {
+        if (STATE_COPY == z->state) {
+            size_t n = z->remaining;
+            if (n > out_size - op) {
+                n = out_size - op;
+            }
+            uint32_t pos = z->produced;
+            for (size_t i = 0; i < n; i++) {
+                uint8_t byte = window[(pos - z->distance) & WINDOW_MASK];
+                window[pos & WINDOW_MASK] = byte;
+                out[op++] = byte;
+                pos++;
+            }
+            z->produced = pos;
+            z->remaining = (uint16_t) (z->remaining - n);
+            if (0 == z->remaining) {
+                z->state = STATE_ITEM;
+            }
+            continue;
+        }
+
+        if (ip >= in_len) {
+            break;
+        }
+        if (STATE_HEADER == z->state) {
+            z->buf[z->have++] = in[ip++];
+            if (IOTC_OTA_LZSS_HEADER_SIZE == z->have) {
+                ret = parse_header(z);
+                if (IOTC_OTA_LZSS_OK != ret) {
+                    break;
+                }
+                z->state = STATE_ITEM;
+            }
+            continue;
+        }
+        if (z->produced >= z->target_size) {
+            ret = IOTC_OTA_LZSS_ERR_FORMAT; // data after the end of the image
+            break;
+        }
+        if (STATE_MATCH == z->state) {
+            uint8_t byte = in[ip++];
+            z->distance = (uint16_t) ((z->distance | ((uint16_t) (byte & 0xf0) << 4)) + 1);
+            z->remaining = (uint16_t) ((byte & 0x0f) + MIN_MATCH);
+            if (z->distance > z->produced || z->remaining > z->target_size - z->produced) {
+                ret = IOTC_OTA_LZSS_ERR_FORMAT;
+                break;
+            }
+            z->state = STATE_COPY;
+            continue;
+        }
+        // STATE_ITEM
+        if (0 == z->items_left) {
+            z->flags = in[ip++];
+            z->items_left = 8;
+            continue;
+        }
+        uint8_t byte = in[ip++];
+        bool is_literal = z->flags & 1;
+        z->flags >>= 1;
+        z->items_left--;
+        if (is_literal) {
+            window[z->produced & WINDOW_MASK] = byte;
+            out[op++] = byte;
+            z->produced++;
+        } else {
+            z->distance = byte;
+            z->state = STATE_MATCH;
+        }
+    }
+
+    *in_used = ip;
+    *out_len = op;
+    return ret;
+}
+
+bool iotc_ota_lzss_is_complete(const IotcOtaLzss *z) {
+    return STATE_ITEM == z->state && z->produced == z->target_size;
+}
+
+#endif // IOTC_OTA_SUPPORT && IOTC_OTA_DIRECT_DOWNLOAD
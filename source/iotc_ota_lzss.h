@@ -0,0 +1,74 @@
+/* SPDX-License-Identifier: MIT
+ * Copyright (C) 2025 Avnet
+ * Authors: Nikola Markovic <nikola.markovic@avnet.com> et al.
+ */
+
+#ifndef IOTC_OTA_LZSS_H
+#define IOTC_OTA_LZSS_H
+
+// Streaming decoder for compressed OTA artifacts, generated with tools/iotc_ota_compress.py.
+// The decoder needs a window buffer of IOTC_OTA_LZSS_WINDOW_SIZE bytes, and no other memory.
+//
+// Header (IOTC_OTA_LZSS_HEADER_SIZE bytes, numbers are little endian):
+//     "IOTZ", version (1 byte), window bits (1), length bits (1), reserved (1), image size (4)
+// Followed by groups of a flag byte and 8 items. Flag bits are used starting with the least significant bit.
+// A bit set to 1 means a literal byte. A bit set to 0 means a match of two bytes:
+//     low 8 bits of (distance - 1), then the high 4 bits of (distance - 1) in the upper nibble and (length - 3)
+//     in the lower nibble. The match repeats <length> bytes that were output <distance> bytes earlier.
+//
+// The state is a plain struct, so that it can be saved to continue an interrupted download. The window is not
+// part of the state, because it is the last IOTC_OTA_LZSS_WINDOW_SIZE bytes of output, which can be read back.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IOTC_OTA_LZSS_MAGIC "IOTZ"
+#define IOTC_OTA_LZSS_VERSION 1
+#define IOTC_OTA_LZSS_HEADER_SIZE 12
+#define IOTC_OTA_LZSS_WINDOW_BITS 12
+#define IOTC_OTA_LZSS_LENGTH_BITS 4
+#define IOTC_OTA_LZSS_WINDOW_SIZE (1 << IOTC_OTA_LZSS_WINDOW_BITS)
+
+#define IOTC_OTA_LZSS_OK 0
+#define IOTC_OTA_LZSS_ERR_FORMAT (-1)
+
+typedef struct {
+    uint8_t state;
+    uint8_t flags;          // of the current group
+    uint8_t items_left;     // in the current group
+    uint8_t have;           // header bytes collected so far
+    uint8_t buf[IOTC_OTA_LZSS_HEADER_SIZE];
+    uint16_t distance;      // of the current match
+    uint16_t remaining;     // bytes of the current match yet to be output
+    uint32_t target_size;
+    uint32_t produced;      // total bytes output so far
+} IotcOtaLzss;
+
+bool iotc_ota_lzss_is_compressed(const uint8_t *data, size_t len);
+
+// Returns the image size from the header at the start of data, or 0 if data does not start with a header
+uint32_t iotc_ota_lzss_get_target_size(const uint8_t *data, size_t len);
+
+void iotc_ota_lzss_init(IotcOtaLzss *z);
+
+// Consumes input and produces output until the input is used up or the output buffer is full.
+// *in_used and *out_len return the number of bytes consumed and produced. The window must be preserved between calls.
+// Call again with the remaining input after the output is flushed. The call may produce output
+// without consuming any input, so keep calling while it produces output.
+int iotc_ota_lzss_process(IotcOtaLzss *z, uint8_t *window,
+        const uint8_t *in, size_t in_len, size_t *in_used,
+        uint8_t *out, size_t out_size, size_t *out_len);
+
+// Returns true if the whole image was produced and the decoder is not in the middle of a match
+bool iotc_ota_lzss_is_complete(const IotcOtaLzss *z);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IOTC_OTA_LZSS_H
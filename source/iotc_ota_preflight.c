@@ -0,0 +1,175 @@
+/* SPDX-License-Identifier: MIT
+ * Copyright (C) 2025 Avnet
+ * Authors: Nikola Markovic <nikola.markovic@avnet.com> et al.
+ */
+
+#ifdef IOTC_OTA_SUPPORT
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <cy_http_client_api.h>
+#include "iotcl.h"
+#include "cy_ota_api.h"
+#include "sysflash/sysflash.h"
+#include "flash_map_backend.h"
+
+#include "iotc_ca_store.h"
+#include "iotc_certs.h"
+#include "iotc_ota_image.h"
+#include "iotc_ota_preflight.h"
+
+#ifndef IOTC_OTA_PREFLIGHT_TIMEOUT_MS
+#define IOTC_OTA_PREFLIGHT_TIMEOUT_MS 10000
+#endif
+
+// The first bytes of the artifact that are requested: the first TAR header block, which also covers the MCUboot header
+#define PREFLIGHT_READ_SIZE 512
+
+// Room for the response headers and PREFLIGHT_READ_SIZE bytes of the artifact
+#ifndef IOTC_OTA_PREFLIGHT_BUFFER_SIZE
+#define IOTC_OTA_PREFLIGHT_BUFFER_SIZE (1024 + PREFLIGHT_READ_SIZE)
+#endif
+
+#define HTTP_SERVER_PORT 443
+
+// A TAR bundle (an OTA agent job with several components) has "ustar" at this offset of its first block
+#define TAR_MAGIC_OFFSET 257
+#define TAR_MAGIC "ustar"
+
+// Returned for the cases where the check cannot tell whether the artifact is usable, so the download goes ahead
+#define PREFLIGHT_UNKNOWN CY_RSLT_SUCCESS
+
+static uint32_t get_slot_size(void) {
+    const struct flash_area *fap;
+    if (0 != flash_area_open(FLASH_AREA_IMAGE_SECONDARY(0), &fap)) {
+        return 0;
+    }
+    uint32_t size = fap->fa_size;
+    flash_area_close(fap);
+    return size;
+}
+
+// Returns the size of the whole artifact from the Content-Range of a 206 response, or 0 if the response does not tell
+static uint32_t get_total_size(cy_http_client_t handle, cy_http_client_response_t *response) {
+    // "bytes 0-511/<total>"
+    cy_http_client_header_t header = {.field = "Content-Range", .field_len = strlen("Content-Range")};
+    (void) cy_http_client_read_header(handle, response, &header, 1);
+    const char *slash = header.value ? memchr(header.value, '/', header.value_len) : NULL;
+    return slash ? (uint32_t) strtoul(slash + 1, NULL, 10) : 0;
+}
+
+static bool is_tar(const uint8_t *data, size_t len) {
+    return len >= TAR_MAGIC_OFFSET + strlen(TAR_MAGIC) && 0 == memcmp(&data[TAR_MAGIC_OFFSET], TAR_MAGIC, strlen(TAR_MAGIC));
+}
+
+static cy_rslt_t check_image(uint32_t total_size, const uint8_t *data, size_t len) {
+    if (0 == total_size) {
+        printf("OTA: The server did not report the artifact size. Skipping the preflight check.\n");
+        return PREFLIGHT_UNKNOWN;
+    }
+    if (is_tar(data, len)) {
+        return PREFLIGHT_UNKNOWN; // the OTA agent unpacks the components of a bundle, so it is not a single image
+    }
+    uint32_t slot_size = get_slot_size();
+    if (0 == slot_size) {
+        printf("OTA: Failed to open the secondary slot!\n");
+        return CY_RSLT_OTA_ERROR_OPEN_STORAGE;
+    }
+    if (total_size > slot_size) {
+        printf("OTA: The image size %lu does not fit the slot size %lu!\n",
+                (unsigned long) total_size, (unsigned long) slot_size);
+        return CY_RSLT_OTA_ERROR_WRITE_STORAGE;
+    }
+    if (len < IOTC_OTA_IMAGE_HEADER_SIZE || !iotc_ota_image_check_header(data, total_size)) {
+        return CY_RSLT_OTA_ERROR_VERIFY;
+    }
+    return CY_RSLT_SUCCESS;
+}
+
+static cy_rslt_t request_header(cy_http_client_t handle, const char *path, uint8_t *buffer) {
+    cy_http_client_request_header_t request = {0};
+    cy_http_client_response_t response;
+    request.buffer = buffer;
+    request.buffer_len = IOTC_OTA_PREFLIGHT_BUFFER_SIZE;
+    request.method = CY_HTTP_CLIENT_METHOD_GET;
+    request.resource_path = path;
+    request.range_start = 0;
+    request.range_end = PREFLIGHT_READ_SIZE - 1;
+
+    cy_rslt_t res = cy_http_client_write_header(handle, &request, NULL, 0);
+    if (CY_RSLT_SUCCESS == res) {
+        res = cy_http_client_send(handle, &request, NULL, 0, &response);
+    }
+    if (CY_RSLT_SUCCESS != res) {
+        printf("OTA: Request for the image header failed. Error=0x%08x. Skipping the preflight check.\n", (unsigned int) res);
+        return PREFLIGHT_UNKNOWN;
+    }
+    if (206 != response.status_code) {
+        // A server that ignores the range answers 200 with the whole artifact, and only the start of it fits into
+        // the buffer, so the response is not used. The connection is closed before the rest is received.
+        printf("OTA: HTTP status %d for the image header. Skipping the preflight check.\n", (int) response.status_code);
+        return PREFLIGHT_UNKNOWN;
+    }
+    return check_image(get_total_size(handle, &response), response.body, response.body_len);
+}
+
+cy_rslt_t iotc_ota_preflight(IotConnectConnectionType connection_type, const char *host, const char *path) {
+    cy_awsport_ssl_credentials_t credentials;
+    cy_awsport_server_info_t server_info;
+    cy_http_client_t handle;
+    cy_rslt_t res;
+
+    memset(&credentials, 0, sizeof(credentials));
+    memset(&server_info, 0, sizeof(server_info));
+    server_info.host_name = host;
+    server_info.port = HTTP_SERVER_PORT;
+
+    if (!iotc_ca_store_lend(connection_type)) {
+        size_t root_ca_size = 0;
+        credentials.root_ca = iotc_certs_get_root(connection_type, &root_ca_size);
+        if (!credentials.root_ca) {
+            printf("Error: OTA Connection Type invalid!\n");
+            return CY_RSLT_OTA_ERROR_BADARG;
+        }
+        credentials.root_ca_size = root_ca_size;
+    } // else leave root_ca NULL and verify against the pre-parsed roots in the TLS layer
+    credentials.root_ca_verify_mode = CY_AWS_ROOTCA_VERIFY_REQUIRED;
+    credentials.sni_host_name = host;
+    credentials.sni_host_name_size = strlen(host) + 1; // needs to include the null
+
+    uint8_t *buffer = iotcl_malloc(IOTC_OTA_PREFLIGHT_BUFFER_SIZE);
+    if (!buffer) {
+        printf("OTA: Failed to allocate the preflight buffer. Skipping the preflight check.\n");
+        return PREFLIGHT_UNKNOWN;
+    }
+    if (CY_RSLT_SUCCESS != cy_http_client_init()) {
+        printf("OTA: Failed to init the http client. Skipping the preflight check.\n");
+        iotcl_free(buffer);
+        return PREFLIGHT_UNKNOWN;
+    }
+    if (CY_RSLT_SUCCESS != cy_http_client_create(&credentials, &server_info, NULL, NULL, &handle)) {
+        printf("OTA: Failed to create the http client. Skipping the preflight check.\n");
+        (void) cy_http_client_deinit();
+        iotcl_free(buffer);
+        return PREFLIGHT_UNKNOWN;
+    }
+
+    res = cy_http_client_connect(handle, IOTC_OTA_PREFLIGHT_TIMEOUT_MS, IOTC_OTA_PREFLIGHT_TIMEOUT_MS);
+    if (CY_RSLT_SUCCESS != res) {
+        // the agent retries the connection on its own, so let it try
+        printf("OTA: Failed to connect to the server. Error=0x%08x. Skipping the preflight check.\n", (unsigned int) res);
+        res = PREFLIGHT_UNKNOWN;
+    } else {
+        res = request_header(handle, path, buffer);
+        (void) cy_http_client_disconnect(handle);
+    }
+
+    (void) cy_http_client_delete(handle);
+    (void) cy_http_client_deinit();
+    iotcl_free(buffer);
+    return res;
+}
+
+#endif // IOTC_OTA_SUPPORT
@@ -0,0 +1,28 @@
+/* SPDX-License-Identifier: MIT
+ * Copyright (C) 2025 Avnet
+ * Authors: Nikola Markovic <nikola.markovic@avnet.com> et al.
+ */
+
+#ifndef IOTC_OTA_PREFLIGHT_H
+#define IOTC_OTA_PREFLIGHT_H
+
+#include "cy_result.h"
+#include "iotconnect.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Requests only the first bytes of the OTA artifact to learn its size and read its MCUboot header,
+// and checks them against the capacity of the secondary slot before the OTA agent starts the download.
+// Returns CY_RSLT_OTA_ERROR_WRITE_STORAGE if the image does not fit the slot, or CY_RSLT_OTA_ERROR_VERIFY if the artifact
+// is not an MCUboot image or is shorter than its header says.
+// Returns CY_RSLT_SUCCESS if the artifact cannot be checked, so that the download goes ahead: TAR bundles,
+// network or HTTP client errors, servers that ignore the range request, and responses without the artifact size.
+cy_rslt_t iotc_ota_preflight(IotConnectConnectionType connection_type, const char *host, const char *path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IOTC_OTA_PREFLIGHT_H
@@ -0,0 +1,111 @@
+/* SPDX-License-Identifier: MIT
+ * Copyright (C) 2025 Avnet
+ * Authors: Nikola Markovic <nikola.markovic@avnet.com> et al.
+ */
+
+#ifdef IOTC_OTA_SUPPORT
+
+#include <stdio.h>
+#include <string.h>
+
+#include "iotc_ota.h"
+#include "iotc_ota_stats.h"
+
+// Minimum time between two progress lines. Printing every block slows the download down.
+#ifndef IOTC_OTA_PROGRESS_INTERVAL_MS
+#define IOTC_OTA_PROGRESS_INTERVAL_MS 2000
+#endif
+
+// A wait for data that takes longer than this counts as a stall
+#ifndef IOTC_OTA_STALL_MS
+#define IOTC_OTA_STALL_MS 2000
+#endif
+
+static IotcOtaStats stats = {0};
+static cy_time_t start_time = 0;
+static cy_time_t last_progress_time = 0;
+static bool is_running = false;
+
+cy_time_t iotc_ota_stats_now(void) {
+    cy_time_t now = 0;
+    (void) cy_rtos_get_time(&now);
+    return now;
+}
+
+void iotc_ota_stats_reset(void) {
+    memset(&stats, 0, sizeof(stats));
+    start_time = iotc_ota_stats_now();
+    last_progress_time = start_time;
+    is_running = true;
+}
+
+cy_time_t iotc_ota_stats_add(IotcOtaPhase phase, cy_time_t start) {
+    cy_time_t now = iotc_ota_stats_now();
+    cy_time_t elapsed = now - start;
+    switch (phase) {
+        case IOTC_OTA_PHASE_CONNECT:
+            stats.connect_ms += elapsed;
+            break;
+        case IOTC_OTA_PHASE_DOWNLOAD:
+            stats.download_ms += elapsed;
+            if (elapsed > IOTC_OTA_STALL_MS) {
+                stats.stalls++;
+            }
+            break;
+        case IOTC_OTA_PHASE_WRITE:
+            stats.write_ms += elapsed;
+            break;
+        case IOTC_OTA_PHASE_VERIFY:
+            stats.verify_ms += elapsed;
+            break;
+        case IOTC_OTA_PHASE_THROTTLE:
+            stats.throttle_ms += elapsed;
+            break;
+    }
+    return now;
+}
+
+void iotc_ota_stats_add_bytes(uint32_t bytes) {
+    stats.bytes += bytes;
+}
+
+void iotc_ota_stats_add_retry(void) {
+    stats.retries++;
+}
+
+bool iotc_ota_stats_is_progress_due(uint32_t done, uint32_t total) {
+    cy_time_t now = iotc_ota_stats_now();
+    if (done < total && now - last_progress_time < IOTC_OTA_PROGRESS_INTERVAL_MS) {
+        return false;
+    }
+    last_progress_time = now;
+    return true;
+}
+
+static void update_totals(IotcOtaStats *s) {
+    s->total_ms = iotc_ota_stats_now() - start_time;
+    s->bytes_per_second = s->total_ms ? (uint32_t) ((uint64_t) s->bytes * 1000 / s->total_ms) : 0;
+}
+
+void iotc_ota_stats_finish(void) {
+    if (!is_running) {
+        return;
+    }
+    is_running = false;
+    update_totals(&stats);
+    printf("OTA: %lu bytes in %lu ms (%lu bytes/s). Connect %lu ms, download %lu ms, write %lu ms, verify %lu ms, throttle %lu ms."
+            " Stalls: %u. Retries: %u.\n",
+            (unsigned long) stats.bytes, (unsigned long) stats.total_ms, (unsigned long) stats.bytes_per_second,
+            (unsigned long) stats.connect_ms, (unsigned long) stats.download_ms,
+            (unsigned long) stats.write_ms, (unsigned long) stats.verify_ms, (unsigned long) stats.throttle_ms,
+            stats.stalls, stats.retries);
+}
+
+void iotc_ota_get_download_stats(IotcOtaStats *s) {
+    memcpy(s, &stats, sizeof(IotcOtaStats));
+    if (is_running) {
+        update_totals(s);
+    }
+}
+
+#endif // IOTC_OTA_SUPPORT
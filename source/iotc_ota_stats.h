@@ -0,0 +1,51 @@
+/* SPDX-License-Identifier: MIT
+ * Copyright (C) 2025 Avnet
+ * Authors: Nikola Markovic <nikola.markovic@avnet.com> et al.
+ */
+
+#ifndef IOTC_OTA_STATS_H
+#define IOTC_OTA_STATS_H
+
+// Collects the IotcOtaStats of the current download for iotc_ota_get_download_stats().
+// Used by both the OTA agent path in iotc_ota.c and the direct download.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "cyabs_rtos.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    IOTC_OTA_PHASE_CONNECT,
+    IOTC_OTA_PHASE_DOWNLOAD,
+    IOTC_OTA_PHASE_WRITE,
+    IOTC_OTA_PHASE_VERIFY,
+    IOTC_OTA_PHASE_THROTTLE
+} IotcOtaPhase;
+
+// Called when a download starts
+void iotc_ota_stats_reset(void);
+
+cy_time_t iotc_ota_stats_now(void);
+
+// Adds the time since start to the phase, and returns the current time.
+// A download phase that takes longer than IOTC_OTA_STALL_MS counts as a stall.
+cy_time_t iotc_ota_stats_add(IotcOtaPhase phase, cy_time_t start);
+
+void iotc_ota_stats_add_bytes(uint32_t bytes);
+void iotc_ota_stats_add_retry(void);
+
+// Returns true if the progress should be printed, which is at most once per IOTC_OTA_PROGRESS_INTERVAL_MS
+// and once the download is done
+bool iotc_ota_stats_is_progress_due(uint32_t done, uint32_t total);
+
+// Called when the download ends. Computes the totals and prints them. Does nothing if the download already ended.
+void iotc_ota_stats_finish(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IOTC_OTA_STATS_H
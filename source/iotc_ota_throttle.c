@@ -0,0 +1,100 @@
+/* SPDX-License-Identifier: MIT
+ * Copyright (C) 2025 Avnet
+ * Authors: Nikola Markovic <nikola.markovic@avnet.com> et al.
+ */
+
+#ifdef IOTC_OTA_SUPPORT
+
+#include <stdio.h>
+
+#include "cyabs_rtos.h"
+
+#include "iotc_mqtt_client.h"
+#include "iotc_telemetry_aggregator.h"
+#include "iotc_ota.h"
+#include "iotc_ota_stats.h"
+#include "iotc_ota_throttle.h"
+
+// Default download rate limit in bytes per second. 0 means no limit. See iotc_ota_set_rate_limit().
+#ifndef IOTC_OTA_RATE_LIMIT
+#define IOTC_OTA_RATE_LIMIT 0
+#endif
+
+// Bytes that can be downloaded at full speed after the download was idle, before the rate limit applies
+#ifndef IOTC_OTA_RATE_BURST
+#define IOTC_OTA_RATE_BURST 8192
+#endif
+
+// The download waits until no publish was made for this long, so that it does not delay acknowledgements.
+// 0 disables the wait.
+#ifndef IOTC_OTA_PUBLISH_QUIET_MS
+#define IOTC_OTA_PUBLISH_QUIET_MS 100
+#endif
+
+// Longest wait for publishes before each block, so that an application that publishes all the time
+// does not stop the download
+#ifndef IOTC_OTA_PUBLISH_PAUSE_MAX_MS
+#define IOTC_OTA_PUBLISH_PAUSE_MAX_MS 2000
+#endif
+
+#define PUBLISH_POLL_MS 20
+
+static uint32_t rate_limit = IOTC_OTA_RATE_LIMIT;
+static IotcOtaBurstCallback burst_cb = NULL;
+static int32_t tokens = 0; // bytes that can be downloaded without waiting. Negative while catching up.
+static cy_time_t refill_time = 0;
+
+void iotc_ota_set_rate_limit(uint32_t bytes_per_second) {
+    rate_limit = bytes_per_second;
+}
+
+void iotc_ota_set_burst_callback(IotcOtaBurstCallback cb) {
+    burst_cb = cb;
+}
+
+static void refill(void) {
+    cy_time_t now = iotc_ota_stats_now();
+    uint64_t earned = (uint64_t) (now - refill_time) * rate_limit / 1000;
+    if (0 == earned) {
+        return; // keep the fraction of a byte for the next refill
+    }
+    refill_time = now;
+    int64_t sum = (int64_t) tokens + (int64_t) earned;
+    tokens = sum > IOTC_OTA_RATE_BURST ? IOTC_OTA_RATE_BURST : (int32_t) sum;
+}
+
+static void wait_for_publishes(void) {
+#if IOTC_OTA_PUBLISH_QUIET_MS > 0
+    for (uint32_t waited = 0;
+            waited < IOTC_OTA_PUBLISH_PAUSE_MAX_MS && iotc_mqtt_client_is_publish_recent(IOTC_OTA_PUBLISH_QUIET_MS);
+            waited += PUBLISH_POLL_MS) {
+        (void) cy_rtos_delay_milliseconds(PUBLISH_POLL_MS);
+    }
+#endif
+}
+
+void iotc_ota_throttle_start(void) {
+    if (burst_cb) {
+        burst_cb();
+    } else if (iotc_mqtt_client_is_connected()) {
+        (void) iotc_telemetry_aggregator_send(NULL);
+    }
+    tokens = IOTC_OTA_RATE_BURST;
+    refill_time = iotc_ota_stats_now();
+}
+
+void iotc_ota_throttle_wait(uint32_t len) {
+    cy_time_t start_time = iotc_ota_stats_now();
+    wait_for_publishes();
+    if (rate_limit > 0) {
+        refill();
+        tokens -= (int32_t) len;
+        if (tokens < 0) {
+            (void) cy_rtos_delay_milliseconds((cy_time_t) ((uint64_t) -tokens * 1000 / rate_limit));
+            refill();
+        }
+    }
+    (void) iotc_ota_stats_add(IOTC_OTA_PHASE_THROTTLE, start_time);
+}
+
+#endif // IOTC_OTA_SUPPORT
@@ -0,0 +1,32 @@
+/* SPDX-License-Identifier: MIT
+ * Copyright (C) 2025 Avnet
+ * Authors: Nikola Markovic <nikola.markovic@avnet.com> et al.
+ */
+
+#ifndef IOTC_OTA_THROTTLE_H
+#define IOTC_OTA_THROTTLE_H
+
+// Keeps an OTA download from starving MQTT of the link and of lwIP buffers.
+// The download is limited to iotc_ota_set_rate_limit() bytes per second with a token bucket,
+// and waits while a publish is waiting for its acknowledgement. Used by both the OTA agent path
+// in iotc_ota.c and the direct download.
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Called when a download starts. Sends the batched telemetry first, so that it does not have to compete
+// with the download (see iotc_ota_set_burst_callback()), and fills the token bucket.
+void iotc_ota_throttle_start(void);
+
+// Called for each block of len bytes, before it is requested or after it was received.
+// Returns once the block fits the rate limit and no publish is in progress.
+void iotc_ota_throttle_wait(uint32_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IOTC_OTA_THROTTLE_H
@@ -0,0 +1,408 @@
+/* SPDX-License-Identifier: MIT
+ * Copyright (C) 2025 Avnet
+ * Authors: Nikola Markovic <nikola.markovic@avnet.com> et al.
+ */
+
+#include <string.h>
+#include <stdio.h>
+
+#include "cyabs_rtos.h"
+
+#include "iotcl.h"
+#include "iotc_json_mem.h"
+#include "iotc_kvstore.h"
+#include "iotc_telemetry_writer.h"
+#include "iotc_property_cache.h"
+
+// The saved state is: {"v":<version>,"p":{<name>:<value>,...},"c":[<names of properties not yet reported>]}
+#define PERSIST_VERSION "v"
+#define PERSIST_PROPERTIES "p"
+#define PERSIST_CHANGED "c"
+
+typedef struct {
+    char *name; // NULL if the entry is free
+    IotcPropertyValue value; // strings are owned by the entry
+    bool is_changed;
+} PropertyEntry;
+
+static PropertyEntry entries[IOTC_PROPERTY_CACHE_SIZE];
+static uint32_t cache_version = 0;
+static IotcPropertyChangeCallback on_change = NULL;
+static cy_mutex_t lock;
+static bool is_initialized = false;
+
+static void free_value(IotcPropertyValue *v) {
+    if (IOTC_PT_STRING == v->type) {
+        iotcl_free((char *) v->u.string);
+    }
+    v->type = IOTC_PT_NULL;
+}
+
+static bool is_equal(const IotcPropertyValue *a, const IotcPropertyValue *b) {
+    if (a->type != b->type) {
+        return false;
+    }
+    switch (a->type) {
+        case IOTC_PT_NUMBER:
+            return a->u.number == b->u.number;
+        case IOTC_PT_BOOL:
+            return a->u.boolean == b->u.boolean;
+        case IOTC_PT_STRING:
+            return 0 == strcmp(a->u.string, b->u.string);
+        case IOTC_PT_NULL:
+        default:
+            return true;
+    }
+}
+
+static PropertyEntry *find_entry(const char *name) {
+    for (int i = 0; i < IOTC_PROPERTY_CACHE_SIZE; i++) {
+        if (entries[i].name && 0 == strcmp(entries[i].name, name)) {
+            return &entries[i];
+        }
+    }
+    return NULL;
+}
+
+// Must be called with the lock held. Returns IOTCL_SUCCESS and sets *is_changed if the value differs.
+static int update_entry(const char *name, const IotcPropertyValue *value, bool *is_changed) {
+    PropertyEntry *e = find_entry(name);
+    *is_changed = false;
+    if (e && is_equal(&e->value, value)) {
+        return IOTCL_SUCCESS;
+    }
+    if (!e) {
+        for (int i = 0; i < IOTC_PROPERTY_CACHE_SIZE; i++) {
+            if (!entries[i].name) {
+                e = &entries[i];
+                break;
+            }
+        }
+        if (!e) {
+            printf("IOTC: Property cache is full. Increase IOTC_PROPERTY_CACHE_SIZE.\n");
+            return IOTCL_ERR_OUT_OF_MEMORY;
+        }
+        e->name = iotcl_strdup(name);
+        if (!e->name) {
+            return IOTCL_ERR_OUT_OF_MEMORY;
+        }
+        e->value.type = IOTC_PT_NULL;
+    }
+
+    IotcPropertyValue new_value = *value;
+    if (IOTC_PT_STRING == value->type) {
+        new_value.u.string = iotcl_strdup(value->u.string);
+        if (!new_value.u.string) {
+            return IOTCL_ERR_OUT_OF_MEMORY;
+        }
+    }
+    free_value(&e->value);
+    e->value = new_value;
+    e->is_changed = true;
+    *is_changed = true;
+    return IOTCL_SUCCESS;
+}
+
+static bool value_from_json(const cJSON *item, IotcPropertyValue *value) {
+    if (cJSON_IsNumber(item)) {
+        value->type = IOTC_PT_NUMBER;
+        value->u.number = item->valuedouble;
+    } else if (cJSON_IsBool(item)) {
+        value->type = IOTC_PT_BOOL;
+        value->u.boolean = cJSON_IsTrue(item);
+    } else if (cJSON_IsString(item)) {
+        value->type = IOTC_PT_STRING;
+        value->u.string = item->valuestring;
+    } else if (cJSON_IsNull(item)) {
+        value->type = IOTC_PT_NULL;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static void value_to_json(cJSON *object, const char *name, const IotcPropertyValue *value) {
+    switch (value->type) {
+        case IOTC_PT_NUMBER:
+            cJSON_AddNumberToObject(object, name, value->u.number);
+            break;
+        case IOTC_PT_BOOL:
+            cJSON_AddBoolToObject(object, name, value->u.boolean);
+            break;
+        case IOTC_PT_STRING:
+            cJSON_AddStringToObject(object, name, value->u.string);
+            break;
+        case IOTC_PT_NULL:
+        default:
+            cJSON_AddNullToObject(object, name);
+            break;
+    }
+}
+
+// Must be called with the lock held
+static void save_state(void) {
+    if (!iotc_kvstore_is_available()) {
+        return;
+    }
+    cJSON *root = cJSON_CreateObject();
+    if (!root) {
+        return;
+    }
+    cJSON_AddNumberToObject(root, PERSIST_VERSION, (double) cache_version);
+    cJSON *properties = cJSON_AddObjectToObject(root, PERSIST_PROPERTIES);
+    cJSON *changed = cJSON_AddArrayToObject(root, PERSIST_CHANGED);
+    for (int i = 0; properties && changed && i < IOTC_PROPERTY_CACHE_SIZE; i++) {
+        const PropertyEntry *e = &entries[i];
+        if (!e->name) {
+            continue;
+        }
+        value_to_json(properties, e->name, &e->value);
+        if (e->is_changed) {
+            cJSON_AddItemToArray(changed, cJSON_CreateString(e->name));
+        }
+    }
+    char *json = iotc_json_mem_print(root);
+    cJSON_Delete(root);
+    if (!json) {
+        printf("IOTC: Out of memory while saving the property cache!\n");
+        return;
+    }
+    size_t json_size = strlen(json) + 1;
+    if (json_size > IOTC_PROPERTY_CACHE_PERSIST_MAX) {
+        printf("IOTC: Property cache state of %u bytes is larger than IOTC_PROPERTY_CACHE_PERSIST_MAX!\n", (unsigned int) json_size);
+    } else if (0 != iotc_kvstore_write(IOTC_PROPERTY_CACHE_KV_KEY, json, json_size)) {
+        printf("IOTC: Failed to save the property cache!\n");
+    }
+    iotc_json_mem_free_print(json);
+}
+
+static void load_state(void) {
+    char *json = iotcl_malloc(IOTC_PROPERTY_CACHE_PERSIST_MAX);
+    if (!json) {
+        return;
+    }
+    int len = iotc_kvstore_read(IOTC_PROPERTY_CACHE_KV_KEY, json, IOTC_PROPERTY_CACHE_PERSIST_MAX);
+    cJSON *root = len > 0 ? cJSON_ParseWithLength(json, (size_t) len) : NULL;
+    iotcl_free(json);
+    if (!root) {
+        return; // nothing saved yet, or the saved state is not usable
+    }
+
+    const cJSON *version = cJSON_GetObjectItemCaseSensitive(root, PERSIST_VERSION);
+    const cJSON *properties = cJSON_GetObjectItemCaseSensitive(root, PERSIST_PROPERTIES);
+    const cJSON *changed = cJSON_GetObjectItemCaseSensitive(root, PERSIST_CHANGED);
+    const cJSON *item;
+    if (cJSON_IsNumber(version)) {
+        cache_version = (uint32_t) version->valuedouble;
+    }
+    cJSON_ArrayForEach(item, properties) {
+        IotcPropertyValue value;
+        bool is_changed;
+        if (value_from_json(item, &value)) {
+            (void) update_entry(item->string, &value, &is_changed);
+        }
+    }
+    // everything that was loaded was reported already, except for the properties listed as changed
+    for (int i = 0; i < IOTC_PROPERTY_CACHE_SIZE; i++) {
+        entries[i].is_changed = false;
+    }
+    cJSON_ArrayForEach(item, changed) {
+        PropertyEntry *e = cJSON_IsString(item) ? find_entry(item->valuestring) : NULL;
+        if (e) {
+            e->is_changed = true;
+        }
+    }
+    cJSON_Delete(root);
+}
+
+int iotc_property_cache_init(IotcPropertyChangeCallback change_cb) {
+    iotc_property_cache_deinit();
+    if (CY_RSLT_SUCCESS != cy_rtos_init_mutex(&lock)) {
+        printf("IOTC: Failed to create the property cache mutex!\n");
+        return IOTCL_ERR_FAILED;
+    }
+    is_initialized = true;
+    on_change = change_cb;
+    load_state();
+    return IOTCL_SUCCESS;
+}
+
+void iotc_property_cache_deinit(void) {
+    if (!is_initialized) {
+        return;
+    }
+    for (int i = 0; i < IOTC_PROPERTY_CACHE_SIZE; i++) {
+        free_value(&entries[i].value);
+        iotcl_free(entries[i].name);
+    }
+    memset(entries, 0, sizeof(entries));
+    cache_version = 0;
+    on_change = NULL;
+    cy_rtos_deinit_mutex(&lock);
+    is_initialized = false;
+}
+
+static int set_value(const char *name, const IotcPropertyValue *value) {
+    bool is_changed;
+    if (!is_initialized || !name) {
+        return IOTCL_ERR_BAD_VALUE;
+    }
+    cy_rtos_get_mutex(&lock, CY_RTOS_NEVER_TIMEOUT);
+    int status = update_entry(name, value, &is_changed);
+    if (is_changed) {
+        save_state();
+    }
+    cy_rtos_set_mutex(&lock);
+    return status;
+}
+
+int iotc_property_cache_set_number(const char *name, double value) {
+    IotcPropertyValue v = {.type = IOTC_PT_NUMBER, .u.number = value};
+    return set_value(name, &v);
+}
+
+int iotc_property_cache_set_bool(const char *name, bool value) {
+    IotcPropertyValue v = {.type = IOTC_PT_BOOL, .u.boolean = value};
+    return set_value(name, &v);
+}
+
+int iotc_property_cache_set_string(const char *name, const char *value) {
+    IotcPropertyValue v = {.type = IOTC_PT_NULL};
+    if (value) {
+        v.type = IOTC_PT_STRING;
+        v.u.string = value;
+    }
+    return set_value(name, &v);
+}
+
+int iotc_property_cache_get(const char *name, IotcPropertyValue *value, char *buffer, size_t buffer_size) {
+    int status = IOTCL_SUCCESS;
+    if (!is_initialized || !name || !value) {
+        return IOTCL_ERR_BAD_VALUE;
+    }
+    cy_rtos_get_mutex(&lock, CY_RTOS_NEVER_TIMEOUT);
+    const PropertyEntry *e = find_entry(name);
+    if (!e) {
+        status = IOTCL_ERR_MISSING_VALUE;
+    } else if (IOTC_PT_STRING == e->value.type) {
+        // the cached string is freed when the property changes, so the caller gets a copy
+        size_t size = strlen(e->value.u.string) + 1;
+        if (!buffer || size > buffer_size) {
+            status = IOTCL_ERR_OUT_OF_MEMORY;
+        } else {
+            memcpy(buffer, e->value.u.string, size);
+            value->type = IOTC_PT_STRING;
+            value->u.string = buffer;
+        }
+    } else {
+        *value = e->value;
+    }
+    cy_rtos_set_mutex(&lock);
+    return status;
+}
+
+int iotc_property_cache_apply_delta(const cJSON *delta, uint32_t version) {
+    const cJSON *item;
+    int status = IOTCL_SUCCESS;
+
+    if (!is_initialized || !cJSON_IsObject(delta)) {
+        return IOTCL_ERR_BAD_VALUE;
+    }
+    // hold the lock from the version check until the new version is stored, so that two deltas cannot both pass
+    // the check. The mutex is recursive, so change_cb can still use the cache.
+    cy_rtos_get_mutex(&lock, CY_RTOS_NEVER_TIMEOUT);
+    if (version != 0 && version <= cache_version) {
+        printf("IOTC: Ignoring property delta version %lu. Current version is %lu.\n",
+                (unsigned long) version, (unsigned long) cache_version);
+        cy_rtos_set_mutex(&lock);
+        return IOTCL_SUCCESS;
+    }
+
+    cJSON_ArrayForEach(item, delta) {
+        IotcPropertyValue value;
+        bool is_changed = false;
+        if (!value_from_json(item, &value)) {
+            printf("IOTC: Property \"%s\" is not a number, bool, string or null. Ignoring it.\n", item->string);
+            continue;
+        }
+        int update_status = update_entry(item->string, &value, &is_changed);
+        if (update_status) {
+            status = update_status;
+        } else if (is_changed && on_change) {
+            on_change(item->string, &value);
+        }
+    }
+
+    if (version != 0) {
+        cache_version = version;
+    }
+    save_state();
+    cy_rtos_set_mutex(&lock);
+    return status;
+}
+
+uint32_t iotc_property_cache_get_version(void) {
+    return cache_version;
+}
+
+size_t iotc_property_cache_get_changed_count(void) {
+    size_t count = 0;
+    if (!is_initialized) {
+        return 0;
+    }
+    cy_rtos_get_mutex(&lock, CY_RTOS_NEVER_TIMEOUT);
+    for (int i = 0; i < IOTC_PROPERTY_CACHE_SIZE; i++) {
+        if (entries[i].name && entries[i].is_changed) {
+            count++;
+        }
+    }
+    cy_rtos_set_mutex(&lock);
+    return count;
+}
+
+int iotc_property_cache_report(const char *iso_time) {
+    IotcTelemetryWriter w;
+    if (!is_initialized) {
+        return IOTCL_ERR_BAD_VALUE;
+    }
+    if (0 == iotc_property_cache_get_changed_count()) {
+        return IOTCL_SUCCESS;
+    }
+    int status = iotc_telemetry_writer_begin(&w, NULL, 0, iso_time);
+    if (status) {
+        return status;
+    }
+
+    // hold the lock until the flags are cleared, so that a change made while sending is not lost
+    cy_rtos_get_mutex(&lock, CY_RTOS_NEVER_TIMEOUT);
+    for (int i = 0; i < IOTC_PROPERTY_CACHE_SIZE; i++) {
+        const PropertyEntry *e = &entries[i];
+        if (!e->name || !e->is_changed) {
+            continue;
+        }
+        switch (e->value.type) {
+            case IOTC_PT_NUMBER:
+                iotc_telemetry_writer_add_number(&w, e->name, e->value.u.number);
+                break;
+            case IOTC_PT_BOOL:
+                iotc_telemetry_writer_add_bool(&w, e->name, e->value.u.boolean);
+                break;
+            case IOTC_PT_STRING:
+                iotc_telemetry_writer_add_string(&w, e->name, e->value.u.string);
+                break;
+            case IOTC_PT_NULL:
+            default:
+                iotc_telemetry_writer_add_null(&w, e->name);
+                break;
+        }
+    }
+    status = iotc_telemetry_writer_send(&w);
+    if (IOTCL_SUCCESS == status) {
+        for (int i = 0; i < IOTC_PROPERTY_CACHE_SIZE; i++) {
+            entries[i].is_changed = false;
+        }
+        save_state();
+    }
+    cy_rtos_set_mutex(&lock);
+    return status;
+}
@@ -0,0 +1,189 @@
+/* SPDX-License-Identifier: MIT
+ * Copyright (C) 2025 Avnet
+ * Authors: Nikola Markovic <nikola.markovic@avnet.com> et al.
+ */
+
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "cyabs_rtos.h"
+
+#include "iotcl.h"
+#include "iotc_telemetry_aggregator.h"
+
+typedef struct {
+    uint32_t count;
+    double min;
+    double max;
+    double mean; // updated incrementally with each sample, which does not lose precision the way a large running sum would
+} Accumulator;
+
+typedef struct {
+    const char *name;
+    Accumulator acc;
+} AggregatorEntry;
+
+static AggregatorEntry entries[IOTC_TELEMETRY_AGGREGATOR_SIZE];
+static int entry_count = 0;
+static uint32_t window_length_ms = 0;
+static cy_time_t window_start = 0;
+
+// The window taken by the last iotc_telemetry_aggregator_write(), kept for iotc_telemetry_aggregator_restore()
+static Accumulator written[IOTC_TELEMETRY_AGGREGATOR_SIZE];
+static int written_count = 0;
+
+static cy_time_t get_time(void) {
+    cy_time_t now = 0;
+    (void) cy_rtos_get_time(&now);
+    return now;
+}
+
+void iotc_telemetry_aggregator_init(uint32_t window_ms) {
+    taskENTER_CRITICAL();
+    memset(entries, 0, sizeof(entries));
+    entry_count = 0;
+    window_length_ms = window_ms;
+    window_start = get_time();
+    taskEXIT_CRITICAL();
+    written_count = 0;
+}
+
+int iotc_telemetry_aggregator_add_attribute(const char *name) {
+    int status = IOTCL_SUCCESS;
+    if (!name) {
+        return IOTCL_ERR_BAD_VALUE;
+    }
+    taskENTER_CRITICAL();
+    if (entry_count >= IOTC_TELEMETRY_AGGREGATOR_SIZE) {
+        status = IOTCL_ERR_OUT_OF_MEMORY;
+    } else {
+        AggregatorEntry *e = &entries[entry_count];
+        memset(e, 0, sizeof(AggregatorEntry));
+        e->name = name;
+        entry_count++;
+    }
+    taskEXIT_CRITICAL();
+    if (status) {
+        printf("IOTC: Telemetry aggregator is full. Increase IOTC_TELEMETRY_AGGREGATOR_SIZE.\n");
+    }
+    return status;
+}
+
+int iotc_telemetry_aggregator_sample(const char *name, double value) {
+    AggregatorEntry *e = NULL;
+    if (!name || isnan(value)) {
+        return IOTCL_ERR_BAD_VALUE;
+    }
+    // entries are only appended, and the name never changes once added, so the lookup does not need the lock
+    for (int i = 0; i < entry_count; i++) {
+        if (0 == strcmp(entries[i].name, name)) {
+            e = &entries[i];
+            break;
+        }
+    }
+    if (!e) {
+        return IOTCL_ERR_BAD_VALUE;
+    }
+
+    taskENTER_CRITICAL();
+    Accumulator *a = &e->acc;
+    a->count++;
+    if (1 == a->count) {
+        a->min = value;
+        a->max = value;
+        a->mean = value;
+    } else {
+        if (value < a->min) {
+            a->min = value;
+        }
+        if (value > a->max) {
+            a->max = value;
+        }
+        a->mean += (value - a->mean) / (double) a->count;
+    }
+    taskEXIT_CRITICAL();
+    return IOTCL_SUCCESS;
+}
+
+bool iotc_telemetry_aggregator_is_window_elapsed(void) {
+    return (get_time() - window_start) >= window_length_ms;
+}
+
+int iotc_telemetry_aggregator_write(IotcTelemetryWriter *w) {
+    // take the window and start a new one in one step, so that no sample is lost or counted twice
+    taskENTER_CRITICAL();
+    written_count = entry_count;
+    for (int i = 0; i < written_count; i++) {
+        written[i] = entries[i].acc;
+        entries[i].acc.count = 0;
+    }
+    window_start = get_time();
+    taskEXIT_CRITICAL();
+
+    for (int i = 0; i < written_count; i++) {
+        const Accumulator *a = &written[i];
+        if (0 == a->count) {
+            continue;
+        }
+        iotc_telemetry_writer_begin_object(w, entries[i].name);
+        iotc_telemetry_writer_add_number(w, "min", a->min);
+        iotc_telemetry_writer_add_number(w, "max", a->max);
+        iotc_telemetry_writer_add_number(w, "mean", a->mean);
+        iotc_telemetry_writer_add_int(w, "count", (int64_t) a->count);
+        iotc_telemetry_writer_end_object(w);
+    }
+    // the writer keeps its error state, so checking the outcome once is sufficient
+    return w->is_overflow ? IOTCL_ERR_OUT_OF_MEMORY : IOTCL_SUCCESS;
+}
+
+void iotc_telemetry_aggregator_restore(void) {
+    taskENTER_CRITICAL();
+    for (int i = 0; i < written_count; i++) {
+        const Accumulator *from = &written[i];
+        Accumulator *a = &entries[i].acc;
+        if (0 == from->count) {
+            continue;
+        }
+        if (0 == a->count) {
+            *a = *from;
+            continue;
+        }
+        uint32_t count = a->count + from->count;
+        if (from->min < a->min) {
+            a->min = from->min;
+        }
+        if (from->max > a->max) {
+            a->max = from->max;
+        }
+        a->mean += (from->mean - a->mean) * ((double) from->count / (double) count);
+        a->count = count;
+    }
+    written_count = 0;
+    taskEXIT_CRITICAL();
+}
+
+int iotc_telemetry_aggregator_send(const char *iso_time) {
+    IotcTelemetryWriter w;
+    int status = iotc_telemetry_writer_begin(&w, NULL, 0, iso_time);
+    if (status) {
+        return status;
+    }
+    status = iotc_telemetry_aggregator_write(&w);
+    if (status) {
+        iotc_telemetry_writer_release(&w);
+        iotc_telemetry_aggregator_restore();
+        return status;
+    }
+    if (!iotc_telemetry_writer_has_data(&w)) {
+        iotc_telemetry_writer_release(&w);
+        return IOTCL_SUCCESS;
+    }
+    status = iotc_telemetry_writer_send(&w);
+    if (status) {
+        iotc_telemetry_aggregator_restore();
+    }
+    return status;
+}
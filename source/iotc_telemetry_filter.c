@@ -0,0 +1,203 @@
+/* SPDX-License-Identifier: MIT
+ * Copyright (C) 2025 Avnet
+ * Authors: Nikola Markovic <nikola.markovic@avnet.com> et al.
+ */
+
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+
+#include "cyabs_rtos.h"
+
+#include "iotcl.h"
+#include "iotc_telemetry_filter.h"
+
+typedef struct {
+    const char *name;
+    double deadband;
+    uint32_t max_interval_ms;
+    bool has_value;
+    cy_time_t sent_time;
+    // The last value that was sent. Booleans are kept as numbers. A NULL string is kept as NULL.
+    double last_number;
+    char *last_string;
+    // The value that passed the filter and is waiting for iotc_telemetry_filter_commit()
+    bool is_pending;
+    cy_time_t pending_time;
+    double pending_number;
+    char *pending_string;
+} FilterEntry;
+
+static FilterEntry entries[IOTC_TELEMETRY_FILTER_SIZE];
+static int entry_count = 0;
+static IotcTelemetryFilterStats stats = {0};
+
+static FilterEntry *find_entry(const char *name) {
+    for (int i = 0; i < entry_count; i++) {
+        if (0 == strcmp(entries[i].name, name)) {
+            return &entries[i];
+        }
+    }
+    return NULL;
+}
+
+static void clear_pending(FilterEntry *e) {
+    iotcl_free(e->pending_string);
+    e->pending_string = NULL;
+    e->is_pending = false;
+}
+
+// Decides whether to send, given whether the value changed, and marks the entry as pending if so.
+static bool check_entry(FilterEntry *e, bool is_changed) {
+    cy_time_t now = 0;
+    (void) cy_rtos_get_time(&now);
+
+    clear_pending(e);
+    if (!e->has_value || is_changed) {
+        stats.sent++;
+    } else if (e->max_interval_ms > 0 && (now - e->sent_time) >= e->max_interval_ms) {
+        stats.refreshed++;
+    } else {
+        stats.suppressed++;
+        return false;
+    }
+    e->is_pending = true;
+    e->pending_time = now;
+    return true;
+}
+
+int iotc_telemetry_filter_add_rule(const char *name, double deadband, uint32_t max_interval_ms) {
+    if (!name || deadband < 0) {
+        return IOTCL_ERR_BAD_VALUE;
+    }
+    FilterEntry *e = find_entry(name);
+    if (!e) {
+        if (entry_count >= IOTC_TELEMETRY_FILTER_SIZE) {
+            printf("IOTC: Telemetry filter is full. Increase IOTC_TELEMETRY_FILTER_SIZE.\n");
+            return IOTCL_ERR_OUT_OF_MEMORY;
+        }
+        e = &entries[entry_count++];
+        memset(e, 0, sizeof(FilterEntry));
+        e->name = name;
+    }
+    e->deadband = deadband;
+    e->max_interval_ms = max_interval_ms;
+    return IOTCL_SUCCESS;
+}
+
+bool iotc_telemetry_filter_check_number(const char *name, double value) {
+    FilterEntry *e = find_entry(name);
+    if (!e) {
+        return true;
+    }
+    // NaN compares unequal to everything, so treat a NaN that follows a NaN as unchanged
+    bool is_changed;
+    if (isnan(value) || isnan(e->last_number)) {
+        is_changed = isnan(value) != isnan(e->last_number);
+    } else if (e->deadband > 0) {
+        is_changed = fabs(value - e->last_number) > e->deadband;
+    } else {
+        is_changed = value != e->last_number;
+    }
+    if (!check_entry(e, is_changed)) {
+        return false;
+    }
+    // Only update the reference on commit, so that a slow drift still adds up to exceed the deadband
+    e->pending_number = value;
+    return true;
+}
+
+bool iotc_telemetry_filter_check_string(const char *name, const char *value) {
+    FilterEntry *e = find_entry(name);
+    if (!e) {
+        return true;
+    }
+    bool is_changed;
+    if (!value || !e->last_string) {
+        is_changed = value != e->last_string;
+    } else {
+        is_changed = 0 != strcmp(value, e->last_string);
+    }
+    if (!check_entry(e, is_changed)) {
+        return false;
+    }
+    if (value) {
+        e->pending_string = iotcl_strdup(value);
+        if (!e->pending_string) {
+            // send it, but leave it out of the commit so that it is compared against the previous value again
+            e->is_pending = false;
+        }
+    }
+    return true;
+}
+
+// The deadband does not apply to booleans. Any change is sent.
+bool iotc_telemetry_filter_check_bool(const char *name, bool value) {
+    FilterEntry *e = find_entry(name);
+    if (!e) {
+        return true;
+    }
+    double number = value ? 1.0 : 0.0;
+    if (!check_entry(e, number != e->last_number)) {
+        return false;
+    }
+    e->pending_number = number;
+    return true;
+}
+
+int iotc_telemetry_filter_add_number(IotcTelemetryWriter *w, const char *name, double value) {
+    if (!iotc_telemetry_filter_check_number(name, value)) {
+        return IOTCL_SUCCESS;
+    }
+    return iotc_telemetry_writer_add_number(w, name, value);
+}
+
+int iotc_telemetry_filter_add_string(IotcTelemetryWriter *w, const char *name, const char *value) {
+    if (!iotc_telemetry_filter_check_string(name, value)) {
+        return IOTCL_SUCCESS;
+    }
+    return iotc_telemetry_writer_add_string(w, name, value);
+}
+
+int iotc_telemetry_filter_add_bool(IotcTelemetryWriter *w, const char *name, bool value) {
+    if (!iotc_telemetry_filter_check_bool(name, value)) {
+        return IOTCL_SUCCESS;
+    }
+    return iotc_telemetry_writer_add_bool(w, name, value);
+}
+
+void iotc_telemetry_filter_commit(void) {
+    for (int i = 0; i < entry_count; i++) {
+        FilterEntry *e = &entries[i];
+        if (!e->is_pending) {
+            continue;
+        }
+        iotcl_free(e->last_string);
+        e->last_string = e->pending_string;
+        e->pending_string = NULL;
+        e->last_number = e->pending_number;
+        e->sent_time = e->pending_time;
+        e->has_value = true;
+        e->is_pending = false;
+    }
+}
+
+void iotc_telemetry_filter_discard(void) {
+    for (int i = 0; i < entry_count; i++) {
+        clear_pending(&entries[i]);
+    }
+}
+
+void iotc_telemetry_filter_reset(void) {
+    for (int i = 0; i < entry_count; i++) {
+        FilterEntry *e = &entries[i];
+        clear_pending(e);
+        iotcl_free(e->last_string);
+        e->last_string = NULL;
+        e->has_value = false;
+    }
+}
+
+void iotc_telemetry_filter_get_stats(IotcTelemetryFilterStats *s) {
+    memcpy(s, &stats, sizeof(IotcTelemetryFilterStats));
+}
@@ -0,0 +1,214 @@
+/* SPDX-License-Identifier: MIT
+ * Copyright (C) 2025 Avnet
+ * Authors: Nikola Markovic <nikola.markovic@avnet.com> et al.
+ */
+
+#include <string.h>
+#include <stdio.h>
+
+#include "cy_result.h"
+
+#include "iotcl.h"
+#include "iotconnect.h"
+#include "iotc_fmt.h"
+#include "iotc_json_mem.h"
+#include "iotc_telemetry_writer.h"
+#include "iotc_telemetry_template.h"
+
+// Same envelope as in iotc_telemetry_writer.c: {"d":[{"dt":"<time>","d":{<attributes>}}]}
+#define ENVELOPE_START "{\"d\":[{"
+#define ENVELOPE_TIME_START "\"dt\":\""
+#define ENVELOPE_TIME_END "\","
+#define ENVELOPE_DATA_START "\"d\":{"
+#define ENVELOPE_END "}}]}"
+
+typedef struct {
+    IotcTemplateFieldType type;
+    int decimals;
+} CompiledField;
+
+struct IotcTelemetryTemplate {
+    size_t field_count;
+    CompiledField *fields;
+    // Segment N is the literal that precedes the value of field N: "d":{"name": for the first field
+    // and ,"name": for the others. Segment field_count is the closing literal }}]} (preceded by "d":{ if there are no fields).
+    size_t *segment_offsets; // field_count + 2 entries, so that the length of segment N is offsets[N + 1] - offsets[N]
+    char *literals;
+    char *buffer;
+    size_t buffer_size;
+};
+
+typedef struct {
+    char *buffer;
+    size_t size;
+    size_t length;
+    bool is_overflow;
+} Output;
+
+static void out_raw(Output *o, const char *str, size_t len) {
+    if (o->is_overflow) {
+        return;
+    }
+    // always leave room for the null terminator
+    if (o->length + len >= o->size) {
+        o->is_overflow = true;
+        return;
+    }
+    memcpy(&o->buffer[o->length], str, len);
+    o->length += len;
+}
+
+static void out_value(Output *o, const CompiledField *f, const IotcTemplateValue *v) {
+    char number_buffer[IOTC_FMT_BUFFER_SIZE];
+    size_t len;
+    switch (f->type) {
+        case IOTC_TF_NUMBER:
+            len = f->decimals >= 0 ? iotc_fmt_fixed(number_buffer, v->number, f->decimals)
+                    : iotc_fmt_double(number_buffer, v->number);
+            out_raw(o, number_buffer, len);
+            break;
+        case IOTC_TF_INT:
+            len = iotc_fmt_int(number_buffer, v->integer);
+            out_raw(o, number_buffer, len);
+            break;
+        case IOTC_TF_BOOL:
+            if (v->boolean) {
+                out_raw(o, "true", 4);
+            } else {
+                out_raw(o, "false", 5);
+            }
+            break;
+        case IOTC_TF_STRING:
+        default:
+            if (!v->string) {
+                out_raw(o, "null", 4);
+            } else if (!o->is_overflow) {
+                // escape directly into the output
+                len = iotc_fmt_json_string(&o->buffer[o->length], o->size - o->length, v->string);
+                if (len) {
+                    o->length += len;
+                } else {
+                    o->is_overflow = true;
+                }
+            }
+            break;
+    }
+}
+
+IotcTelemetryTemplate *iotc_telemetry_template_create(const IotcTemplateField *fields, size_t field_count, size_t buffer_size) {
+    size_t literals_size = strlen(ENVELOPE_DATA_START) + strlen(ENVELOPE_END) + 1;
+
+    if (!fields && field_count > 0) {
+        return NULL;
+    }
+    for (size_t i = 0; i < field_count; i++) {
+        if (!fields[i].name || fields[i].type > IOTC_TF_STRING
+                || (IOTC_TF_NUMBER == fields[i].type && (fields[i].decimals < IOTC_TF_SHORTEST || fields[i].decimals > 9))) {
+            printf("IOTC: Invalid telemetry template field at index %u\n", (unsigned int) i);
+            return NULL;
+        }
+        // worst case: every character is escaped as \u00XX, plus the quotes, the comma and the colon
+        literals_size += strlen(fields[i].name) * 6 + 4;
+    }
+    if (0 == buffer_size) {
+        buffer_size = IOTC_JSON_PRINT_BUFFER_SIZE;
+    }
+
+    // one allocation for everything, with the size_t array first to keep it aligned
+    size_t offsets_bytes = (field_count + 2) * sizeof(size_t);
+    size_t fields_bytes = field_count * sizeof(CompiledField);
+    size_t total = sizeof(IotcTelemetryTemplate) + offsets_bytes + fields_bytes + literals_size + buffer_size;
+    IotcTelemetryTemplate *t = iotcl_malloc(total);
+    if (!t) {
+        printf("IOTC: Out of memory while creating the telemetry template!\n");
+        return NULL;
+    }
+    t->field_count = field_count;
+    t->segment_offsets = (size_t *) (t + 1);
+    t->fields = (CompiledField *) ((char *) t->segment_offsets + offsets_bytes);
+    t->literals = (char *) t->fields + fields_bytes;
+    t->buffer = t->literals + literals_size;
+    t->buffer_size = buffer_size;
+
+    size_t pos = 0;
+    for (size_t i = 0; i < field_count; i++) {
+        t->fields[i].type = fields[i].type;
+        t->fields[i].decimals = fields[i].decimals;
+        t->segment_offsets[i] = pos;
+        if (0 == i) {
+            memcpy(&t->literals[pos], ENVELOPE_DATA_START, strlen(ENVELOPE_DATA_START));
+            pos += strlen(ENVELOPE_DATA_START);
+        } else {
+            t->literals[pos++] = ',';
+        }
+        pos += iotc_fmt_json_string(&t->literals[pos], literals_size - pos, fields[i].name);
+        t->literals[pos++] = ':';
+    }
+    t->segment_offsets[field_count] = pos;
+    if (0 == field_count) {
+        memcpy(&t->literals[pos], ENVELOPE_DATA_START, strlen(ENVELOPE_DATA_START));
+        pos += strlen(ENVELOPE_DATA_START);
+    }
+    memcpy(&t->literals[pos], ENVELOPE_END, strlen(ENVELOPE_END));
+    pos += strlen(ENVELOPE_END);
+    t->segment_offsets[field_count + 1] = pos;
+    return t;
+}
+
+int iotc_telemetry_template_format(const IotcTelemetryTemplate *t, const IotcTemplateValue *values, const char *iso_time,
+        char *buffer, size_t buffer_size, size_t *length) {
+    Output o = {buffer, buffer_size, 0, false};
+
+    if (!t || !buffer || (!values && t->field_count > 0)) {
+        return IOTCL_ERR_BAD_VALUE;
+    }
+
+    char time_buffer[IOTC_FMT_ISO_TIME_SIZE];
+    if (!iso_time) {
+        // same as in the telemetry writer
+        (void) iotc_fmt_iso_time(time_buffer, time(NULL));
+        iso_time = time_buffer;
+    }
+
+    out_raw(&o, ENVELOPE_START, strlen(ENVELOPE_START));
+    if (iso_time[0]) {
+        out_raw(&o, ENVELOPE_TIME_START, strlen(ENVELOPE_TIME_START));
+        out_raw(&o, iso_time, strlen(iso_time));
+        out_raw(&o, ENVELOPE_TIME_END, strlen(ENVELOPE_TIME_END));
+    }
+    for (size_t i = 0; i < t->field_count; i++) {
+        size_t offset = t->segment_offsets[i];
+        out_raw(&o, &t->literals[offset], t->segment_offsets[i + 1] - offset);
+        out_value(&o, &t->fields[i], &values[i]);
+    }
+    size_t offset = t->segment_offsets[t->field_count];
+    out_raw(&o, &t->literals[offset], t->segment_offsets[t->field_count + 1] - offset);
+
+    if (o.is_overflow) {
+        return IOTCL_ERR_OUT_OF_MEMORY;
+    }
+    buffer[o.length] = 0; // out_raw() always leaves room for this
+    if (length) {
+        *length = o.length;
+    }
+    return IOTCL_SUCCESS;
+}
+
+int iotc_telemetry_template_send(IotcTelemetryTemplate *t, const IotcTemplateValue *values, const char *iso_time) {
+    if (!t) {
+        return IOTCL_ERR_BAD_VALUE;
+    }
+    int status = iotc_telemetry_template_format(t, values, iso_time, t->buffer, t->buffer_size, NULL);
+    if (IOTCL_ERR_OUT_OF_MEMORY == status) {
+        printf("IOTC: Telemetry message did not fit into the template buffer of %u bytes!\n", (unsigned int) t->buffer_size);
+    }
+    if (status) {
+        return status;
+    }
+    cy_rslt_t ret = iotconnect_sdk_send_telemetry_json(t->buffer);
+    return ret == CY_RSLT_SUCCESS ? IOTCL_SUCCESS : IOTCL_ERR_FAILED;
+}
+
+void iotc_telemetry_template_destroy(IotcTelemetryTemplate *t) {
+    iotcl_free(t);
+}
@@ -0,0 +1,279 @@
+/* SPDX-License-Identifier: MIT
+ * Copyright (C) 2025 Avnet
+ * Authors: Nikola Markovic <nikola.markovic@avnet.com> et al.
+ */
+
+#include <string.h>
+#include <stdio.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "iotcl.h"
+#include "iotconnect.h"
+#include "iotc_fmt.h"
+#include "iotc_json_mem.h"
+#include "iotc_telemetry_writer.h"
+
+// The envelope is the same one that iotc-c-lib creates: {"d":[{"dt":"<time>","d":{<attributes>}}]}
+#define ENVELOPE_START "{\"d\":[{"
+#define ENVELOPE_TIME_START "\"dt\":\""
+#define ENVELOPE_TIME_END "\","
+#define ENVELOPE_DATA_START "\"d\":{"
+#define ENVELOPE_END "}}]}"
+
+#define MAX_DEPTH 31 // limited by the has_members bit field
+
+// Moves an SDK buffer that is too small to the heap. Returns false if the buffer was provided by the caller or out of memory.
+static bool grow(IotcTelemetryWriter *w, size_t needed) {
+    if (!w->is_sdk_buffer) {
+        return false;
+    }
+    size_t new_size = w->size * 2;
+    if (new_size < needed) {
+        new_size = needed;
+    }
+    char *buffer = iotc_json_mem_grow(w->buffer, w->length, new_size);
+    if (!buffer) {
+        printf("IOTC: Out of memory while growing a telemetry message to %u bytes!\n", (unsigned int) new_size);
+        return false;
+    }
+    w->buffer = buffer;
+    w->size = new_size;
+    return true;
+}
+
+static bool reserve(IotcTelemetryWriter *w, size_t len) {
+    if (w->is_overflow) {
+        return false;
+    }
+    // always leave room for the null terminator
+    if (w->length + len >= w->size && !grow(w, w->length + len + 1)) {
+        w->is_overflow = true;
+        return false;
+    }
+    return true;
+}
+
+static void write_raw(IotcTelemetryWriter *w, const char *str, size_t len) {
+    if (!reserve(w, len)) {
+        return;
+    }
+    memcpy(&w->buffer[w->length], str, len);
+    w->length += len;
+}
+
+static void write_str(IotcTelemetryWriter *w, const char *str) {
+    write_raw(w, str, strlen(str));
+}
+
+static void write_char(IotcTelemetryWriter *w, char c) {
+    write_raw(w, &c, 1);
+}
+
+static void write_quoted(IotcTelemetryWriter *w, const char *str) {
+    if (w->is_overflow) {
+        return;
+    }
+    size_t len = iotc_fmt_json_string(&w->buffer[w->length], w->size - w->length, str);
+    if (!len) {
+        // worst case: every character is escaped as \u00XX, plus the quotes
+        if (!reserve(w, strlen(str) * 6 + 2)) {
+            return;
+        }
+        len = iotc_fmt_json_string(&w->buffer[w->length], w->size - w->length, str);
+        if (!len) {
+            w->is_overflow = true;
+            return;
+        }
+    }
+    w->length += len;
+}
+
+static int write_name(IotcTelemetryWriter *w, const char *name) {
+    if (w->is_overflow) {
+        return IOTCL_ERR_OUT_OF_MEMORY;
+    }
+    if (!w->buffer || w->is_finished || !name) {
+        return IOTCL_ERR_BAD_VALUE;
+    }
+    if (w->has_members & (1u << w->depth)) {
+        write_char(w, ',');
+    }
+    w->has_members |= (1u << w->depth);
+    write_quoted(w, name);
+    write_char(w, ':');
+    return IOTCL_SUCCESS;
+}
+
+static int result(IotcTelemetryWriter *w) {
+    return w->is_overflow ? IOTCL_ERR_OUT_OF_MEMORY : IOTCL_SUCCESS;
+}
+
+static void write_number(IotcTelemetryWriter *w, double d) {
+    char number_buffer[IOTC_FMT_BUFFER_SIZE];
+    size_t len = iotc_fmt_double(number_buffer, d);
+    write_raw(w, number_buffer, len);
+}
+
+int iotc_telemetry_writer_begin(IotcTelemetryWriter *w, char *buffer, size_t buffer_size, const char *iso_time) {
+    memset(w, 0, sizeof(IotcTelemetryWriter));
+    if (buffer) {
+        w->buffer = buffer;
+        w->size = buffer_size;
+    } else {
+        w->buffer = iotc_json_mem_get_buffer();
+        if (!w->buffer) {
+            printf("IOTC: Out of memory while starting a telemetry message!\n");
+            return IOTCL_ERR_OUT_OF_MEMORY;
+        }
+        w->size = IOTC_JSON_PRINT_BUFFER_SIZE;
+        w->is_sdk_buffer = true;
+    }
+
+    char time_buffer[IOTC_FMT_ISO_TIME_SIZE];
+    if (!iso_time) {
+        // same clock and format as the iotc-c-lib telemetry
+        (void) iotc_fmt_iso_time(time_buffer, time(NULL));
+        iso_time = time_buffer;
+    }
+
+    write_str(w, ENVELOPE_START);
+    if (iso_time[0]) {
+        write_str(w, ENVELOPE_TIME_START);
+        write_str(w, iso_time);
+        write_str(w, ENVELOPE_TIME_END);
+    }
+    write_str(w, ENVELOPE_DATA_START);
+    return result(w);
+}
+
+int iotc_telemetry_writer_add_number(IotcTelemetryWriter *w, const char *name, double value) {
+    int status = write_name(w, name);
+    if (status) {
+        return status;
+    }
+    write_number(w, value);
+    return result(w);
+}
+
+int iotc_telemetry_writer_add_number_precision(IotcTelemetryWriter *w, const char *name, double value, int decimals) {
+    char number_buffer[IOTC_FMT_BUFFER_SIZE];
+    int status = write_name(w, name);
+    if (status) {
+        return status;
+    }
+    size_t len = iotc_fmt_fixed(number_buffer, value, decimals);
+    write_raw(w, number_buffer, len);
+    return result(w);
+}
+
+int iotc_telemetry_writer_add_int(IotcTelemetryWriter *w, const char *name, int64_t value) {
+    char number_buffer[IOTC_FMT_BUFFER_SIZE];
+    int status = write_name(w, name);
+    if (status) {
+        return status;
+    }
+    size_t len = iotc_fmt_int(number_buffer, value);
+    write_raw(w, number_buffer, len);
+    return result(w);
+}
+
+int iotc_telemetry_writer_add_string(IotcTelemetryWriter *w, const char *name, const char *value) {
+    if (!value) {
+        return iotc_telemetry_writer_add_null(w, name);
+    }
+    int status = write_name(w, name);
+    if (status) {
+        return status;
+    }
+    write_quoted(w, value);
+    return result(w);
+}
+
+int iotc_telemetry_writer_add_bool(IotcTelemetryWriter *w, const char *name, bool value) {
+    int status = write_name(w, name);
+    if (status) {
+        return status;
+    }
+    write_str(w, value ? "true" : "false");
+    return result(w);
+}
+
+int iotc_telemetry_writer_add_null(IotcTelemetryWriter *w, const char *name) {
+    int status = write_name(w, name);
+    if (status) {
+        return status;
+    }
+    write_str(w, "null");
+    return result(w);
+}
+
+int iotc_telemetry_writer_begin_object(IotcTelemetryWriter *w, const char *name) {
+    if (w->depth >= MAX_DEPTH) {
+        printf("IOTC: Telemetry objects are nested too deep!\n");
+        return IOTCL_ERR_BAD_VALUE;
+    }
+    int status = write_name(w, name);
+    if (status) {
+        return status;
+    }
+    write_char(w, '{');
+    w->depth++;
+    w->has_members &= ~(1u << w->depth);
+    return result(w);
+}
+
+int iotc_telemetry_writer_end_object(IotcTelemetryWriter *w) {
+    if (w->depth <= 0 || w->is_finished) {
+        return IOTCL_ERR_BAD_VALUE;
+    }
+    write_char(w, '}');
+    w->depth--;
+    return result(w);
+}
+
+bool iotc_telemetry_writer_has_data(const IotcTelemetryWriter *w) {
+    return 0 != (w->has_members & 1u);
+}
+
+const char *iotc_telemetry_writer_finish(IotcTelemetryWriter *w, size_t *length) {
+    if (!w->buffer) {
+        return NULL;
+    }
+    if (!w->is_finished) {
+        // close any objects that the user left open
+        while (w->depth > 0) {
+            iotc_telemetry_writer_end_object(w);
+        }
+        write_str(w, ENVELOPE_END);
+        w->is_finished = true;
+    }
+    if (w->is_overflow) {
+        return NULL;
+    }
+    w->buffer[w->length] = 0; // write_raw() always leaves room for this
+    if (length) {
+        *length = w->length;
+    }
+    return w->buffer;
+}
+
+int iotc_telemetry_writer_send(IotcTelemetryWriter *w) {
+    const char *json = iotc_telemetry_writer_finish(w, NULL);
+    if (!json) {
+        printf("IOTC: Telemetry message did not fit into the buffer of %u bytes!\n", (unsigned int) w->size);
+        iotc_telemetry_writer_release(w);
+        return IOTCL_ERR_OUT_OF_MEMORY;
+    }
+    cy_rslt_t ret = iotconnect_sdk_send_telemetry_json(json);
+    iotc_telemetry_writer_release(w);
+    return ret == CY_RSLT_SUCCESS ? IOTCL_SUCCESS : IOTCL_ERR_FAILED;
+}
+
+void iotc_telemetry_writer_release(IotcTelemetryWriter *w) {
+    if (w->is_sdk_buffer && w->buffer) {
+        iotc_json_mem_free_print(w->buffer);
+    }
+    w->buffer = NULL;
+}
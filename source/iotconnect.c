@@ -16,13 +16,33 @@
 #include "iotcl_util.h"
 #include "iotcl_dra_discovery.h"
 #include "iotcl_dra_identity.h"
+#include "iotc_ca_store.h"
+#include "iotc_certs.h"
+#include "iotc_command.h"
+#include "iotc_dns_cache.h"
 #include "iotc_http_client.h"
+#include "iotc_json_mem.h"
 #include "iotc_mqtt_client.h"
 #include "iotc_mqtt_mq.h"
+#include "iotc_telemetry_writer.h"
 #include "iotconnect.h"
 
 IotConnectClientConfig config = {0};
 
+// Registered handlers first, then the application's callback.
+// The handlers are application code, so their cJSON allocations go to the heap rather than the message arena.
+static void on_command(IotclC2dEventData data) {
+    iotc_json_mem_end();
+    iotc_command_dispatch(data, config.callbacks.cmd_cb);
+    iotc_json_mem_begin();
+}
+
+static void on_ota(IotclC2dEventData data) {
+    iotc_json_mem_end();
+    config.callbacks.ota_cb(data);
+    iotc_json_mem_begin();
+}
+
 #ifdef IOTC_AWS_DEVICE_QUALIFICATION
 
 // See AWS_DEFICE_QUALIFICATION.md in this SDK repo for more details.
@@ -50,10 +70,11 @@ static void iotc_qualification_start(const char* host) {
         	iotconnect_sdk_connect();
 			last_connected = xTaskGetTickCount();
 		}
-		IotclMessageHandle msg = iotcl_telemetry_create();
-    	iotcl_telemetry_set_string(msg, "qualification", "true");
-    	iotcl_mqtt_send_telemetry(msg, false);
-        iotcl_telemetry_destroy(msg);
+		IotcTelemetryWriter w;
+		if (IOTCL_SUCCESS == iotc_telemetry_writer_begin(&w, NULL, 0, NULL)) {
+			iotc_telemetry_writer_add_string(&w, "qualification", "true");
+			iotc_telemetry_writer_send(&w);
+		}
         iotconnect_sdk_poll_inbound_mq(5000);
         if (((xTaskGetTickCount() - last_connected) * portTICK_PERIOD_MS) > 60000) {
         	printf("----------\nWARNING: Connection lingered for too long. Restarting the connection\n----------\n");
@@ -66,17 +87,21 @@ static void on_command_intercept(IotclC2dEventData data) {
     const char * const QUALIFICATION_START_PREFIX_CMD = "aws-qualification-start "; // with a space
     const char *command = iotcl_c2d_get_command(data);
 
+    if (!command || 0 != strncmp(QUALIFICATION_START_PREFIX_CMD, command, strlen(QUALIFICATION_START_PREFIX_CMD))) {
+        on_command(data);
+        return;
+    }
+
     // Even if in qualification mode, notify the application so it can stop any background activity
+    iotc_json_mem_end();
     if (config.callbacks.cmd_cb) {
 		config.callbacks.cmd_cb(data);
 	}
 
-    if (command && (0 == strncmp(QUALIFICATION_START_PREFIX_CMD, command, strlen(QUALIFICATION_START_PREFIX_CMD)))) {
-    	const char* qual_host = &command[strlen(QUALIFICATION_START_PREFIX_CMD)];
-    	// This function should block forever and not allow the main application loop to continue
-    	// the called function will check the host parameter
-    	iotc_qualification_start(qual_host);
-    }
+    const char* qual_host = &command[strlen(QUALIFICATION_START_PREFIX_CMD)];
+    // This function should block forever and not allow the main application loop to continue
+    // the called function will check the host parameter
+    iotc_qualification_start(qual_host);
 }
 #endif // IOTC_AWS_DEVICE_QUALIFICATION
 
@@ -221,7 +246,11 @@ static void on_mqtt_mq_message(const char* topic, const char *message, size_t me
     if (config.verbose) {
         printf("+: %.*s\n", (int) message_len, message);
     }
+    // the parse tree lives only for the duration of this call, so serve it from the arena.
+    // The scope is suspended while the application's callbacks run (see on_command() and on_ota()).
+    iotc_json_mem_begin();
     iotcl_c2d_process_event_with_length((uint8_t*) message, message_len);
+    iotc_json_mem_end();
 }
 void iotconnect_sdk_mqtt_send_cb(const char *topic, const char *json_str) {
     if (config.verbose) {
@@ -230,6 +259,52 @@ void iotconnect_sdk_mqtt_send_cb(const char *topic, const char *json_str) {
     iotc_mqtt_client_publish(topic, json_str, config.qos);
 }
 
+cy_rslt_t iotconnect_sdk_send_telemetry_json(const char *json_str) {
+    IotclMqttConfig *mc = iotcl_mqtt_get_config();
+    if (!mc || !mc->pub_rpt) {
+        return (cy_rslt_t) IOTCL_ERR_CONFIG_ERROR; // called function will print the error
+    }
+    if (config.verbose) {
+        printf(">: %s\n",  json_str);
+    }
+    return iotc_mqtt_client_publish(mc->pub_rpt, json_str, config.qos);
+}
+
+cy_rslt_t iotconnect_sdk_send_cmd_ack(const char *ack_id, int status, const char *message) {
+    IotclMqttConfig *mc = iotcl_mqtt_get_config();
+    if (!mc || !mc->pub_ack) {
+        return (cy_rslt_t) IOTCL_ERR_CONFIG_ERROR;
+    }
+    if (!ack_id) {
+        return (cy_rslt_t) IOTCL_ERR_MISSING_VALUE;
+    }
+    // {"d":{"ack":"<ack_id>","type":0,"st":<status>,"msg":"<message>"}}, as built by iotc-c-lib
+    cy_rslt_t ret = (cy_rslt_t) IOTCL_ERR_OUT_OF_MEMORY;
+    cJSON *root = cJSON_CreateObject();
+    cJSON *d = root ? cJSON_AddObjectToObject(root, "d") : NULL;
+    if (!d
+            || !cJSON_AddStringToObject(d, "ack", ack_id)
+            || !cJSON_AddNumberToObject(d, "type", 0)
+            || !cJSON_AddNumberToObject(d, "st", status)
+            || !cJSON_AddStringToObject(d, "msg", message ? message : "")) {
+        printf("IOTC: Out of memory while creating the command acknowledgement!\n");
+        cJSON_Delete(root);
+        return ret;
+    }
+    char *json_str = iotc_json_mem_print(root);
+    cJSON_Delete(root);
+    if (!json_str) {
+        printf("IOTC: Out of memory while printing the command acknowledgement!\n");
+        return ret;
+    }
+    if (config.verbose) {
+        printf(">: %s\n",  json_str);
+    }
+    ret = iotc_mqtt_client_publish(mc->pub_ack, json_str, config.qos);
+    iotc_json_mem_free_print(json_str);
+    return ret;
+}
+
 cy_rslt_t iotconnect_sdk_disconnect() {
 	iotc_mq_deregister();
 	iotc_mq_flush();
@@ -240,6 +315,9 @@ void iotconnect_sdk_init_config(IotConnectClientConfig *c) {
     memset(c, 0, sizeof(IotConnectClientConfig));
     c->qos = 1;
     c->mq_max_messages = 4;
+#ifdef IOTC_FIXED_CONNECTION_TYPE
+    c->connection_type = IOTC_FIXED_CONNECTION_TYPE;
+#endif
 }
 
 bool iotconnect_sdk_is_connected(void) {
@@ -248,6 +326,8 @@ bool iotconnect_sdk_is_connected(void) {
 
 void iotconnect_sdk_poll_inbound_mq(cy_time_t timeout_ms) {
 	iotc_mq_process(timeout_ms);
+	// async command handlers wake up the queue when they complete
+	iotc_command_send_completed_acks();
 }
 
 cy_rslt_t iotconnect_sdk_connect(void) {
@@ -297,22 +377,33 @@ int iotconnect_sdk_init(IotConnectClientConfig *c) {
         return IOTCL_ERR_MISSING_VALUE;
     }
 
+#ifdef IOTC_FIXED_CONNECTION_TYPE
+    if (c->connection_type != IOTC_FIXED_CONNECTION_TYPE) {
+        printf("Error: This SDK build supports only connection type %d!\n", IOTC_FIXED_CONNECTION_TYPE);
+        iotconnect_sdk_deinit();
+        return IOTCL_ERR_CONFIG_ERROR;
+    }
+#endif
+
     if (c->mq_max_messages <= 0) {
         printf("IOTC: Error: mq_max_messages needs to be greater than zero!\n");
         return IOTCL_ERR_CONFIG_ERROR;
     }
 
+    // before the library creates any cJSON objects
+    iotc_json_mem_init();
+
     IotclClientConfig iotcl_cfg;
 	iotcl_init_client_config(&iotcl_cfg);
 	iotcl_cfg.device.cpid = c->cpid;
 	iotcl_cfg.device.duid = c->duid;
 	iotcl_cfg.device.instance_type = IOTCL_DCT_CUSTOM;
 	iotcl_cfg.mqtt_send_cb = iotconnect_sdk_mqtt_send_cb;
-	iotcl_cfg.events.ota_cb = c->callbacks.ota_cb;
+	iotcl_cfg.events.ota_cb = c->callbacks.ota_cb ? on_ota : NULL;
 #ifdef IOTC_AWS_DEVICE_QUALIFICATION
 	iotcl_cfg.events.cmd_cb = on_command_intercept;
 #else
-	iotcl_cfg.events.cmd_cb = c->callbacks.cmd_cb;
+	iotcl_cfg.events.cmd_cb = on_command;
 #endif
 
     if (c->verbose) {
@@ -321,12 +412,23 @@ int iotconnect_sdk_init(IotConnectClientConfig *c) {
         status = iotcl_init(&iotcl_cfg);
     }
 
+    // Parse the root certificates once. If this fails, each client will fall back to parsing the PEM on each connection.
+    if (CY_RSLT_SUCCESS == iotc_ca_store_init(c->connection_type) && c->verbose) {
+        IotcCaStoreStats ca_stats;
+        iotc_ca_store_get_stats(&ca_stats);
+        printf("CA Store: Parsed %u bytes of certificates in %lu ms using %u bytes of heap. Each TLS connection saves this much.\n",
+                (unsigned int) ca_stats.cert_size, (unsigned long) ca_stats.parse_time_ms, (unsigned int) ca_stats.heap_size);
+    }
+
 	status = run_http_identity(c->connection_type, c->duid, c->cpid, c->env);
     if (status) {
 		iotconnect_sdk_deinit();
         return status;
     }
     printf("Identity response parsing successful.\n");
+
+    // Resolve the MQTT host while we are at it. The connect call will then be served from the DNS cache.
+    (void) iotc_dns_preresolve(iotcl_mqtt_get_config()->host);
     return 0;
 }
 
@@ -334,7 +436,9 @@ void iotconnect_sdk_deinit(void) {
 	if (iotconnect_sdk_is_connected()) {
 		iotconnect_sdk_disconnect();
 	}
+	iotc_command_deinit();
 	iotc_mq_deinit();
+	iotc_ca_store_deinit();
 	// We use const to note to he user that they can use constants,
 	// but internally we use our own copy that is not const in reality (just to avoid copying the same struct typedef)
     if (config.cpid) iotcl_free((char *) config.cpid);
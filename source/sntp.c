@@ -70,6 +70,7 @@
 
 // BEGIN - IoTconnect SDK time integration
 #include "iotc_mtb_time.h"
+#include "iotc_dns_cache.h"
 #define SNTP_SET_SYSTEM_TIME_US iotc_set_system_time_us
 // END - IoTconnect SDK time integration
 
@@ -596,11 +597,13 @@ sntp_dns_found(const char *hostname, const ip_addr_t *ipaddr, void *arg)
   if (ipaddr != NULL) {
     /* Address resolved, send request */
     LWIP_DEBUGF(SNTP_DEBUG_STATE, ("sntp_dns_found: Server address resolved, sending request\n"));
+    iotc_dns_cache_store(hostname, ipaddr); /* IoTConnect SDK: share the result */
     sntp_servers[sntp_current_server].addr = *ipaddr;
     sntp_send_request(ipaddr);
   } else {
     /* DNS resolving failed -> try another server */
     LWIP_DEBUGF(SNTP_DEBUG_WARN_STATE, ("sntp_dns_found: Failed to resolve server address resolved, trying next server\n"));
+    iotc_dns_cache_store(hostname, NULL); /* IoTConnect SDK: share the result */
     sntp_try_next_server(NULL);
   }
 }
@@ -622,10 +625,21 @@ sntp_request(void *arg)
   /* initialize SNTP server address */
 #if SNTP_SERVER_DNS
   if (sntp_servers[sntp_current_server].name) {
-    /* always resolve the name and rely on dns-internal caching & timeout */
+    /* IoTConnect SDK: use the SDK DNS cache that is shared with the HTTP, MQTT and OTA clients */
+    IotcDnsCacheResult cache_result = iotc_dns_cache_lookup(sntp_servers[sntp_current_server].name, &sntp_server_address);
     ip_addr_set_zero(&sntp_servers[sntp_current_server].addr);
-    err = dns_gethostbyname(sntp_servers[sntp_current_server].name, &sntp_server_address,
-                            sntp_dns_found, NULL);
+    if (cache_result == IOTC_DNS_CACHE_HIT) {
+      err = ERR_OK;
+    } else if (cache_result == IOTC_DNS_CACHE_NEGATIVE) {
+      err = ERR_ARG;
+    } else {
+      /* always resolve the name and rely on dns-internal caching & timeout */
+      err = dns_gethostbyname(sntp_servers[sntp_current_server].name, &sntp_server_address,
+                              sntp_dns_found, NULL);
+      if (err == ERR_OK) {
+        iotc_dns_cache_store(sntp_servers[sntp_current_server].name, &sntp_server_address);
+      }
+    }
     if (err == ERR_INPROGRESS) {
       /* DNS request sent, wait for sntp_dns_found being called */
       LWIP_DEBUGF(SNTP_DEBUG_STATE, ("sntp_request: Waiting for server address to be resolved.\n"));
@@ -0,0 +1,90 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: MIT
+# Copyright (C) 2025 Avnet
+# Authors: Nikola Markovic <nikola.markovic@avnet.com> et al.
+#
+# Writes a pair of firmware-like images for the OTA decoder tests. Usage:
+#   python3 ota_images.py <running image>.bin <new image>.bin
+#
+# The images are made of Thumb-like instruction words, literal pools with flash addresses, strings and padding.
+# The new image is the running image with code inserted and removed, so that the addresses that follow move,
+# a changed string, and data appended at the end, which is what a small firmware change looks like to the delta tool.
+
+import random
+import struct
+import sys
+
+SIZE = 64 * 1024
+FLASH_BASE = 0x08000000
+
+WORDS = [
+    'Hello from the device', 'IOTC: Connected', 'temperature', 'humidity', 'version',
+    'Failed to open the file', 'OTA download complete', 'Out of memory', '%s:%d %s\n', 'mqtt',
+]
+
+
+def make_source(rng):
+    out = bytearray()
+    addresses = []  # offsets of the literal pool words that hold flash addresses
+    opcodes = [rng.randrange(0x10000) for _ in range(100)]
+    while len(out) < SIZE:
+        kind = rng.random()
+        if kind < 0.75:
+            # a function: mostly common opcodes, some with random immediates
+            for _ in range(rng.randrange(8, 120)):
+                if rng.random() < 0.95:
+                    out += struct.pack('<H', opcodes[int(rng.triangular(0, len(opcodes), 0))])
+                else:
+                    out += struct.pack('<H', rng.randrange(0x10000))
+            # its literal pool
+            while len(out) % 4:
+                out.append(0)
+            for _ in range(rng.randrange(1, 6)):
+                addresses.append(len(out))
+                out += struct.pack('<I', FLASH_BASE + rng.randrange(SIZE) & ~3)
+        elif kind < 0.9:
+            out += rng.choice(WORDS).encode() + b'\0'
+        else:
+            out += (b'\xff' if rng.random() < 0.5 else b'\0') * rng.randrange(4, 200)
+    return bytearray(out[:SIZE]), [a for a in addresses if a + 4 <= SIZE]
+
+
+def make_target(rng, source, addresses):
+    insert_at = SIZE * 3 // 10 & ~3
+    remove_at = SIZE * 6 // 10 & ~3
+    inserted = bytes(rng.randrange(256) for _ in range(512))
+    removed = 128
+
+    # addresses of code that moved change by the net amount of code inserted before them
+    target = bytearray(source)
+    for a in addresses:
+        value, = struct.unpack_from('<I', target, a)
+        moved = value - FLASH_BASE
+        shift = (len(inserted) if moved >= insert_at else 0) - (removed if moved >= remove_at else 0)
+        struct.pack_into('<I', target, a, (value + shift) & 0xffffffff)
+
+    string_at = bytes(source).find(b'OTA download complete')
+    if string_at >= 0:
+        target[string_at:string_at + 8] = b'Download'
+
+    target = target[:insert_at] + inserted + target[insert_at:remove_at] + target[remove_at + removed:]
+    target += bytes(rng.randrange(256) for _ in range(1000))
+    return bytes(target)
+
+
+def main(argv):
+    if len(argv) != 3:
+        print('Usage: %s <running image>.bin <new image>.bin' % argv[0])
+        return 1
+    rng = random.Random(2025)
+    source, addresses = make_source(rng)
+    target = make_target(rng, source, addresses)
+    with open(argv[1], 'wb') as f:
+        f.write(source)
+    with open(argv[2], 'wb') as f:
+        f.write(target)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
@@ -0,0 +1,7 @@
+/* SPDX-License-Identifier: MIT
+ * Copyright (C) 2025 Avnet
+ * Authors: Nikola Markovic <nikola.markovic@avnet.com> et al.
+ */
+
+// Host test stand-in. The tests are single threaded.
+#pragma once
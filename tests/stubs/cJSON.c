@@ -0,0 +1,312 @@
+/* SPDX-License-Identifier: MIT
+ * Copyright (C) 2025 Avnet
+ * Authors: Nikola Markovic <nikola.markovic@avnet.com> et al.
+ */
+
+// Host test stand-in for cJSON. See cJSON.h. Only unformatted printing is supported.
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "cJSON.h"
+
+#define DEFAULT_PRINT_BUFFER_SIZE 256
+
+static cJSON_Hooks hooks = {malloc, free};
+
+typedef struct {
+    char *buffer;
+    size_t size;
+    size_t offset;
+    bool is_preallocated;
+} PrintBuffer;
+
+void cJSON_InitHooks(cJSON_Hooks *h) {
+    hooks.malloc_fn = (h && h->malloc_fn) ? h->malloc_fn : malloc;
+    hooks.free_fn = (h && h->free_fn) ? h->free_fn : free;
+}
+
+void *cJSON_malloc(size_t size) {
+    return hooks.malloc_fn(size);
+}
+
+void cJSON_free(void *object) {
+    hooks.free_fn(object);
+}
+
+static char *copy_string(const char *str) {
+    size_t len = strlen(str) + 1;
+    char *copy = hooks.malloc_fn(len);
+    if (copy) {
+        memcpy(copy, str, len);
+    }
+    return copy;
+}
+
+static cJSON *new_item(int type) {
+    cJSON *item = hooks.malloc_fn(sizeof(cJSON));
+    if (item) {
+        memset(item, 0, sizeof(cJSON));
+        item->type = type;
+    }
+    return item;
+}
+
+cJSON *cJSON_CreateObject(void) {
+    return new_item(cJSON_Object);
+}
+
+cJSON *cJSON_CreateArray(void) {
+    return new_item(cJSON_Array);
+}
+
+void cJSON_Delete(cJSON *item) {
+    while (item) {
+        cJSON *next = item->next;
+        cJSON_Delete(item->child);
+        if (item->valuestring) {
+            hooks.free_fn(item->valuestring);
+        }
+        if (item->string) {
+            hooks.free_fn(item->string);
+        }
+        hooks.free_fn(item);
+        item = next;
+    }
+}
+
+cJSON_bool cJSON_AddItemToArray(cJSON *array, cJSON *item) {
+    if (!array || !item) {
+        return false;
+    }
+    if (!array->child) {
+        array->child = item;
+        item->prev = item; // the first item's prev points to the last one, like in cJSON
+    } else {
+        cJSON *last = array->child->prev;
+        last->next = item;
+        item->prev = last;
+        array->child->prev = item;
+    }
+    return true;
+}
+
+static cJSON *add_to_object(cJSON *object, const char *name, cJSON *item) {
+    if (!object || !name || !item) {
+        cJSON_Delete(item);
+        return NULL;
+    }
+    item->string = copy_string(name);
+    if (!item->string) {
+        cJSON_Delete(item);
+        return NULL;
+    }
+    cJSON_AddItemToArray(object, item);
+    return item;
+}
+
+cJSON *cJSON_AddObjectToObject(cJSON * const object, const char * const name) {
+    return add_to_object(object, name, cJSON_CreateObject());
+}
+
+cJSON *cJSON_AddArrayToObject(cJSON * const object, const char * const name) {
+    return add_to_object(object, name, cJSON_CreateArray());
+}
+
+cJSON *cJSON_AddNumberToObject(cJSON * const object, const char * const name, const double number) {
+    cJSON *item = new_item(cJSON_Number);
+    if (item) {
+        item->valuedouble = number;
+        // saturating, like cJSON_SetNumberHelper()
+        if (number >= 2147483647.0) {
+            item->valueint = 2147483647;
+        } else if (number <= -2147483648.0) {
+            item->valueint = -2147483647 - 1;
+        } else {
+            item->valueint = (int) number;
+        }
+    }
+    return add_to_object(object, name, item);
+}
+
+cJSON *cJSON_AddStringToObject(cJSON * const object, const char * const name, const char * const string) {
+    cJSON *item = new_item(cJSON_String);
+    if (item) {
+        item->valuestring = copy_string(string);
+        if (!item->valuestring) {
+            cJSON_Delete(item);
+            return NULL;
+        }
+    }
+    return add_to_object(object, name, item);
+}
+
+cJSON *cJSON_AddBoolToObject(cJSON * const object, const char * const name, const cJSON_bool boolean) {
+    return add_to_object(object, name, new_item(boolean ? cJSON_True : cJSON_False));
+}
+
+cJSON *cJSON_AddNullToObject(cJSON * const object, const char * const name) {
+    return add_to_object(object, name, new_item(cJSON_NULL));
+}
+
+// Makes room for needed more bytes. Grows a heap buffer to twice the needed size, like cJSON's ensure().
+static char *ensure(PrintBuffer *p, size_t needed) {
+    if (!p->buffer) {
+        return NULL;
+    }
+    needed += p->offset + 1;
+    if (needed <= p->size) {
+        return p->buffer + p->offset;
+    }
+    if (p->is_preallocated) {
+        return NULL;
+    }
+    size_t new_size = needed * 2;
+    // the SDK installs its own hooks, so cJSON cannot use realloc() and copies instead
+    char *new_buffer = hooks.malloc_fn(new_size);
+    if (!new_buffer) {
+        hooks.free_fn(p->buffer);
+        p->buffer = NULL;
+        return NULL;
+    }
+    memcpy(new_buffer, p->buffer, p->offset + 1);
+    hooks.free_fn(p->buffer);
+    p->buffer = new_buffer;
+    p->size = new_size;
+    return p->buffer + p->offset;
+}
+
+static bool print_raw(PrintBuffer *p, const char *str, size_t len) {
+    char *out = ensure(p, len);
+    if (!out) {
+        return false;
+    }
+    memcpy(out, str, len);
+    out[len] = 0;
+    p->offset += len;
+    return true;
+}
+
+static bool print_number(const cJSON *item, PrintBuffer *p) {
+    char number_buffer[26];
+    double d = item->valuedouble;
+    double test = 0.0;
+    int len;
+    if (isnan(d) || isinf(d)) {
+        len = snprintf(number_buffer, sizeof(number_buffer), "null");
+    } else if (d == (double) item->valueint) {
+        len = snprintf(number_buffer, sizeof(number_buffer), "%d", item->valueint);
+    } else {
+        // try 15 digits first, and 17 if that does not parse back to the same value
+        len = snprintf(number_buffer, sizeof(number_buffer), "%1.15g", d);
+        if (1 != sscanf(number_buffer, "%lg", &test) || test != d) {
+            len = snprintf(number_buffer, sizeof(number_buffer), "%1.17g", d);
+        }
+    }
+    return print_raw(p, number_buffer, (size_t) len);
+}
+
+static bool print_string(const char *str, PrintBuffer *p) {
+    size_t len = 2;
+    for (const unsigned char *s = (const unsigned char *) str; *s; s++) {
+        switch (*s) {
+            case '"': case '\\': case '\b': case '\f': case '\n': case '\r': case '\t':
+                len += 2;
+                break;
+            default:
+                len += *s < 32 ? 6 : 1;
+                break;
+        }
+    }
+    char *out = ensure(p, len);
+    if (!out) {
+        return false;
+    }
+    *out++ = '"';
+    for (const unsigned char *s = (const unsigned char *) str; *s; s++) {
+        if (*s >= 32 && *s != '"' && *s != '\\') {
+            *out++ = (char) *s;
+            continue;
+        }
+        *out++ = '\\';
+        switch (*s) {
+            case '"': *out++ = '"'; break;
+            case '\\': *out++ = '\\'; break;
+            case '\b': *out++ = 'b'; break;
+            case '\f': *out++ = 'f'; break;
+            case '\n': *out++ = 'n'; break;
+            case '\r': *out++ = 'r'; break;
+            case '\t': *out++ = 't'; break;
+            default:
+                sprintf(out, "u%04x", *s);
+                out += 5;
+                break;
+        }
+    }
+    *out++ = '"';
+    *out = 0;
+    p->offset += len;
+    return true;
+}
+
+static bool print_value(const cJSON *item, PrintBuffer *p) {
+    switch (item->type) {
+        case cJSON_NULL: return print_raw(p, "null", 4);
+        case cJSON_False: return print_raw(p, "false", 5);
+        case cJSON_True: return print_raw(p, "true", 4);
+        case cJSON_Number: return print_number(item, p);
+        case cJSON_String: return print_string(item->valuestring ? item->valuestring : "", p);
+        case cJSON_Array:
+        case cJSON_Object: {
+            bool is_object = cJSON_Object == item->type;
+            if (!print_raw(p, is_object ? "{" : "[", 1)) {
+                return false;
+            }
+            for (const cJSON *child = item->child; child; child = child->next) {
+                if (is_object && (!print_string(child->string, p) || !print_raw(p, ":", 1))) {
+                    return false;
+                }
+                if (!print_value(child, p) || (child->next && !print_raw(p, ",", 1))) {
+                    return false;
+                }
+            }
+            return print_raw(p, is_object ? "}" : "]", 1);
+        }
+        default:
+            return false;
+    }
+}
+
+char *cJSON_PrintUnformatted(const cJSON *item) {
+    PrintBuffer p = {hooks.malloc_fn(DEFAULT_PRINT_BUFFER_SIZE), DEFAULT_PRINT_BUFFER_SIZE, 0, false};
+    if (!p.buffer) {
+        return NULL;
+    }
+    p.buffer[0] = 0;
+    if (!item || !print_value(item, &p)) {
+        if (p.buffer) {
+            hooks.free_fn(p.buffer);
+        }
+        return NULL;
+    }
+    // copied into an exact size string
+    char *printed = hooks.malloc_fn(p.offset + 1);
+    if (printed) {
+        memcpy(printed, p.buffer, p.offset + 1);
+    }
+    hooks.free_fn(p.buffer);
+    return printed;
+}
+
+cJSON_bool cJSON_PrintPreallocated(cJSON *item, char *buffer, const int length, const cJSON_bool format) {
+    (void) format;
+    if (!buffer || length <= 0) {
+        return false;
+    }
+    PrintBuffer p = {buffer, (size_t) length, 0, true};
+    buffer[0] = 0;
+    return item && print_value(item, &p);
+}
@@ -0,0 +1,56 @@
+/* SPDX-License-Identifier: MIT
+ * Copyright (C) 2025 Avnet
+ * Authors: Nikola Markovic <nikola.markovic@avnet.com> et al.
+ */
+
+// Host test stand-in for the parts of cJSON that the tested modules and benchmarks use.
+// Trees, hooks and printing work the way they do in cJSON 1.7, including its number formatting
+// and the way it grows the print buffer, so that the benchmarks compare against comparable work.
+#pragma once
+
+#include <stddef.h>
+
+#define cJSON_Invalid (0)
+#define cJSON_False  (1 << 0)
+#define cJSON_True   (1 << 1)
+#define cJSON_NULL   (1 << 2)
+#define cJSON_Number (1 << 3)
+#define cJSON_String (1 << 4)
+#define cJSON_Array  (1 << 5)
+#define cJSON_Object (1 << 6)
+
+typedef int cJSON_bool;
+
+typedef struct cJSON {
+    struct cJSON *next;
+    struct cJSON *prev;
+    struct cJSON *child;
+    int type;
+    char *valuestring;
+    int valueint;
+    double valuedouble;
+    char *string;
+} cJSON;
+
+typedef struct cJSON_Hooks {
+    void *(*malloc_fn)(size_t sz);
+    void (*free_fn)(void *ptr);
+} cJSON_Hooks;
+
+void cJSON_InitHooks(cJSON_Hooks *hooks);
+void *cJSON_malloc(size_t size);
+void cJSON_free(void *object);
+
+cJSON *cJSON_CreateObject(void);
+cJSON *cJSON_CreateArray(void);
+cJSON_bool cJSON_AddItemToArray(cJSON *array, cJSON *item);
+cJSON *cJSON_AddObjectToObject(cJSON * const object, const char * const name);
+cJSON *cJSON_AddArrayToObject(cJSON * const object, const char * const name);
+cJSON *cJSON_AddNumberToObject(cJSON * const object, const char * const name, const double number);
+cJSON *cJSON_AddStringToObject(cJSON * const object, const char * const name, const char * const string);
+cJSON *cJSON_AddBoolToObject(cJSON * const object, const char * const name, const cJSON_bool boolean);
+cJSON *cJSON_AddNullToObject(cJSON * const object, const char * const name);
+void cJSON_Delete(cJSON *item);
+
+char *cJSON_PrintUnformatted(const cJSON *item);
+cJSON_bool cJSON_PrintPreallocated(cJSON *item, char *buffer, const int length, const cJSON_bool format);
@@ -0,0 +1,13 @@
+/* SPDX-License-Identifier: MIT
+ * Copyright (C) 2025 Avnet
+ * Authors: Nikola Markovic <nikola.markovic@avnet.com> et al.
+ */
+
+// Host test stand-in for the ModusToolbox result codes
+#pragma once
+
+#include <stdint.h>
+
+typedef uint32_t cy_rslt_t;
+
+#define CY_RSLT_SUCCESS ((cy_rslt_t) 0u)
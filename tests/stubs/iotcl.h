@@ -0,0 +1,31 @@
+/* SPDX-License-Identifier: MIT
+ * Copyright (C) 2025 Avnet
+ * Authors: Nikola Markovic <nikola.markovic@avnet.com> et al.
+ */
+
+// Host test stand-in for the parts of iotc-c-lib that the tested modules use
+#pragma once
+
+#include <stdlib.h>
+#include <stdbool.h>
+
+#define IOTCL_SUCCESS 0
+#define IOTCL_ERR_FAILED (-1)
+#define IOTCL_ERR_OUT_OF_MEMORY (-2)
+#define IOTCL_ERR_BAD_VALUE (-3)
+
+#define iotcl_malloc malloc
+#define iotcl_free free
+
+// Telemetry, implemented in iotcl_telemetry.c the way iotc-c-lib builds it, for the benchmarks to compare against
+
+typedef struct IotclMessageHandleTag *IotclMessageHandle;
+
+IotclMessageHandle iotcl_telemetry_create(void);
+void iotcl_telemetry_destroy(IotclMessageHandle message);
+int iotcl_telemetry_set_number(IotclMessageHandle message, const char *path, double value);
+int iotcl_telemetry_set_bool(IotclMessageHandle message, const char *path, bool value);
+int iotcl_telemetry_set_string(IotclMessageHandle message, const char *path, const char *value);
+int iotcl_telemetry_set_null(IotclMessageHandle message, const char *path);
+char *iotcl_telemetry_create_serialized_string(IotclMessageHandle message, bool pretty);
+void iotcl_telemetry_destroy_serialized(char *serialized_string);
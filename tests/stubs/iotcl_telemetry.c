@@ -0,0 +1,125 @@
+/* SPDX-License-Identifier: MIT
+ * Copyright (C) 2025 Avnet
+ * Authors: Nikola Markovic <nikola.markovic@avnet.com> et al.
+ */
+
+// Host test stand-in for the iotc-c-lib telemetry. Like iotc-c-lib, it builds a cJSON tree
+// {"d":[{"dt":"<now>","d":{<attributes>}}]} with a node per attribute, where a dotted path like "a.b" sets
+// the attribute b of the object a, and prints the tree with cJSON_PrintUnformatted().
+
+#include <string.h>
+#include <time.h>
+
+#include "cJSON.h"
+#include "iotcl.h"
+
+#define PATH_SIZE 64
+
+struct IotclMessageHandleTag {
+    cJSON *root;
+    cJSON *data_array;
+    cJSON *current_data; // the "d" object of the current entry, created with the first attribute
+};
+
+// Same format as iotcl_iso_timestamp_now()
+static const char *iso_timestamp_now(void) {
+    static char buffer[sizeof("2025-01-31T12:00:00.000Z")];
+    time_t now = time(NULL);
+    strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%S.000Z", gmtime(&now));
+    return buffer;
+}
+
+IotclMessageHandle iotcl_telemetry_create(void) {
+    IotclMessageHandle message = cJSON_malloc(sizeof(struct IotclMessageHandleTag));
+    if (!message) {
+        return NULL;
+    }
+    message->current_data = NULL;
+    message->root = cJSON_CreateObject();
+    message->data_array = message->root ? cJSON_AddArrayToObject(message->root, "d") : NULL;
+    if (!message->data_array) {
+        iotcl_telemetry_destroy(message);
+        return NULL;
+    }
+    return message;
+}
+
+void iotcl_telemetry_destroy(IotclMessageHandle message) {
+    if (message) {
+        cJSON_Delete(message->root);
+        cJSON_free(message);
+    }
+}
+
+// Returns the object that holds the last element of the path, and the name of that element in *name
+static cJSON *parent_of(IotclMessageHandle message, const char *path, char *name_buffer, const char **name) {
+    if (!message || !path) {
+        return NULL;
+    }
+    if (!message->current_data) {
+        cJSON *entry = cJSON_CreateObject();
+        if (!entry || !cJSON_AddItemToArray(message->data_array, entry)
+                || !cJSON_AddStringToObject(entry, "dt", iso_timestamp_now())) {
+            return NULL;
+        }
+        message->current_data = cJSON_AddObjectToObject(entry, "d");
+    }
+    cJSON *parent = message->current_data;
+    const char *dot = strchr(path, '.');
+    if (!dot) {
+        *name = path;
+        return parent;
+    }
+    size_t len = (size_t) (dot - path);
+    if (len >= PATH_SIZE) {
+        return NULL;
+    }
+    memcpy(name_buffer, path, len);
+    name_buffer[len] = 0;
+    cJSON *object = NULL;
+    for (cJSON *child = parent ? parent->child : NULL; child; child = child->next) {
+        if (cJSON_Object == child->type && 0 == strcmp(child->string, name_buffer)) {
+            object = child;
+            break;
+        }
+    }
+    *name = dot + 1;
+    return object ? object : cJSON_AddObjectToObject(parent, name_buffer);
+}
+
+int iotcl_telemetry_set_number(IotclMessageHandle message, const char *path, double value) {
+    char name_buffer[PATH_SIZE];
+    const char *name = NULL;
+    cJSON *parent = parent_of(message, path, name_buffer, &name);
+    return parent && cJSON_AddNumberToObject(parent, name, value) ? IOTCL_SUCCESS : IOTCL_ERR_OUT_OF_MEMORY;
+}
+
+int iotcl_telemetry_set_bool(IotclMessageHandle message, const char *path, bool value) {
+    char name_buffer[PATH_SIZE];
+    const char *name = NULL;
+    cJSON *parent = parent_of(message, path, name_buffer, &name);
+    return parent && cJSON_AddBoolToObject(parent, name, value) ? IOTCL_SUCCESS : IOTCL_ERR_OUT_OF_MEMORY;
+}
+
+int iotcl_telemetry_set_string(IotclMessageHandle message, const char *path, const char *value) {
+    char name_buffer[PATH_SIZE];
+    const char *name = NULL;
+    cJSON *parent = parent_of(message, path, name_buffer, &name);
+    return parent && cJSON_AddStringToObject(parent, name, value) ? IOTCL_SUCCESS : IOTCL_ERR_OUT_OF_MEMORY;
+}
+
+int iotcl_telemetry_set_null(IotclMessageHandle message, const char *path) {
+    char name_buffer[PATH_SIZE];
+    const char *name = NULL;
+    cJSON *parent = parent_of(message, path, name_buffer, &name);
+    return parent && cJSON_AddNullToObject(parent, name) ? IOTCL_SUCCESS : IOTCL_ERR_OUT_OF_MEMORY;
+}
+
+char *iotcl_telemetry_create_serialized_string(IotclMessageHandle message, bool pretty) {
+    (void) pretty; // the stand-in cJSON prints unformatted only
+    return message ? cJSON_PrintUnformatted(message->root) : NULL;
+}
+
+void iotcl_telemetry_destroy_serialized(char *serialized_string) {
+    cJSON_free(serialized_string);
+}
@@ -0,0 +1,12 @@
+/* SPDX-License-Identifier: MIT
+ * Copyright (C) 2025 Avnet
+ * Authors: Nikola Markovic <nikola.markovic@avnet.com> et al.
+ */
+
+// Host test stand-in for include/iotconnect.h, which needs the whole ModusToolbox environment.
+// The tests implement iotconnect_sdk_send_telemetry_json() to capture what would be published.
+#pragma once
+
+#include "cy_result.h"
+
+cy_rslt_t iotconnect_sdk_send_telemetry_json(const char *json);
@@ -0,0 +1,14 @@
+/* SPDX-License-Identifier: MIT
+ * Copyright (C) 2025 Avnet
+ * Authors: Nikola Markovic <nikola.markovic@avnet.com> et al.
+ */
+
+// Host test stand-in. The tests are single threaded, so critical sections do nothing.
+#pragma once
+
+typedef void *TaskHandle_t;
+
+#define taskENTER_CRITICAL()
+#define taskEXIT_CRITICAL()
+
+#define xTaskGetCurrentTaskHandle() ((TaskHandle_t) 1)
@@ -0,0 +1,206 @@
+/* SPDX-License-Identifier: MIT
+ * Copyright (C) 2025 Avnet
+ * Authors: Nikola Markovic <nikola.markovic@avnet.com> et al.
+ */
+
+// Checks iotc_fmt against printf and strtod. With --bench, compares its speed with the cJSON number printing instead.
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <math.h>
+#include <time.h>
+
+#include "test_util.h"
+
+#include "iotc_fmt.h"
+
+#define RANDOM_COUNT 1000000
+
+static double random_double(void) {
+    while (true) {
+        uint64_t bits = next_random();
+        double d;
+        memcpy(&d, &bits, sizeof(d));
+        if (isfinite(d)) {
+            return d;
+        }
+    }
+}
+
+// cJSON print_number(): "%1.15g", or "%1.17g" if that does not parse back to the same value
+static size_t cjson_format(char *buf, double d) {
+    int len = snprintf(buf, IOTC_FMT_BUFFER_SIZE, "%1.15g", d);
+    if (strtod(buf, NULL) != d) {
+        len = snprintf(buf, IOTC_FMT_BUFFER_SIZE, "%1.17g", d);
+    }
+    return (size_t) len;
+}
+
+// Length of the digits of the shortest %g representation that parses back to d
+static int shortest_digits(double d) {
+    char buf[40];
+    for (int precision = 1; precision <= 17; precision++) {
+        snprintf(buf, sizeof(buf), "%.*e", precision - 1, d);
+        if (strtod(buf, NULL) == d) {
+            return precision;
+        }
+    }
+    return 17;
+}
+
+// Number of significant digits of the mantissa. Leading and trailing zeros do not count.
+static int count_digits(const char *s) {
+    int first = -1;
+    int last = -1;
+    int position = 0;
+    for (; *s && *s != 'e'; s++) {
+        if (*s >= '1' && *s <= '9') {
+            if (first < 0) {
+                first = position;
+            }
+            last = position;
+        }
+        if (*s >= '0' && *s <= '9') {
+            position++;
+        }
+    }
+    return first < 0 ? 1 : last - first + 1;
+}
+
+static void test_int(void) {
+    static const int64_t values[] = {
+        0, 1, -1, 9, 10, 99, 100, 12345, -12345, INT32_MAX, INT32_MIN, INT64_MAX, INT64_MIN,
+        1000000000000000000LL, -999999999999999999LL
+    };
+    char buf[IOTC_FMT_BUFFER_SIZE];
+    char expected[32];
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        size_t len = iotc_fmt_int(buf, values[i]);
+        snprintf(expected, sizeof(expected), "%" PRId64, values[i]);
+        CHECK(0 == strcmp(buf, expected) && len == strlen(expected), "int %s != %s", buf, expected);
+    }
+    for (int i = 0; i < RANDOM_COUNT; i++) {
+        int64_t v = (int64_t) next_random() >> (next_random() % 64);
+        iotc_fmt_int(buf, v);
+        snprintf(expected, sizeof(expected), "%" PRId64, v);
+        CHECK(0 == strcmp(buf, expected), "int %s != %s", buf, expected);
+    }
+}
+
+static void test_double_layout(void) {
+    static const struct {
+        double value;
+        const char *expected;
+    } cases[] = {
+        {0.0, "0"}, {-0.0, "0"}, {3.0, "3"}, {-42.0, "-42"}, {0.5, "0.5"}, {23.5, "23.5"},
+        {0.1, "0.1"}, {0.0001, "0.0001"}, {0.00001, "1e-05"}, {1e15, "1e+15"}, {123456789012345.0, "123456789012345"},
+        {1e21, "1e+21"}, {1.5e300, "1.5e+300"}, {5e-324, "5e-324"}, {1.7976931348623157e308, "1.7976931348623157e+308"},
+        {0.30000000000000004, "0.30000000000000004"}, {1234567890123456.0, "1234567890123456"},
+        {1234567890123456.8, "1234567890123456.8"}, {2.2250738585072014e-308, "2.2250738585072014e-308"}, {NAN, "null"}, {INFINITY, "null"}, {-INFINITY, "null"},
+    };
+    char buf[IOTC_FMT_BUFFER_SIZE];
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        size_t len = iotc_fmt_double(buf, cases[i].value);
+        CHECK(0 == strcmp(buf, cases[i].expected) && len == strlen(buf), "double %s != %s", buf, cases[i].expected);
+    }
+}
+
+static void test_double_round_trip(void) {
+    char buf[IOTC_FMT_BUFFER_SIZE];
+    char cjson[IOTC_FMT_BUFFER_SIZE];
+    int shorter_than_cjson = 0;
+    for (int i = 0; i < RANDOM_COUNT; i++) {
+        // half of the values are in the range of typical sensor readings
+        double d = (i & 1) ? random_double() : (double) (int64_t) (next_random() % 2000000) / 1000.0 - 1000.0;
+        size_t len = iotc_fmt_double(buf, d);
+        CHECK(len == strlen(buf) && len < IOTC_FMT_BUFFER_SIZE, "double %.17g length %zu", d, len);
+        CHECK(strtod(buf, NULL) == d, "double %.17g formatted as %s does not round-trip", d, buf);
+        int digits = count_digits(buf);
+        int shortest = shortest_digits(d);
+        CHECK(digits == shortest, "double %.17g formatted as %s, %d digits instead of %d", d, buf, digits, shortest);
+        size_t cjson_len = cjson_format(cjson, d);
+        CHECK(len <= cjson_len, "double %.17g formatted as %s, longer than cJSON %s", d, buf, cjson);
+        if (len < cjson_len) {
+            shorter_than_cjson++;
+        }
+    }
+    printf("%d of %d doubles were shorter than with cJSON.\n", shorter_than_cjson, RANDOM_COUNT);
+}
+
+static void test_fixed(void) {
+    static const struct {
+        double value;
+        int decimals;
+        const char *expected;
+    } cases[] = {
+        {23.456, 2, "23.46"}, {23.001, 2, "23"}, {-0.5, 0, "-1"}, {0.05, 1, "0.1"}, {-1.25, 3, "-1.25"},
+        {1.000000001, 9, "1.000000001"}, {12.3, 12, "12.3"}, {1e300, 2, "1e+300"},
+    };
+    char buf[IOTC_FMT_BUFFER_SIZE];
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        iotc_fmt_fixed(buf, cases[i].value, cases[i].decimals);
+        CHECK(0 == strcmp(buf, cases[i].expected), "fixed %s != %s", buf, cases[i].expected);
+    }
+    for (int i = 0; i < RANDOM_COUNT; i++) {
+        int decimals = (int) (next_random() % 10);
+        double d = (double) (int64_t) (next_random() % 2000000000) / 1000.0 - 1000000.0;
+        iotc_fmt_fixed(buf, d, decimals);
+        double parsed = strtod(buf, NULL);
+        // scaling by 10^decimals can round a value just below a half up
+        CHECK(fabs(parsed - d) <= 0.5 * pow(10, -decimals) + fabs(d) * 4e-16, "fixed %.17g with %d decimals is %s", d, decimals, buf);
+    }
+}
+
+static void test_iso_time(void) {
+    char buf[IOTC_FMT_ISO_TIME_SIZE];
+    size_t len = iotc_fmt_iso_time(buf, (time_t) 1738324800);
+    CHECK(0 == strcmp(buf, "2025-01-31T12:00:00.000Z") && 24 == len, "time %s", buf);
+}
+
+static void bench(void) {
+    static double values[RANDOM_COUNT];
+    char buf[IOTC_FMT_BUFFER_SIZE];
+    struct timespec start;
+    size_t total = 0;
+
+    for (int i = 0; i < RANDOM_COUNT; i++) {
+        values[i] = (i & 1) ? random_double() : (double) (int64_t) (next_random() % 2000000) / 1000.0 - 1000.0;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < RANDOM_COUNT; i++) {
+        total += iotc_fmt_double(buf, values[i]);
+    }
+    double fmt_s = elapsed_s(&start);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < RANDOM_COUNT; i++) {
+        total += cjson_format(buf, values[i]);
+    }
+    double cjson_s = elapsed_s(&start);
+
+    printf("%d doubles: iotc_fmt_double %.3f s, cJSON snprintf/strtod %.3f s (%.1fx). %zu bytes\n",
+            RANDOM_COUNT, fmt_s, cjson_s, cjson_s / fmt_s, total);
+}
+
+int main(int argc, char *argv[]) {
+    if (argc > 1 && 0 == strcmp(argv[1], "--bench")) {
+        bench();
+        return 0;
+    }
+    test_int();
+    test_double_layout();
+    test_double_round_trip();
+    test_fixed();
+    test_iso_time();
+    if (failures) {
+        printf("%d failures\n", failures);
+        return 1;
+    }
+    printf("OK\n");
+    return 0;
+}
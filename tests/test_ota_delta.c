@@ -0,0 +1,171 @@
+/* SPDX-License-Identifier: MIT
+ * Copyright (C) 2025 Avnet
+ * Authors: Nikola Markovic <nikola.markovic@avnet.com> et al.
+ */
+
+// Applies a delta made by tools/iotc_ota_delta.py with the device decoder, feeding it input chunks of 1 to 100000 bytes
+// and output buffers of 1 to 4096 bytes, and checks that it rebuilds the new image. Also checks that a delta for
+// another image, and corrupted or truncated deltas, are rejected. The images and the delta are made by the Makefile.
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "test_util.h"
+
+#include "iotc_ota_delta.h"
+
+#define RANDOM_ROUNDS 200
+
+static Buffer source;
+static Buffer target;
+static Buffer delta;
+
+static int read_source(uint32_t offset, uint8_t *buf, size_t len) {
+    if (offset > source.len || len > source.len - offset) {
+        return -1;
+    }
+    memcpy(buf, &source.data[offset], len);
+    return 0;
+}
+
+// Decodes the delta with the given input chunk and output buffer sizes, or random ones for each call if 0.
+// The decoder state is copied to a new struct between calls, like a download that is resumed from saved state.
+// Returns the decoder status. *result receives the output, which is allocated with the size of the target image.
+static int decode(const Buffer *d, size_t chunk, size_t out_size, Buffer *result, bool *is_complete) {
+    IotcOtaDelta decoder;
+    uint8_t out[4096];
+    size_t pos = 0;
+    int status = IOTC_OTA_DELTA_OK;
+
+    result->data = malloc(target.len);
+    result->len = 0;
+    iotc_ota_delta_init(&decoder);
+    while (true) {
+        size_t in_len = chunk ? chunk : random_size(100000);
+        size_t out_len = out_size ? out_size : random_size(sizeof(out));
+        size_t in_used = 0;
+        size_t produced = 0;
+        if (in_len > d->len - pos) {
+            in_len = d->len - pos;
+        }
+        status = iotc_ota_delta_process(&decoder, read_source, &d->data[pos], in_len, &in_used, out, out_len, &produced);
+        if (IOTC_OTA_DELTA_OK != status) {
+            break;
+        }
+        if (produced > target.len - result->len) {
+            status = IOTC_OTA_DELTA_ERR_FORMAT; // the decoder should have stopped at the target size
+            break;
+        }
+        memcpy(&result->data[result->len], out, produced);
+        result->len += produced;
+        pos += in_used;
+        if (0 == in_used && 0 == produced) {
+            break;
+        }
+        IotcOtaDelta resumed = decoder;
+        decoder = resumed;
+    }
+    *is_complete = pos == d->len && iotc_ota_delta_is_complete(&decoder);
+    return status;
+}
+
+static void check_decode(size_t chunk, size_t out_size) {
+    Buffer result;
+    bool is_complete;
+    int status = decode(&delta, chunk, out_size, &result, &is_complete);
+    CHECK(IOTC_OTA_DELTA_OK == status && is_complete && result.len == target.len
+            && 0 == memcmp(result.data, target.data, target.len),
+            "chunk %zu, output %zu: status %d, complete %d, %zu of %zu bytes",
+            chunk, out_size, status, is_complete, result.len, target.len);
+    free(result.data);
+}
+
+static void test_sizes(void) {
+    static const size_t chunks[] = {1, 2, 3, 5, 9, 20, 21, 64, 511, 4096, 100000};
+    static const size_t out_sizes[] = {1, 2, 7, 64, 1000, 4096};
+    for (size_t i = 0; i < sizeof(chunks) / sizeof(chunks[0]); i++) {
+        for (size_t j = 0; j < sizeof(out_sizes) / sizeof(out_sizes[0]); j++) {
+            check_decode(chunks[i], out_sizes[j]);
+        }
+    }
+    for (int i = 0; i < RANDOM_ROUNDS; i++) {
+        check_decode(0, 0);
+    }
+}
+
+static void test_header(void) {
+    CHECK(iotc_ota_delta_is_delta(delta.data, delta.len), "is_delta");
+    CHECK(!iotc_ota_delta_is_delta(target.data, target.len), "image is_delta");
+    CHECK(target.len == iotc_ota_delta_get_target_size(delta.data, delta.len), "target size");
+    CHECK(0 == iotc_ota_delta_get_target_size(delta.data, IOTC_OTA_DELTA_HEADER_SIZE - 1), "short header");
+}
+
+static void test_wrong_source(void) {
+    Buffer result;
+    bool is_complete;
+    source.data[source.len / 2] ^= 1;
+    int status = decode(&delta, 4096, 4096, &result, &is_complete);
+    CHECK(IOTC_OTA_DELTA_ERR_SOURCE == status && 0 == result.len, "status %d, %zu bytes", status, result.len);
+    source.data[source.len / 2] ^= 1;
+    free(result.data);
+}
+
+static void test_corrupted(void) {
+    Buffer result;
+    bool is_complete;
+    Buffer bad = {malloc(delta.len), delta.len};
+
+    // invalid record type
+    memcpy(bad.data, delta.data, delta.len);
+    bad.data[IOTC_OTA_DELTA_HEADER_SIZE] = 0x7f;
+    int status = decode(&bad, 0, 0, &result, &is_complete);
+    CHECK(IOTC_OTA_DELTA_ERR_FORMAT == status, "bad record: status %d", status);
+    free(result.data);
+
+    // unsupported version
+    memcpy(bad.data, delta.data, delta.len);
+    bad.data[4]++;
+    status = decode(&bad, 0, 0, &result, &is_complete);
+    CHECK(IOTC_OTA_DELTA_ERR_FORMAT == status, "bad version: status %d", status);
+    free(result.data);
+
+    // a record that reaches past the end of the running image
+    static const uint8_t copy_past_end[] = {0x01, 0xff, 0xff, 0xff, 0x00, 0x10, 0x00, 0x00, 0x00};
+    memcpy(bad.data, delta.data, delta.len);
+    memcpy(&bad.data[IOTC_OTA_DELTA_HEADER_SIZE], copy_past_end, sizeof(copy_past_end));
+    status = decode(&bad, 0, 0, &result, &is_complete);
+    CHECK(IOTC_OTA_DELTA_ERR_FORMAT == status, "copy past the end: status %d", status);
+    free(result.data);
+
+    // truncated: everything decodes, but the image is not complete
+    bad.len = delta.len - 1;
+    memcpy(bad.data, delta.data, delta.len);
+    status = decode(&bad, 0, 0, &result, &is_complete);
+    CHECK(IOTC_OTA_DELTA_OK == status && !is_complete, "truncated: status %d, complete %d", status, is_complete);
+    free(result.data);
+    free(bad.data);
+}
+
+int main(void) {
+    source = load_file(DATA_DIR "/ota_source.bin");
+    target = load_file(DATA_DIR "/ota_target.bin");
+    delta = load_file(DATA_DIR "/ota.delta");
+
+    test_header();
+    test_sizes();
+    test_wrong_source();
+    test_corrupted();
+
+    free(source.data);
+    free(target.data);
+    free(delta.data);
+    if (failures) {
+        printf("%d failures\n", failures);
+        return 1;
+    }
+    printf("OK (%zu byte delta of a %zu byte image)\n", delta.len, target.len);
+    return 0;
+}
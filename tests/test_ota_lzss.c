@@ -0,0 +1,201 @@
+/* SPDX-License-Identifier: MIT
+ * Copyright (C) 2025 Avnet
+ * Authors: Nikola Markovic <nikola.markovic@avnet.com> et al.
+ */
+
+// Decompresses an image made by tools/iotc_ota_compress.py with the device decoder, feeding it input chunks of
+// 1 to 100000 bytes and output buffers of 1 to 4096 bytes, and checks that it rebuilds the image. Also checks that
+// corrupted and truncated input is rejected. The image and the compressed file are made by the Makefile.
+// With --bench, measures the decoding speed instead.
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "test_util.h"
+
+#include "iotc_ota_lzss.h"
+
+#define RANDOM_ROUNDS 200
+#define BENCH_ROUNDS 200
+
+static Buffer image;
+static Buffer compressed;
+
+// Decodes with the given input chunk and output buffer sizes, or random ones for each call if 0.
+// Between calls, the decoder state is copied and the window is sometimes rebuilt from the output,
+// like a download that is resumed from saved state. *result is allocated with the size of the image.
+static int decode(const Buffer *z, size_t chunk, size_t out_size, Buffer *result, bool *is_complete) {
+    IotcOtaLzss decoder;
+    static uint8_t window[IOTC_OTA_LZSS_WINDOW_SIZE];
+    uint8_t out[4096];
+    size_t pos = 0;
+    int status = IOTC_OTA_LZSS_OK;
+
+    result->data = malloc(image.len);
+    result->len = 0;
+    iotc_ota_lzss_init(&decoder);
+    while (true) {
+        size_t in_len = chunk ? chunk : random_size(100000);
+        size_t out_len = out_size ? out_size : random_size(sizeof(out));
+        size_t in_used = 0;
+        size_t produced = 0;
+        if (in_len > z->len - pos) {
+            in_len = z->len - pos;
+        }
+        status = iotc_ota_lzss_process(&decoder, window, &z->data[pos], in_len, &in_used, out, out_len, &produced);
+        if (IOTC_OTA_LZSS_OK != status) {
+            break;
+        }
+        if (produced > image.len - result->len) {
+            status = IOTC_OTA_LZSS_ERR_FORMAT; // the decoder should have stopped at the image size
+            break;
+        }
+        memcpy(&result->data[result->len], out, produced);
+        result->len += produced;
+        pos += in_used;
+        if (0 == in_used && 0 == produced) {
+            break;
+        }
+        IotcOtaLzss resumed = decoder;
+        decoder = resumed;
+        if (0 == next_random() % 8) {
+            size_t start = result->len > IOTC_OTA_LZSS_WINDOW_SIZE ? result->len - IOTC_OTA_LZSS_WINDOW_SIZE : 0;
+            memset(window, 0xa5, sizeof(window));
+            for (size_t i = start; i < result->len; i++) {
+                window[i & (IOTC_OTA_LZSS_WINDOW_SIZE - 1)] = result->data[i];
+            }
+        }
+    }
+    *is_complete = pos == z->len && iotc_ota_lzss_is_complete(&decoder);
+    return status;
+}
+
+static void check_decode(size_t chunk, size_t out_size) {
+    Buffer result;
+    bool is_complete;
+    int status = decode(&compressed, chunk, out_size, &result, &is_complete);
+    CHECK(IOTC_OTA_LZSS_OK == status && is_complete && result.len == image.len
+            && 0 == memcmp(result.data, image.data, image.len),
+            "chunk %zu, output %zu: status %d, complete %d, %zu of %zu bytes",
+            chunk, out_size, status, is_complete, result.len, image.len);
+    free(result.data);
+}
+
+static void test_sizes(void) {
+    static const size_t chunks[] = {1, 2, 3, 9, 12, 13, 17, 64, 511, 4096, 100000};
+    static const size_t out_sizes[] = {1, 2, 3, 18, 64, 1000, 4096};
+    for (size_t i = 0; i < sizeof(chunks) / sizeof(chunks[0]); i++) {
+        for (size_t j = 0; j < sizeof(out_sizes) / sizeof(out_sizes[0]); j++) {
+            check_decode(chunks[i], out_sizes[j]);
+        }
+    }
+    for (int i = 0; i < RANDOM_ROUNDS; i++) {
+        check_decode(0, 0);
+    }
+}
+
+static void test_header(void) {
+    CHECK(iotc_ota_lzss_is_compressed(compressed.data, compressed.len), "is_compressed");
+    CHECK(!iotc_ota_lzss_is_compressed(image.data, image.len), "image is_compressed");
+    CHECK(image.len == iotc_ota_lzss_get_target_size(compressed.data, compressed.len), "image size");
+    CHECK(0 == iotc_ota_lzss_get_target_size(compressed.data, IOTC_OTA_LZSS_HEADER_SIZE - 1), "short header");
+}
+
+static void test_corrupted(void) {
+    Buffer result;
+    bool is_complete;
+    Buffer bad = {malloc(compressed.len + 1), compressed.len};
+
+    // different window bits
+    memcpy(bad.data, compressed.data, compressed.len);
+    bad.data[5]++;
+    int status = decode(&bad, 0, 0, &result, &is_complete);
+    CHECK(IOTC_OTA_LZSS_ERR_FORMAT == status && 0 == result.len, "bad header: status %d", status);
+    free(result.data);
+
+    // a match as the first item, which would reach before the start of the image
+    memcpy(bad.data, compressed.data, compressed.len);
+    bad.data[IOTC_OTA_LZSS_HEADER_SIZE] &= 0xfe;
+    status = decode(&bad, 0, 0, &result, &is_complete);
+    CHECK(IOTC_OTA_LZSS_ERR_FORMAT == status, "match before the start: status %d", status);
+    free(result.data);
+
+    // data after the end of the image
+    memcpy(bad.data, compressed.data, compressed.len);
+    bad.data[compressed.len] = 0;
+    bad.len = compressed.len + 1;
+    status = decode(&bad, 0, 0, &result, &is_complete);
+    CHECK(IOTC_OTA_LZSS_ERR_FORMAT == status, "trailing data: status %d", status);
+    free(result.data);
+
+    // truncated: everything decodes, but the image is not complete
+    bad.len = compressed.len - 1;
+    status = decode(&bad, 0, 0, &result, &is_complete);
+    CHECK(IOTC_OTA_LZSS_OK == status && !is_complete, "truncated: status %d, complete %d", status, is_complete);
+    free(result.data);
+    free(bad.data);
+}
+
+// Decodes the image repeatedly with 4 KiB input chunks, the size of an OTA download chunk
+static void bench(void) {
+    static const size_t out_sizes[] = {256, 1024, 4096};
+    static uint8_t window[IOTC_OTA_LZSS_WINDOW_SIZE];
+    uint8_t out[4096];
+    uint32_t check = 0;
+
+    printf("%zu byte image, %zu bytes compressed (%.1f%%)\n",
+            image.len, compressed.len, 100.0 * (double) compressed.len / (double) image.len);
+    for (size_t s = 0; s < sizeof(out_sizes) / sizeof(out_sizes[0]); s++) {
+        struct timespec start;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int round = 0; round < BENCH_ROUNDS; round++) {
+            IotcOtaLzss decoder;
+            size_t pos = 0;
+            iotc_ota_lzss_init(&decoder);
+            while (true) {
+                size_t in_len = compressed.len - pos < 4096 ? compressed.len - pos : 4096;
+                size_t in_used = 0;
+                size_t produced = 0;
+                (void) iotc_ota_lzss_process(&decoder, window, &compressed.data[pos], in_len, &in_used,
+                        out, out_sizes[s], &produced);
+                if (0 == in_used && 0 == produced) {
+                    break;
+                }
+                check += out[0];
+                pos += in_used;
+            }
+        }
+        double seconds = elapsed_s(&start);
+        printf("output buffer %4zu: %.1f MB/s of output\n", out_sizes[s],
+                (double) image.len * BENCH_ROUNDS / seconds / 1e6);
+    }
+    printf("(checksum %u)\n", (unsigned int) check);
+}
+
+int main(int argc, char *argv[]) {
+    image = load_file(DATA_DIR "/ota_target.bin");
+    compressed = load_file(DATA_DIR "/ota.lzss");
+
+    if (argc > 1 && 0 == strcmp(argv[1], "--bench")) {
+        bench();
+    } else {
+        test_header();
+        test_sizes();
+        test_corrupted();
+    }
+
+    free(image.data);
+    free(compressed.data);
+    if (failures) {
+        printf("%d failures\n", failures);
+        return 1;
+    }
+    if (argc <= 1) {
+        printf("OK (%zu bytes compressed to %zu)\n", image.len, compressed.len);
+    }
+    return 0;
+}
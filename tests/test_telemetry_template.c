@@ -0,0 +1,396 @@
+/* SPDX-License-Identifier: MIT
+ * Copyright (C) 2025 Avnet
+ * Authors: Nikola Markovic <nikola.markovic@avnet.com> et al.
+ */
+
+// Checks that the telemetry templates produce byte for byte the same JSON as the telemetry writer
+// for random schemas and values, and that the writer moves messages that outgrow an SDK print buffer to the heap.
+// With --bench, compares the time to send a message with a template, with the writer, and with iotcl_telemetry_*
+// instead. The iotcl_telemetry_* path is the cJSON based stand-in in stubs/iotcl_telemetry.c.
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "test_util.h"
+
+#include "iotcl.h"
+#include "iotconnect.h"
+#include "iotc_json_mem.h"
+#include "iotc_telemetry_writer.h"
+#include "iotc_telemetry_template.h"
+
+#define ROUNDS 20000
+#define MAX_FIELDS 12
+#define BUFFER_SIZE 2048
+#define BENCH_MESSAGES 200000
+
+static char sent[BUFFER_SIZE];
+static bool is_capturing = true; // the benchmark only counts the bytes that would be published
+static size_t sent_bytes = 0;
+
+cy_rslt_t iotconnect_sdk_send_telemetry_json(const char *json) {
+    if (is_capturing) {
+        snprintf(sent, sizeof(sent), "%s", json);
+    }
+    sent_bytes += strlen(json);
+    return CY_RSLT_SUCCESS;
+}
+
+static const char *names[] = {
+    "temperature", "humidity", "counter", "door_open", "version", "a", "quote\"d", "back\\slash",
+    "new\nline", "tab\there", "\x01" "control", "temp\xc3\xa9rature", "",
+};
+
+static const char *strings[] = {
+    "", "1.0", "hello world", "with \"quotes\"", "C:\\path", "line\r\nbreak", "\b\f\x1f", "caf\xc3\xa9", NULL,
+};
+
+static double random_number(void) {
+    switch (next_random() % 4) {
+        case 0: return (double) (int64_t) (next_random() % 200001) / 100.0 - 1000.0; // sensor readings
+        case 1: return (double) (int32_t) next_random(); // integer valued
+        case 2: return (double) (int64_t) next_random() / 3.0; // large
+        default: {
+            uint64_t bits = (next_random() & 0x3FFFFFFFFFFFFFFFULL) | 0x3000000000000000ULL; // well inside the finite range
+            double d;
+            memcpy(&d, &bits, sizeof(d));
+            return (next_random() & 1) ? d : -d;
+        }
+    }
+}
+
+static void random_schema(IotcTemplateField *fields, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        fields[i].name = names[next_random() % (sizeof(names) / sizeof(names[0]))];
+        fields[i].type = (IotcTemplateFieldType) (next_random() % 4);
+        fields[i].decimals = IOTC_TF_NUMBER == fields[i].type ? (int) (next_random() % 11) - 1 : 0; // -1 to 9
+    }
+}
+
+static void random_values(const IotcTemplateField *fields, size_t count, IotcTemplateValue *values) {
+    for (size_t i = 0; i < count; i++) {
+        switch (fields[i].type) {
+            case IOTC_TF_NUMBER: values[i].number = random_number(); break;
+            case IOTC_TF_INT: values[i].integer = (int64_t) next_random() >> (next_random() % 64); break;
+            case IOTC_TF_BOOL: values[i].boolean = next_random() & 1; break;
+            default: values[i].string = strings[next_random() % (sizeof(strings) / sizeof(strings[0]))]; break;
+        }
+    }
+}
+
+// The same message written with the telemetry writer calls that an application would make
+static int write_with_writer(const IotcTemplateField *fields, size_t count, const IotcTemplateValue *values,
+        const char *iso_time, char *buffer, size_t buffer_size, size_t *length) {
+    IotcTelemetryWriter w;
+    iotc_telemetry_writer_begin(&w, buffer, buffer_size, iso_time);
+    for (size_t i = 0; i < count; i++) {
+        switch (fields[i].type) {
+            case IOTC_TF_NUMBER:
+                if (fields[i].decimals != IOTC_TF_SHORTEST) {
+                    iotc_telemetry_writer_add_number_precision(&w, fields[i].name, values[i].number, fields[i].decimals);
+                } else {
+                    iotc_telemetry_writer_add_number(&w, fields[i].name, values[i].number);
+                }
+                break;
+            case IOTC_TF_INT: iotc_telemetry_writer_add_int(&w, fields[i].name, values[i].integer); break;
+            case IOTC_TF_BOOL: iotc_telemetry_writer_add_bool(&w, fields[i].name, values[i].boolean); break;
+            default: iotc_telemetry_writer_add_string(&w, fields[i].name, values[i].string); break;
+        }
+    }
+    const char *json = iotc_telemetry_writer_finish(&w, length);
+    iotc_telemetry_writer_release(&w);
+    return json ? IOTCL_SUCCESS : IOTCL_ERR_OUT_OF_MEMORY;
+}
+
+static void test_random_schemas(void) {
+    static const char *times[] = {"2025-01-31T12:00:00.000Z", ""};
+    IotcTemplateField fields[MAX_FIELDS];
+    IotcTemplateValue values[MAX_FIELDS];
+    char from_template[BUFFER_SIZE];
+    char from_writer[BUFFER_SIZE];
+
+    for (int round = 0; round < ROUNDS; round++) {
+        size_t count = (size_t) (next_random() % (MAX_FIELDS + 1));
+        random_schema(fields, count);
+        IotcTelemetryTemplate *t = iotc_telemetry_template_create(fields, count, BUFFER_SIZE);
+        CHECK(t, "create failed");
+        if (!t) {
+            continue;
+        }
+        for (int v = 0; v < 3; v++) {
+            random_values(fields, count, values);
+            const char *iso_time = times[v % 2];
+            size_t template_len = 0;
+            size_t writer_len = 0;
+            int template_status = iotc_telemetry_template_format(t, values, iso_time, from_template, sizeof(from_template), &template_len);
+            int writer_status = write_with_writer(fields, count, values, iso_time, from_writer, sizeof(from_writer), &writer_len);
+            CHECK(IOTCL_SUCCESS == template_status && IOTCL_SUCCESS == writer_status, "status %d %d", template_status, writer_status);
+            CHECK(template_len == writer_len && 0 == strcmp(from_template, from_writer),
+                    "\n  template: %s\n  writer:   %s", from_template, from_writer);
+
+            // both must overflow at the same size
+            size_t small = writer_len > 0 ? (size_t) (next_random() % writer_len) + 1 : 1;
+            template_status = iotc_telemetry_template_format(t, values, iso_time, from_template, small, NULL);
+            writer_status = write_with_writer(fields, count, values, iso_time, from_writer, small, NULL);
+            CHECK(IOTCL_ERR_OUT_OF_MEMORY == template_status && IOTCL_ERR_OUT_OF_MEMORY == writer_status,
+                    "overflow at %zu of %zu: %d %d", small, writer_len, template_status, writer_status);
+        }
+
+        // the send path publishes the same string
+        random_values(fields, count, values);
+        size_t writer_len = 0;
+        write_with_writer(fields, count, values, times[0], from_writer, sizeof(from_writer), &writer_len);
+        sent[0] = 0;
+        CHECK(IOTCL_SUCCESS == iotc_telemetry_template_send(t, values, times[0]), "send failed");
+        CHECK(0 == strcmp(sent, from_writer), "\n  sent:   %s\n  writer: %s", sent, from_writer);
+        iotc_telemetry_template_destroy(t);
+    }
+}
+
+static void test_default_time(void) {
+    static const IotcTemplateField fields[] = {{"temperature", IOTC_TF_NUMBER, 2}};
+    IotcTemplateValue values[1] = {{.number = 23.456}};
+    char from_template[BUFFER_SIZE];
+    char from_writer[BUFFER_SIZE];
+    IotcTelemetryTemplate *t = iotc_telemetry_template_create(fields, 1, 0);
+
+    // the current time may tick over between the two calls, so compare everything but the time
+    iotc_telemetry_template_format(t, values, NULL, from_template, sizeof(from_template), NULL);
+    write_with_writer(fields, 1, values, NULL, from_writer, sizeof(from_writer), NULL);
+    static const char expected_start[] = "{\"d\":[{\"dt\":\"";
+    static const char expected_end[] = ".000Z\",\"d\":{\"temperature\":23.46}}]}";
+    size_t expected_len = strlen(expected_start) + strlen("2025-01-31T12:00:00") + strlen(expected_end);
+    CHECK(strlen(from_template) == expected_len && 0 == strncmp(from_template, expected_start, strlen(expected_start))
+            && 0 == strcmp(&from_template[expected_len - strlen(expected_end)], expected_end), "template %s", from_template);
+    CHECK(strlen(from_writer) == expected_len && 0 == strncmp(from_writer, expected_start, strlen(expected_start))
+            && 0 == strcmp(&from_writer[expected_len - strlen(expected_end)], expected_end), "writer %s", from_writer);
+    iotc_telemetry_template_destroy(t);
+}
+
+static void test_decimals(void) {
+    static const IotcTemplateField fields[] = {
+        {"rounded", IOTC_TF_NUMBER, 0}, {"two", IOTC_TF_NUMBER, 2}, {"shortest", IOTC_TF_NUMBER, IOTC_TF_SHORTEST},
+        {"ignored", IOTC_TF_INT, -5},
+    };
+    static const IotcTemplateField invalid[] = {{"invalid", IOTC_TF_NUMBER, -2}};
+    static const IotcTemplateField too_many[] = {{"invalid", IOTC_TF_NUMBER, 10}};
+    IotcTemplateValue values[4] = {{.number = 23.5}, {.number = 23.456}, {.number = 23.456}, {.integer = 7}};
+    char buffer[BUFFER_SIZE];
+    IotcTelemetryTemplate *t = iotc_telemetry_template_create(fields, 4, 0);
+    CHECK(t, "create failed");
+    if (t) {
+        iotc_telemetry_template_format(t, values, "", buffer, sizeof(buffer), NULL);
+        CHECK(0 == strcmp(buffer, "{\"d\":[{\"d\":{\"rounded\":24,\"two\":23.46,\"shortest\":23.456,\"ignored\":7}}]}"),
+                "decimals %s", buffer);
+        iotc_telemetry_template_destroy(t);
+    }
+    CHECK(!iotc_telemetry_template_create(invalid, 1, 0), "decimals -2 accepted");
+    CHECK(!iotc_telemetry_template_create(too_many, 1, 0), "decimals 10 accepted");
+}
+
+// Writes count numbered attributes into an SDK buffer (buffer NULL) or the caller's buffer
+static const char *write_numbered(IotcTelemetryWriter *w, int count, char *buffer, size_t buffer_size) {
+    char name[32];
+    iotc_telemetry_writer_begin(w, buffer, buffer_size, "");
+    for (int i = 0; i < count; i++) {
+        snprintf(name, sizeof(name), "attribute_%d", i);
+        iotc_telemetry_writer_add_int(w, name, i);
+        iotc_telemetry_writer_add_string(w, "escaped", "\x01\x02\x03\x04\x05\x06\x07\x08");
+    }
+    return iotc_telemetry_writer_finish(w, NULL);
+}
+
+static void test_sdk_buffers(void) {
+    IotcJsonMemStats before;
+    IotcJsonMemStats after;
+    IotcTelemetryWriter w[IOTC_JSON_PRINT_BUFFER_COUNT + 1];
+    IotcTelemetryWriter expected;
+    static char expected_buffer[64 * 1024];
+
+    // a small message stays in the pool
+    iotc_json_mem_get_stats(&before);
+    const char *json = write_numbered(&w[0], 1, NULL, 0);
+    CHECK(json && 0 == strcmp(json, write_numbered(&expected, 1, expected_buffer, sizeof(expected_buffer))), "small %s", json);
+    iotc_telemetry_writer_release(&w[0]);
+    iotc_json_mem_get_stats(&after);
+    CHECK(after.print_buffer_allocations == before.print_buffer_allocations + 1, "small not pooled");
+    CHECK(after.print_buffer_too_large == before.print_buffer_too_large, "small counted as too large");
+
+    // messages of many sizes around and far above the buffer size move to the heap and are not cut short
+    for (int count = 1; count <= 400; count += 7) {
+        iotc_json_mem_get_stats(&before);
+        json = write_numbered(&w[0], count, NULL, 0);
+        const char *expected_json = write_numbered(&expected, count, expected_buffer, sizeof(expected_buffer));
+        CHECK(json && expected_json && 0 == strcmp(json, expected_json), "%d attributes", count);
+        bool is_large = strlen(expected_json) >= IOTC_JSON_PRINT_BUFFER_SIZE;
+        iotc_telemetry_writer_release(&w[0]);
+        iotc_json_mem_get_stats(&after);
+        CHECK(after.print_buffer_too_large == before.print_buffer_too_large + (is_large ? 1 : 0)
+                && after.print_buffer_allocations == before.print_buffer_allocations + (is_large ? 0 : 1),
+                "%d attributes counted wrong", count);
+    }
+
+    // while all pool buffers are taken, the next message goes to the heap
+    for (int i = 0; i < IOTC_JSON_PRINT_BUFFER_COUNT; i++) {
+        iotc_telemetry_writer_begin(&w[i], NULL, 0, "");
+    }
+    iotc_json_mem_get_stats(&before);
+    json = write_numbered(&w[IOTC_JSON_PRINT_BUFFER_COUNT], 1, NULL, 0);
+    iotc_json_mem_get_stats(&after);
+    CHECK(json && after.print_buffer_exhausted == before.print_buffer_exhausted + 1, "exhausted not counted");
+    for (int i = 0; i <= IOTC_JSON_PRINT_BUFFER_COUNT; i++) {
+        iotc_telemetry_writer_release(&w[i]);
+    }
+
+    // a caller's buffer never grows
+    char small[64];
+    CHECK(!write_numbered(&w[0], 10, small, sizeof(small)), "caller buffer overflowed");
+    iotc_telemetry_writer_release(&w[0]);
+}
+
+// A typical fixed set of sensor attributes
+static const IotcTemplateField bench_fields[] = {
+    {"temperature", IOTC_TF_NUMBER, IOTC_TF_SHORTEST},
+    {"humidity", IOTC_TF_NUMBER, IOTC_TF_SHORTEST},
+    {"pressure", IOTC_TF_NUMBER, IOTC_TF_SHORTEST},
+    {"counter", IOTC_TF_INT, 0},
+    {"door_open", IOTC_TF_BOOL, 0},
+    {"battery", IOTC_TF_INT, 0},
+    {"version", IOTC_TF_STRING, 0},
+    {"status", IOTC_TF_STRING, 0},
+};
+#define BENCH_FIELD_COUNT (sizeof(bench_fields) / sizeof(bench_fields[0]))
+
+// Readings with a few decimals, like sensors report them
+static void bench_values(IotcTemplateValue *values, int i) {
+    values[0].number = (double) ((int64_t) (next_random() % 6001) - 2000) / 100.0;
+    values[1].number = (double) (int64_t) (next_random() % 1001) / 10.0;
+    values[2].number = (double) (int64_t) (next_random() % 20001 + 90000) / 100.0;
+    values[3].integer = i;
+    values[4].boolean = next_random() & 1;
+    values[5].integer = (int64_t) (next_random() % 101);
+    values[6].string = "1.2.3";
+    values[7].string = (next_random() & 1) ? "ok" : "warning";
+}
+
+// The same message, built the way an application does with iotc-c-lib
+static int send_with_iotcl(const IotcTemplateValue *values) {
+    IotclMessageHandle msg = iotcl_telemetry_create();
+    for (size_t i = 0; i < BENCH_FIELD_COUNT; i++) {
+        switch (bench_fields[i].type) {
+            case IOTC_TF_NUMBER: iotcl_telemetry_set_number(msg, bench_fields[i].name, values[i].number); break;
+            case IOTC_TF_INT: iotcl_telemetry_set_number(msg, bench_fields[i].name, (double) values[i].integer); break;
+            case IOTC_TF_BOOL: iotcl_telemetry_set_bool(msg, bench_fields[i].name, values[i].boolean); break;
+            default: iotcl_telemetry_set_string(msg, bench_fields[i].name, values[i].string); break;
+        }
+    }
+    char *json = iotcl_telemetry_create_serialized_string(msg, false);
+    int status = json ? (int) iotconnect_sdk_send_telemetry_json(json) : IOTCL_ERR_OUT_OF_MEMORY;
+    iotcl_telemetry_destroy_serialized(json);
+    iotcl_telemetry_destroy(msg);
+    return status;
+}
+
+static int send_with_writer(const IotcTemplateValue *values) {
+    IotcTelemetryWriter w;
+    iotc_telemetry_writer_begin(&w, NULL, 0, NULL);
+    for (size_t i = 0; i < BENCH_FIELD_COUNT; i++) {
+        switch (bench_fields[i].type) {
+            case IOTC_TF_NUMBER: iotc_telemetry_writer_add_number(&w, bench_fields[i].name, values[i].number); break;
+            case IOTC_TF_INT: iotc_telemetry_writer_add_int(&w, bench_fields[i].name, values[i].integer); break;
+            case IOTC_TF_BOOL: iotc_telemetry_writer_add_bool(&w, bench_fields[i].name, values[i].boolean); break;
+            default: iotc_telemetry_writer_add_string(&w, bench_fields[i].name, values[i].string); break;
+        }
+    }
+    return iotc_telemetry_writer_send(&w);
+}
+
+// The numbers in the benchmark print the same in cJSON, so all three paths must send the same JSON
+static void test_same_as_iotcl(void) {
+    IotcTemplateValue values[BENCH_FIELD_COUNT];
+    char from_iotcl[BUFFER_SIZE];
+    char from_template[BUFFER_SIZE];
+    IotcTelemetryTemplate *t = iotc_telemetry_template_create(bench_fields, BENCH_FIELD_COUNT, 0);
+    for (int i = 0; i < 1000; i++) {
+        bench_values(values, i);
+        // the current time may tick over between the calls, so try again if the output differs
+        for (int attempt = 0; attempt < 2; attempt++) {
+            send_with_iotcl(values);
+            snprintf(from_iotcl, sizeof(from_iotcl), "%s", sent);
+            iotc_telemetry_template_send(t, values, NULL);
+            snprintf(from_template, sizeof(from_template), "%s", sent);
+            send_with_writer(values);
+            if (0 == strcmp(from_template, from_iotcl) && 0 == strcmp(sent, from_iotcl)) {
+                break;
+            }
+        }
+        CHECK(0 == strcmp(from_template, from_iotcl), "\n  template: %s\n  iotcl:    %s", from_template, from_iotcl);
+        CHECK(0 == strcmp(sent, from_iotcl), "\n  writer: %s\n  iotcl:  %s", sent, from_iotcl);
+    }
+    iotc_telemetry_template_destroy(t);
+}
+
+static void bench(void) {
+    static IotcTemplateValue values[BENCH_MESSAGES][BENCH_FIELD_COUNT];
+    IotcTelemetryTemplate *t = iotc_telemetry_template_create(bench_fields, BENCH_FIELD_COUNT, 0);
+    struct timespec start;
+
+    for (int i = 0; i < BENCH_MESSAGES; i++) {
+        bench_values(values[i], i);
+    }
+    is_capturing = false;
+
+    sent_bytes = 0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < BENCH_MESSAGES; i++) {
+        iotc_telemetry_template_send(t, values[i], NULL);
+    }
+    double template_s = elapsed_s(&start);
+    size_t template_bytes = sent_bytes;
+
+    sent_bytes = 0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < BENCH_MESSAGES; i++) {
+        send_with_writer(values[i]);
+    }
+    double writer_s = elapsed_s(&start);
+    size_t writer_bytes = sent_bytes;
+
+    sent_bytes = 0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < BENCH_MESSAGES; i++) {
+        send_with_iotcl(values[i]);
+    }
+    double iotcl_s = elapsed_s(&start);
+    size_t iotcl_bytes = sent_bytes;
+
+    printf("%d messages of %u attributes, in ns per message:\n", BENCH_MESSAGES, (unsigned int) BENCH_FIELD_COUNT);
+    printf("  template         %6.0f (%.1fx) %zu bytes\n", template_s * 1e9 / BENCH_MESSAGES, iotcl_s / template_s, template_bytes);
+    printf("  writer           %6.0f (%.1fx) %zu bytes\n", writer_s * 1e9 / BENCH_MESSAGES, iotcl_s / writer_s, writer_bytes);
+    printf("  iotcl_telemetry  %6.0f        %zu bytes\n", iotcl_s * 1e9 / BENCH_MESSAGES, iotcl_bytes);
+    iotc_telemetry_template_destroy(t);
+}
+
+int main(int argc, char *argv[]) {
+    // as iotconnect_sdk_init() does, so that cJSON uses the same allocation path as on the device
+    iotc_json_mem_init();
+    if (argc > 1 && 0 == strcmp(argv[1], "--bench")) {
+        bench();
+        return 0;
+    }
+    test_same_as_iotcl();
+    test_random_schemas();
+    test_default_time();
+    test_decimals();
+    test_sdk_buffers();
+    if (failures) {
+        printf("%d failures\n", failures);
+        return 1;
+    }
+    printf("OK\n");
+    return 0;
+}
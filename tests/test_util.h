@@ -0,0 +1,77 @@
+/* SPDX-License-Identifier: MIT
+ * Copyright (C) 2025 Avnet
+ * Authors: Nikola Markovic <nikola.markovic@avnet.com> et al.
+ */
+
+// Helpers shared by the host tests. Each test is a single source file that includes this header once.
+#pragma once
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+
+static int failures = 0;
+
+// Reports a failure and continues, so that one run shows all of them. main() returns 1 if failures is not 0.
+#define CHECK(cond, ...) do { \
+    if (!(cond)) { \
+        printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+        printf(__VA_ARGS__); \
+        printf("\n"); \
+        failures++; \
+    } \
+} while (0)
+
+typedef struct {
+    uint8_t *data;
+    size_t len;
+} Buffer;
+
+// Fixed seed, so that a failure can be reproduced
+static uint64_t rng_state = 0x9E3779B97F4A7C15ULL;
+
+static inline uint64_t next_random(void) {
+    // xorshift64*
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 2685821657736338717ULL;
+}
+
+// Mostly small sizes, which exercise the record and buffer boundaries, but also large ones up to max
+static inline size_t random_size(size_t max) {
+    switch (next_random() % 3) {
+        case 0: return 1 + (size_t) (next_random() % 16);
+        case 1: return 1 + (size_t) (next_random() % 1024);
+        default: return 1 + (size_t) (next_random() % max);
+    }
+}
+
+// Reads a whole file. Exits if it cannot be read. The data must be freed with free().
+static inline Buffer load_file(const char *path) {
+    Buffer b = {NULL, 0};
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        printf("Cannot open %s\n", path);
+        exit(2);
+    }
+    fseek(f, 0, SEEK_END);
+    b.len = (size_t) ftell(f);
+    fseek(f, 0, SEEK_SET);
+    b.data = malloc(b.len);
+    if (!b.data || b.len != fread(b.data, 1, b.len, f)) {
+        printf("Cannot read %s\n", path);
+        exit(2);
+    }
+    fclose(f);
+    return b;
+}
+
+// Seconds since start, which was set with clock_gettime(CLOCK_MONOTONIC, ...)
+static inline double elapsed_s(const struct timespec *start) {
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (double) (end.tv_sec - start->tv_sec) + (double) (end.tv_nsec - start->tv_nsec) / 1e9;
+}
@@ -0,0 +1,77 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: MIT
+# Copyright (C) 2025 Avnet
+# Authors: Nikola Markovic <nikola.markovic@avnet.com> et al.
+#
+# Converts the PEM root certificates in iotc-c-lib's iotcl_certs.h into DER byte arrays
+# so that the SDK can be built with IOTC_CERTS_DER. Usage:
+#   python3 iotc_certs_der.py <path-to>/iotcl_certs.h <output-dir>/iotc_certs_der.h
+
+import base64
+import re
+import sys
+
+# iotcl_certs.h macro name -> name of the generated array
+CERTS = {
+    'IOTCL_AMAZON_ROOT_CA1': 'IOTC_DER_AMAZON_ROOT_CA1',
+    'IOTCL_CERT_DIGICERT_GLOBAL_ROOT_G2': 'IOTC_DER_DIGICERT_GLOBAL_ROOT_G2',
+    'IOTCL_CERT_GODADDY_SECURE_SERVER_CERTIFICATE_G2': 'IOTC_DER_GODADDY_SECURE_SERVER_CERTIFICATE_G2',
+}
+
+
+def read_macros(header_text):
+    # join continuation lines, then collect the string literals of each #define
+    text = header_text.replace('\\\r\n', ' ').replace('\\\n', ' ')
+    macros = {}
+    for m in re.finditer(r'^\s*#\s*define\s+(\w+)\s+(.*)$', text, re.MULTILINE):
+        literals = re.findall(r'"((?:[^"\\]|\\.)*)"', m.group(2))
+        if literals:
+            macros[m.group(1)] = ''.join(literals).encode().decode('unicode_escape')
+    return macros
+
+
+def pem_to_der(pem):
+    m = re.search(r'-----BEGIN CERTIFICATE-----(.*?)-----END CERTIFICATE-----', pem, re.DOTALL)
+    if not m:
+        raise ValueError('no PEM certificate found')
+    return base64.b64decode(''.join(m.group(1).split()))
+
+
+def format_array(name, der):
+    lines = ['static const unsigned char %s[%d] = {' % (name, len(der))]
+    for i in range(0, len(der), 16):
+        lines.append('    ' + ', '.join('0x%02x' % b for b in der[i:i + 16]) + ',')
+    lines.append('};')
+    return '\n'.join(lines)
+
+
+def main(argv):
+    if len(argv) != 3:
+        print('Usage: %s <iotcl_certs.h> <output header>' % argv[0])
+        return 1
+    with open(argv[1], 'r') as f:
+        macros = read_macros(f.read())
+
+    out = [
+        '/* Generated by iotc_certs_der.py from %s. Do not edit. */' % argv[1].replace('\\', '/').split('/')[-1],
+        '',
+        '#ifndef IOTC_CERTS_DER_H',
+        '#define IOTC_CERTS_DER_H',
+        '',
+    ]
+    for macro, name in CERTS.items():
+        if macro not in macros:
+            print('ERROR: %s was not found in %s' % (macro, argv[1]))
+            return 1
+        out.append(format_array(name, pem_to_der(macros[macro])))
+        out.append('')
+    out.append('#endif // IOTC_CERTS_DER_H')
+    out.append('')
+
+    with open(argv[2], 'w') as f:
+        f.write('\n'.join(out))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
@@ -0,0 +1,150 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: MIT
+# Copyright (C) 2025 Avnet
+# Authors: Nikola Markovic <nikola.markovic@avnet.com> et al.
+#
+# Compresses an OTA image so that the SDK decompresses it while downloading, when it is built with
+# IOTC_OTA_DIRECT_DOWNLOAD. See source/iotc_ota_lzss.h for the format. Usage:
+#   python3 iotc_ota_compress.py <image>.bin <output>.lzss
+#
+# The image must be the signed binary that is written to the slot (not a hex file).
+# The output is decompressed and compared with the image before it is written.
+# Images that do not get smaller, such as encrypted images, are refused, since the uncompressed image is then
+# the smaller download. Pass --force to write the output anyway.
+
+import struct
+import sys
+
+MAGIC = b'IOTZ'
+VERSION = 1
+WINDOW_BITS = 12
+LENGTH_BITS = 4
+WINDOW_SIZE = 1 << WINDOW_BITS
+MIN_MATCH = 3
+MAX_MATCH = (1 << LENGTH_BITS) - 1 + MIN_MATCH
+MAX_CHAIN = 64  # candidates checked per position. Higher is slower, and compresses slightly better
+
+
+def longest_match(data, pos, chains):
+    candidates = chains.get(data[pos:pos + MIN_MATCH])
+    if not candidates:
+        return 0, 0
+    best_len = 0
+    best_dist = 0
+    limit = min(MAX_MATCH, len(data) - pos)
+    for cand in reversed(candidates[-MAX_CHAIN:]):
+        dist = pos - cand
+        if dist > WINDOW_SIZE:
+            break
+        n = MIN_MATCH
+        while n < limit and data[cand + n] == data[pos + n]:
+            n += 1
+        if n > best_len:
+            best_len = n
+            best_dist = dist
+            if n == limit:
+                break
+    return best_len, best_dist
+
+
+def compress(data):
+    out = bytearray(MAGIC)
+    out += struct.pack('<BBBxI', VERSION, WINDOW_BITS, LENGTH_BITS, len(data))
+    chains = {}
+    items = []
+    pos = 0
+
+    def insert(p):
+        if p + MIN_MATCH <= len(data):
+            chains.setdefault(data[p:p + MIN_MATCH], []).append(p)
+
+    while pos < len(data):
+        length, dist = longest_match(data, pos, chains)
+        if length >= MIN_MATCH:
+            # lazy matching: emit a literal if the match at the next position is longer
+            insert(pos)
+            next_length, _ = longest_match(data, pos + 1, chains) if pos + 1 < len(data) else (0, 0)
+            if next_length > length:
+                items.append(data[pos])
+                pos += 1
+                continue
+            d = dist - 1
+            items.append((d & 0xff, ((d >> 8) << 4) | (length - MIN_MATCH)))
+            for p in range(pos + 1, pos + length):
+                insert(p)
+            pos += length
+        else:
+            insert(pos)
+            items.append(data[pos])
+            pos += 1
+
+    for i in range(0, len(items), 8):
+        group = items[i:i + 8]
+        flags = 0
+        body = bytearray()
+        for bit, item in enumerate(group):
+            if isinstance(item, int):
+                flags |= 1 << bit
+                body.append(item)
+            else:
+                body += bytes(item)
+        out.append(flags)
+        out += body
+    return bytes(out)
+
+
+def decompress(data):
+    # mirrors the device decoder, to check the output
+    if data[:4] != MAGIC or data[4] != VERSION or data[5] != WINDOW_BITS or data[6] != LENGTH_BITS:
+        raise ValueError('not a compressed image')
+    size, = struct.unpack_from('<I', data, 8)
+    out = bytearray()
+    pos = 12
+    while len(out) < size:
+        flags = data[pos]
+        pos += 1
+        for _ in range(8):
+            if len(out) >= size:
+                break
+            if flags & 1:
+                out.append(data[pos])
+                pos += 1
+            else:
+                dist = (data[pos] | ((data[pos + 1] & 0xf0) << 4)) + 1
+                length = (data[pos + 1] & 0x0f) + MIN_MATCH
+                pos += 2
+                for _ in range(length):
+                    out.append(out[-dist])
+            flags >>= 1
+    if pos != len(data):
+        raise ValueError('unexpected data after the end of the image')
+    return bytes(out)
+
+
+def main(argv):
+    force = '--force' in argv[1:]
+    argv = [a for a in argv if a != '--force']
+    if len(argv) != 3:
+        print('Usage: %s [--force] <image>.bin <output>.lzss' % argv[0])
+        return 1
+    with open(argv[1], 'rb') as f:
+        image = f.read()
+
+    compressed = compress(image)
+    if decompress(compressed) != image:
+        print('Error: The compressed image does not decompress correctly')
+        return 2
+    if len(compressed) >= len(image):
+        print('%s: Compressing %d bytes resulted in %d bytes. Send the image uncompressed instead.'
+              % ('Warning' if force else 'Error', len(image), len(compressed)))
+        if not force:
+            return 3
+
+    with open(argv[2], 'wb') as f:
+        f.write(compressed)
+    print('Compressed %d bytes to %d bytes (%.1f%%)' % (len(image), len(compressed), 100.0 * len(compressed) / len(image)))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
@@ -0,0 +1,182 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: MIT
+# Copyright (C) 2025 Avnet
+# Authors: Nikola Markovic <nikola.markovic@avnet.com> et al.
+#
+# Generates a delta OTA artifact that the SDK applies against the running image when it is built with
+# IOTC_OTA_DIRECT_DOWNLOAD. See source/iotc_ota_delta.h for the format. Usage:
+#   python3 iotc_ota_delta.py <running image>.bin <new image>.bin <output>.delta
+#
+# Both images must be the signed binaries that are written to the slots (not hex files).
+# The generated delta is applied and compared with the new image before it is written.
+
+import struct
+import sys
+
+MAGIC = b'IOTD'
+VERSION = 1
+
+OP_COPY = 0x01
+OP_ADD = 0x02
+OP_INSERT = 0x03
+
+BLOCK = 8          # length of the substrings that are indexed to find matches
+STRIDE = 4         # every STRIDE-th source position is indexed
+MIN_MATCH = 16     # shorter exact matches are not worth a COPY record
+
+
+def fnv1a(data):
+    h = 2166136261
+    for b in data:
+        h = ((h ^ b) * 16777619) & 0xffffffff
+    return h
+
+
+def index_source(source):
+    index = {}
+    for i in range(0, len(source) - BLOCK + 1, STRIDE):
+        index.setdefault(source[i:i + BLOCK], i)
+    return index
+
+
+def match_length(source, s, target, t):
+    n = 0
+    limit = min(len(source) - s, len(target) - t)
+    while n < limit and source[s + n] == target[t + n]:
+        n += 1
+    return n
+
+
+def find_match(source, index, target, t, expected_s):
+    # prefer continuing at the source position that follows the previous match, which is what
+    # code that only moved by a few bytes, or data with a few changed bytes, looks like
+    if 0 <= expected_s < len(source):
+        n = match_length(source, expected_s, target, t)
+        if n >= MIN_MATCH:
+            return expected_s, n
+    s = index.get(target[t:t + BLOCK])
+    if s is None:
+        return None, 0
+    return s, match_length(source, s, target, t)
+
+
+def best_add_length(source, s, target, t, region_len):
+    # bsdiff heuristic: extend the previous match into the gap as long as
+    # more than half of the bytes still match
+    best = 0
+    best_score = 0
+    matches = 0
+    limit = min(region_len, len(source) - s)
+    for i in range(limit):
+        if source[s + i] == target[t + i]:
+            matches += 1
+        score = 2 * matches - (i + 1)
+        if score > best_score:
+            best_score = score
+            best = i + 1
+    return best
+
+
+def encode_gap(ops, source, target, t_start, t_end, s_continue):
+    gap = t_end - t_start
+    if gap <= 0:
+        return
+    add_len = best_add_length(source, s_continue, target, t_start, gap) if s_continue is not None else 0
+    if add_len > 0:
+        diff = bytes((target[t_start + i] - source[s_continue + i]) & 0xff for i in range(add_len))
+        ops.append((OP_ADD, s_continue, add_len, diff))
+    if gap > add_len:
+        ops.append((OP_INSERT, 0, gap - add_len, target[t_start + add_len:t_end]))
+
+
+def diff(source, target):
+    index = index_source(source)
+    ops = []
+    t = 0
+    last_t = 0         # target bytes before this were encoded
+    s_continue = None  # source position that follows the last COPY
+    while t + BLOCK <= len(target):
+        expected_s = s_continue + (t - last_t) if s_continue is not None else -1
+        s, n = find_match(source, index, target, t, expected_s)
+        if n < MIN_MATCH:
+            t += 1
+            continue
+        # the source was indexed with a stride, so the match may start a few bytes earlier
+        match_t = t
+        while match_t > last_t and s > 0 and source[s - 1] == target[match_t - 1]:
+            s -= 1
+            match_t -= 1
+            n += 1
+        encode_gap(ops, source, target, last_t, match_t, s_continue)
+        ops.append((OP_COPY, s, n, b''))
+        t = match_t + n
+        last_t = t
+        s_continue = s + n
+    encode_gap(ops, source, target, last_t, len(target), s_continue)
+    return ops
+
+
+def serialize(source, target, ops):
+    out = bytearray(MAGIC)
+    out += struct.pack('<B3xIII', VERSION, len(target), len(source), fnv1a(source))
+    for op, s, n, data in ops:
+        if op == OP_INSERT:
+            out += struct.pack('<BI', op, n) + data
+        else:
+            out += struct.pack('<BII', op, s, n) + data
+    return bytes(out)
+
+
+def apply(source, delta):
+    # mirrors the device decoder, to check the generated delta
+    if delta[:4] != MAGIC or delta[4] != VERSION:
+        raise ValueError('not a delta')
+    target_size, source_size, source_hash = struct.unpack_from('<III', delta, 8)
+    if source_size > len(source) or fnv1a(source[:source_size]) != source_hash:
+        raise ValueError('the delta was made for a different image')
+    out = bytearray()
+    pos = 20
+    while pos < len(delta):
+        op = delta[pos]
+        if op == OP_INSERT:
+            n, = struct.unpack_from('<I', delta, pos + 1)
+            pos += 5
+            out += delta[pos:pos + n]
+            pos += n
+        elif op in (OP_COPY, OP_ADD):
+            s, n = struct.unpack_from('<II', delta, pos + 1)
+            pos += 9
+            if op == OP_COPY:
+                out += source[s:s + n]
+            else:
+                out += bytes((source[s + i] + delta[pos + i]) & 0xff for i in range(n))
+                pos += n
+        else:
+            raise ValueError('invalid record at %d' % pos)
+    if len(out) != target_size:
+        raise ValueError('the delta produced %d bytes instead of %d' % (len(out), target_size))
+    return bytes(out)
+
+
+def main(argv):
+    if len(argv) != 4:
+        print('Usage: %s <running image>.bin <new image>.bin <output>.delta' % argv[0])
+        return 1
+    with open(argv[1], 'rb') as f:
+        source = f.read()
+    with open(argv[2], 'rb') as f:
+        target = f.read()
+
+    delta = serialize(source, target, diff(source, target))
+    if apply(source, delta) != target:
+        print('Error: The generated delta does not reproduce the new image')
+        return 2
+
+    with open(argv[3], 'wb') as f:
+        f.write(delta)
+    print('Delta is %d bytes (%.1f%% of the %d byte image)' % (len(delta), 100.0 * len(delta) / len(target), len(target)))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))